@@ -0,0 +1,270 @@
+/**
+ * @file simplyc_bench.c
+ *
+ * @brief Benchmarks of the SimplyC unit testing framework itself, the cost
+ * of its asserts, test cases and log lines. Run them with the options of a
+ * build to see how much of the test time is the framework.
+ *
+ * This program is free software. You can redistribute it and/or modify it
+ * under the terms of the GNU General Public License, version 3 (GPLv3).
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include "unit_test.h"
+#include "simplyc_bench.h"
+
+#ifdef UNIT_TEST_BENCH
+
+//! Operations in each run of the failing assert and test case benchmarks
+#define BENCH_BATCH 1000u
+
+//! Asserts in each run of the passing assert benchmark, they are cheap
+#define BENCH_PASSES 100000u
+
+//! Log lines in each run of the sink benchmarks
+#define BENCH_LINES 100u
+
+//! Timed runs of the benchmarks that stay in memory
+#define BENCH_RUNS 50u
+
+//! Timed runs of the benchmarks that write to a sink
+#define BENCH_SINK_RUNS 10u
+
+// static function declarations
+static void bench_overhead(void);
+static void bench_asserts(void);
+static void bench_cases(void);
+static void bench_sinks(unit_test_sink_t const *);
+static void bench_sink(char const *, unit_test_sink_t const *);
+static void measured_case_start(void);
+static void measured_case_end(void);
+static void discard_sink_write(void *, uint8_t const *, size_t);
+
+//! Context the benchmarks run in, the default context is the one measured
+static unit_test_context_t bench_context;
+
+//! Sink of the default context while it is measured, the log is dropped
+static unit_test_sink_t const discard_sink = { discard_sink_write, 0, 0 };
+
+//! Value compared by the asserts, read each time so no compare is folded
+static uint32_t bench_value = 0;
+
+/**
+ * Entry point of the SimplyC benchmarks. The framework is measured in the
+ * default context, with the options it is built with, while the benchmarks
+ * run in a context of their own and are logged to the sink of the default
+ * context. Each benchmark is a BENCH_CASE whose name says how many
+ * operations each run does, the median ticks of a run are their cost. With
+ * UNIT_TEST_BASELINE the medians are compared with the baseline file, so a
+ * change that slows the framework down shows up in the next run.
+ *
+ * @param timestamp source of the ticks, for example a function that reads
+ * the cycle counter of the target. Null uses unit_test_clock_us on a host.
+ */
+void simplyc_bench (unit_test_timestamp_t timestamp)
+{
+    unit_test_sink_t const *const sink = unit_test_context_get()->log_sink;
+
+    #ifdef UNIT_TEST_CLOCK_US
+    if (!timestamp)
+    {
+        timestamp = unit_test_clock_us;
+    }
+    #endif
+
+    unit_test_log_on("simplyc_bench_output.txt");
+    unit_test_timestamp_set(timestamp);
+
+    unit_test_context_init(&bench_context, sink);
+    unit_test_log_set_sink(&discard_sink);
+    (void) unit_test_context_set(&bench_context);
+
+    test_suite_start("SimplyC benchmarks");
+    bench_overhead();
+    bench_asserts();
+    bench_cases();
+    bench_sinks(sink);
+    test_suite_end();
+
+    // the summary counts the benchmarks, not the measured asserts
+    unit_test_log_off();
+
+    (void) unit_test_context_set(0);
+    unit_test_log_set_sink(sink);
+    unit_test_timestamp_set(0);
+}
+
+/**
+ * Time runs that do nothing but switch to the measured context and back
+ * and loop BENCH_BATCH times. This overhead is part of the other benchmarks.
+ */
+static void bench_overhead (void)
+{
+    BENCH_CASE("1000 empty loops, the overhead of the others", BENCH_RUNS)
+    {
+        (void) unit_test_context_set(0);
+
+        for (uint32_t index = 0; index < BENCH_BATCH; index++)
+        {
+            bench_do_not_optimize(&bench_value);
+        }
+
+        (void) unit_test_context_set(&bench_context);
+    }
+}
+
+/**
+ * Time passing asserts and failing asserts. A failing assert formats its
+ * message and logs it, to a sink that drops it.
+ */
+static void bench_asserts (void)
+{
+    measured_case_start();
+
+    BENCH_CASE("100000 passing asserts", BENCH_RUNS)
+    {
+        (void) unit_test_context_set(0);
+
+        for (uint32_t index = 0; index < BENCH_PASSES; index++)
+        {
+            bench_do_not_optimize(&bench_value);
+            ASSERT_UINT32_EQ(0, bench_value);
+        }
+
+        (void) unit_test_context_set(&bench_context);
+    }
+
+    BENCH_CASE("1000 failing asserts", BENCH_RUNS)
+    {
+        (void) unit_test_context_set(0);
+
+        for (uint32_t index = 0; index < BENCH_BATCH; index++)
+        {
+            bench_do_not_optimize(&bench_value);
+            ASSERT_UINT32_EQ(1, bench_value);
+        }
+
+        (void) unit_test_context_set(&bench_context);
+    }
+
+    measured_case_end();
+}
+
+/**
+ * Time test cases that start and end with nothing in between, logged to a
+ * sink that drops the log.
+ */
+static void bench_cases (void)
+{
+    (void) unit_test_context_set(0);
+    test_suite_start("Measured suite");
+    (void) unit_test_context_set(&bench_context);
+
+    BENCH_CASE("1000 test case start and end pairs", BENCH_RUNS)
+    {
+        (void) unit_test_context_set(0);
+
+        for (uint32_t index = 0; index < BENCH_BATCH; index++)
+        {
+            test_case_start("Measured case");
+            test_case_end();
+        }
+
+        (void) unit_test_context_set(&bench_context);
+    }
+
+    (void) unit_test_context_set(0);
+    test_suite_end();
+    (void) unit_test_context_set(&bench_context);
+}
+
+/**
+ * Time log lines written to each of the built-in sinks, or to the sink of
+ * the default context when there are no built-in sinks.
+ *
+ * @param sink the sink of the default context
+ */
+static void bench_sinks (unit_test_sink_t const *sink)
+{
+    #ifndef UNIT_TEST_LOG_NO_STDIO
+    (void) sink;
+
+    bench_sink("100 log lines to the stdout sink", &unit_test_sink_stdout);
+    bench_sink("100 log lines to the file sink", &unit_test_sink_file);
+    bench_sink("100 log lines to the stdout and file sink",
+        &unit_test_sink_stdout_file);
+    #else
+    bench_sink("100 log lines to the log sink", sink);
+    #endif
+}
+
+/**
+ * Time log lines written to a sink, each line is a failed assert. The log
+ * is flushed at the end of each run, so lines held in a buffer are counted.
+ *
+ * @param name name of the benchmark
+ * @param sink the sink
+ */
+static void bench_sink (char const *name, unit_test_sink_t const *sink)
+{
+    (void) unit_test_context_set(0);
+    unit_test_log_set_sink(sink);
+    (void) unit_test_context_set(&bench_context);
+
+    measured_case_start();
+
+    BENCH_CASE(name, BENCH_SINK_RUNS)
+    {
+        (void) unit_test_context_set(0);
+
+        for (uint32_t index = 0; index < BENCH_LINES; index++)
+        {
+            bench_do_not_optimize(&bench_value);
+            ASSERT_UINT32_EQ(1, bench_value);
+        }
+
+        unit_test_log_flush();
+        (void) unit_test_context_set(&bench_context);
+    }
+
+    measured_case_end();
+
+    (void) unit_test_context_set(0);
+    unit_test_log_set_sink(&discard_sink);
+    (void) unit_test_context_set(&bench_context);
+}
+
+/**
+ * Start the suite and test case the measured asserts run in.
+ */
+static void measured_case_start (void)
+{
+    (void) unit_test_context_set(0);
+    test_suite_start("Measured suite");
+    test_case_start("Measured case");
+    (void) unit_test_context_set(&bench_context);
+}
+
+/**
+ * End the suite and test case the measured asserts run in.
+ */
+static void measured_case_end (void)
+{
+    (void) unit_test_context_set(0);
+    test_case_end();
+    test_suite_end();
+    (void) unit_test_context_set(&bench_context);
+}
+
+/**
+ * Drop the log of the measured context.
+ */
+static void discard_sink_write (void *context, uint8_t const *data,
+    size_t len)
+{
+    (void) context;
+    (void) data;
+    (void) len;
+}
+
+#endif // UNIT_TEST_BENCH
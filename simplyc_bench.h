@@ -0,0 +1,27 @@
+/**
+ * @file simplyc_bench.h
+ *
+ * @brief Holds public declarations for the SimplyC benchmark module.
+ *
+ * @copyright This program is free software. You can redistribute it and/or
+ * modify it under the terms of the GNU General Public License, version 3
+ * (GPLv3).
+ */
+#ifndef _SIMPLYC_BENCH_H_
+#define _SIMPLYC_BENCH_H_
+
+#include "unit_test.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef UNIT_TEST_BENCH
+extern void simplyc_bench(unit_test_timestamp_t);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -9,6 +9,7 @@
  */
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 #include "unit_test.h"
 #include "simplyc_test.h"
 
@@ -16,6 +17,67 @@
 static void test_suite_usage(void);
 static void test_case_usage(void);
 static void test_unit_test(void);
+static void test_log_sink(void);
+static void counting_sink_write(void *, uint8_t const *, size_t);
+#ifdef UNIT_TEST_LOG_ASYNC_SIZE
+static void test_log_drain(void);
+static void held_drain_start(void *, uint8_t const *, size_t);
+static void held_drain_wait(void *);
+#endif
+static void test_verbosity(void);
+#ifdef UNIT_TEST_REGISTRY
+static void test_registry(void);
+#endif
+#ifdef UNIT_TEST_FIXTURES
+static void test_fixtures(void);
+static void fixture_suite_setup(void);
+static void fixture_suite_teardown(void);
+static void fixture_case_setup(void);
+static void fixture_case_teardown(void);
+#endif
+#ifdef UNIT_TEST_PARAMS
+static void test_params(void);
+#endif
+#ifdef UNIT_TEST_PROPERTY
+static void test_property(void);
+static void property_xor_undo(void);
+static void property_below_1000(void);
+static void property_int8_double(void);
+#endif
+#ifdef UNIT_TEST_TIMESTAMPS
+static void test_timestamps(void);
+static uint32_t fake_ticks_get(void);
+#endif
+#ifdef UNIT_TEST_BENCH
+static void test_bench(void);
+#endif
+#ifdef UNIT_TEST_BASELINE
+static void test_baseline(void);
+#endif
+#ifdef UNIT_TEST_STACK
+static void test_stack(void);
+static void stack_use(void);
+#endif
+#ifdef UNIT_TEST_ALLOC
+static void test_alloc(void);
+#endif
+#ifdef UNIT_TEST_FAIL_FAST
+static void test_fail_fast(void);
+#endif
+#ifdef UNIT_TEST_TIMER_MS
+static void test_timeout(void);
+#endif
+#ifdef UNIT_TEST_RESULTS
+static void test_results(void);
+static void results_suite(unit_test_results_format_t);
+static void results_sink_write(void *, uint8_t const *, size_t);
+#endif
+#ifdef UNIT_TEST_RERUN
+static void test_rerun(void);
+#endif
+#ifdef UNIT_TEST_REPORT
+static void test_report(void);
+#endif
 static void test_boolean_asserts(void);
 static void test_int8_asserts(void);
 static void test_uint8_asserts(void);
@@ -23,10 +85,15 @@ static void test_int16_asserts(void);
 static void test_uint16_asserts(void);
 static void test_int32_asserts(void);
 static void test_uint32_asserts(void);
+static void test_mem_asserts(void);
 static void test_int64_asserts(void);
 static void test_uint64_asserts(void);
 static void test_float32_asserts(void);
 static void test_float64_asserts(void);
+static void test_float_array_asserts(void);
+#ifdef UNIT_TEST_GENERIC_ASSERTS
+static void test_generic_asserts(void);
+#endif
 
 /**
  * Entry point of SimplyC unit testing tests.
@@ -37,7 +104,8 @@ void simplyc_test (void)
      * @attention it is assumed that this file is built within a project
      * that defines UNIT_TEST_INT64 and UNIT_TEST_FLOATING_POINT, SimplyC
      * allows support for these to be conditionally compiled, to test them,
-     * must include them
+     * must include them. The test registry is tested when UNIT_TEST_REGISTRY
+     * is also defined, the timestamps when UNIT_TEST_TIMESTAMPS is defined.
      */
      
     // test the SimplyC unit test framework, turn logging on
@@ -51,6 +119,87 @@ void simplyc_test (void)
     // call all the unit test assertion functions and verify they work
     // as expected
     test_unit_test();
+
+    // send the log to a custom sink and verify the output arrives
+    test_log_sink();
+
+    #ifdef UNIT_TEST_LOG_ASYNC_SIZE
+    // hand the log buffers to a drain that keeps them until it is waited for
+    test_log_drain();
+    #endif
+
+    // leave passing cases out of the log and count the run
+    test_verbosity();
+
+    #ifdef UNIT_TEST_REGISTRY
+    // run registered test cases selected by name
+    test_registry();
+    #endif
+
+    #ifdef UNIT_TEST_FIXTURES
+    // share a fixture between registered cases and rebuild it when dirty
+    test_fixtures();
+    #endif
+
+    #ifdef UNIT_TEST_PARAMS
+    // run registered cases over tables of parameters
+    test_params();
+    #endif
+
+    #ifdef UNIT_TEST_PROPERTY
+    // check properties with generated inputs and shrink the failing ones
+    test_property();
+    #endif
+
+    #ifdef UNIT_TEST_TIMESTAMPS
+    // time a test case and suite with a fake timestamp source
+    test_timestamps();
+    #endif
+
+    #ifdef UNIT_TEST_BENCH
+    // benchmark a body whose runs take a known number of fake ticks
+    test_bench();
+    #endif
+
+    #ifdef UNIT_TEST_BASELINE
+    // compare slower runs of a test case with its baseline
+    test_baseline();
+    #endif
+
+    #ifdef UNIT_TEST_STACK
+    // measure the stack used by test cases
+    test_stack();
+    #endif
+
+    #ifdef UNIT_TEST_ALLOC
+    // count the heap allocations of test cases
+    test_alloc();
+    #endif
+
+    #ifdef UNIT_TEST_FAIL_FAST
+    // end test cases at their first failed assert
+    test_fail_fast();
+    #endif
+
+    #ifdef UNIT_TEST_TIMER_MS
+    // end test cases that hang
+    test_timeout();
+    #endif
+
+    #ifdef UNIT_TEST_RESULTS
+    // write the result records to a sink in both formats
+    test_results();
+    #endif
+
+    #ifdef UNIT_TEST_RERUN
+    // run the failed cases first, then only the failed cases
+    test_rerun();
+    #endif
+
+    #ifdef UNIT_TEST_REPORT
+    // keep a failed assert in the report block
+    test_report();
+    #endif
     
     // call the function that allows applications to determine if there
     // is any failed assert during a run
@@ -113,13 +262,504 @@ static void test_case_usage (void)
     test_uint16_asserts();
     test_int32_asserts();
     test_uint32_asserts();
+    test_mem_asserts();
     test_int64_asserts();
     test_uint64_asserts();
     test_float32_asserts();
     test_float64_asserts();
+    test_float_array_asserts();
+    #ifdef UNIT_TEST_GENERIC_ASSERTS
+    test_generic_asserts();
+    #endif
     test_suite_end();
  }
 
+/**
+ * Test sending the log output to a custom sink.
+ */
+static void test_log_sink (void)
+{
+    size_t sink_bytes = 0;
+    unit_test_sink_t const counting_sink =
+    {
+        counting_sink_write, 0, &sink_bytes
+    };
+
+    // this suite is logged to the counting sink only
+    unit_test_log_set_sink(&counting_sink);
+    test_suite_start("Counted log sink");
+    test_suite_end();
+
+    // back to the default sink
+    unit_test_log_set_sink(0);
+
+    test_suite_start("Log sink verification");
+    test_case_start("Test custom log sink, these should pass");
+
+    // a quiet build logs nothing for a suite that passes
+    #if UNIT_TEST_VERBOSITY >= UNIT_TEST_VERBOSITY_SUITES
+    ASSERT_BOOL_EQ(true, sink_bytes > 0);
+    #endif
+
+    test_case_end();
+    test_suite_end();
+}
+
+/**
+ * Test the quiet log level and the stats of a run.
+ */
+static void test_verbosity (void)
+{
+    size_t                  sink_bytes = 0;
+    unit_test_sink_t const  counting_sink =
+    {
+        counting_sink_write, 0, &sink_bytes
+    };
+    unit_test_stats_t const before = unit_test_get_stats();
+    unit_test_stats_t       after;
+
+    unit_test_verbosity_set(UNIT_TEST_VERBOSITY_QUIET);
+
+    // a quiet suite that passes logs nothing
+    unit_test_log_set_sink(&counting_sink);
+    test_suite_start("Quiet passing suite");
+    test_case_start("Test quiet, these should pass");
+    ASSERT_BOOL_EQ(true, true);
+    test_case_end();
+    test_suite_end();
+    unit_test_log_set_sink(0);
+
+    // only the failed case is logged, with the names of its suite and case
+    test_suite_start("Quiet suite");
+    test_case_start("Test quiet passing, these should pass");
+    ASSERT_UINT8_EQ(1, 1);
+    test_case_end();
+    test_case_start("Test quiet failing, these should fail");
+    ASSERT_UINT8_EQ(1, 1);
+    ASSERT_UINT8_EQ(1, 2);
+    test_case_end();
+    test_suite_end();
+
+    unit_test_verbosity_set(UNIT_TEST_VERBOSITY_CASES);
+    after = unit_test_get_stats();
+
+    test_suite_start("Verbosity verification");
+    test_case_start("Test quiet log and stats, these should pass");
+
+    ASSERT_BOOL_EQ(true, 0 == sink_bytes);
+    ASSERT_UINT32_EQ(2, after.suites - before.suites);
+    ASSERT_UINT32_EQ(3, after.cases - before.cases);
+    ASSERT_UINT32_EQ(1, after.cases_failed - before.cases_failed);
+    ASSERT_UINT32_EQ(4, after.asserts - before.asserts);
+    ASSERT_UINT32_EQ(1, after.asserts_failed - before.asserts_failed);
+
+    test_case_end();
+    test_suite_end();
+}
+
+/**
+ * Log sink that counts the bytes written to it.
+ */
+static void counting_sink_write (void *context, uint8_t const *data,
+    size_t len)
+{
+    (void) data;
+    *(size_t *) context += len;
+}
+
+#ifdef UNIT_TEST_LOG_ASYNC_SIZE
+//! A log drain whose transfers end only when the logging call waits for them
+typedef struct
+{
+    uint8_t const *data;
+    size_t         len;
+    size_t         sent;
+} held_drain_t;
+
+/**
+ * Test handing the log buffers to a drain that is slower than the tests.
+ */
+static void test_log_drain (void)
+{
+    held_drain_t                held  = { 0, 0, 0 };
+    unit_test_log_drain_t const drain =
+    {
+        held_drain_start, held_drain_wait, 0, &held
+    };
+    unit_test_log_async_stats_t before;
+    unit_test_log_async_stats_t after;
+
+    unit_test_log_set_drain(&drain);
+    before = unit_test_log_async_stats();
+
+    // each suite end hands a buffer over, the second waits for the first
+    test_suite_start("Held log drain");
+    test_suite_end();
+    test_suite_start("Held log drain again");
+    test_suite_end();
+
+    // back to the default drain, the last buffer is waited for
+    unit_test_log_set_drain(0);
+    after = unit_test_log_async_stats();
+
+    test_suite_start("Log drain verification");
+    test_case_start("Test held log drain, these should pass");
+
+    // a quiet build logs nothing for a suite that passes
+    #if UNIT_TEST_VERBOSITY >= UNIT_TEST_VERBOSITY_SUITES
+    ASSERT_BOOL_EQ(true, (after.buffers - before.buffers) >= 2);
+    ASSERT_BOOL_EQ(true, (after.waits - before.waits) >= 1);
+    #endif
+    ASSERT_UINT32_EQ((uint32_t) held.sent, after.bytes - before.bytes);
+
+    test_case_end();
+    test_suite_end();
+}
+
+/**
+ * Log drain that keeps the buffer handed to it.
+ */
+static void held_drain_start (void *context, uint8_t const *data,
+    size_t len)
+{
+    held_drain_t *const held = context;
+
+    held->data = data;
+    held->len  = len;
+}
+
+/**
+ * Log drain that sends the buffer it keeps when it is waited for. The bytes
+ * are passed on to the log sink so the log is unchanged.
+ */
+static void held_drain_wait (void *context)
+{
+    held_drain_t *const           held = context;
+    unit_test_sink_t const *const sink = unit_test_context_get()->log_sink;
+
+    if (sink)
+    {
+        sink->write(sink->context, held->data, held->len);
+    }
+
+    held->sent += held->len;
+    unit_test_log_drain_done();
+}
+#endif
+
+#ifdef UNIT_TEST_REGISTRY
+//! Number of times the registered test cases have run
+static uint32_t registry_runs = 0;
+
+TEST_SUITE(registry_suite, "Registered suite");
+
+TEST_CASE(registry_suite, registry_case_a, "Registered case a, should pass")
+{
+    registry_runs++;
+    ASSERT_BOOL_EQ(true, true);
+}
+
+TEST_CASE(registry_suite, registry_case_b, "Registered case b, should pass")
+{
+    registry_runs++;
+    ASSERT_BOOL_EQ(false, false);
+}
+
+/**
+ * Test running registered test cases through name filters.
+ */
+static void test_registry (void)
+{
+    uint32_t const all   = unit_test_run("Registered suite");
+    uint32_t const one   = unit_test_run("Registered suite/*case b*");
+    uint32_t const list  = unit_test_run("*case a*,Registered ?uite/*b*");
+    uint32_t const none  = unit_test_run("No such suite,*/No such case");
+    bool const     bad   = unit_test_shard_set("2/2");
+    bool const     shard = unit_test_shard_set("1/2");
+    uint32_t const other = unit_test_run("Registered suite");
+    bool const     reset = unit_test_shard_set(0);
+    #ifdef UNIT_TEST_PARALLEL
+    uint32_t const pool  = unit_test_run_parallel("Registered suite", 4);
+    #endif
+    #ifdef UNIT_TEST_FORK
+    uint32_t const fork  = unit_test_run_forked("Registered suite", 2);
+    #endif
+    uint32_t const runs  = registry_runs;
+
+    test_suite_start("Registry verification");
+    test_case_start("Test registry filters, these should pass");
+
+    ASSERT_UINT32_EQ(2, all);
+    ASSERT_UINT32_EQ(1, one);
+    ASSERT_UINT32_EQ(2, list);
+    ASSERT_UINT32_EQ(0, none);
+    ASSERT_BOOL_EQ  (false, bad);
+    ASSERT_BOOL_EQ  (true,  shard);
+    ASSERT_UINT32_EQ(0, other);
+    ASSERT_BOOL_EQ  (true,  reset);
+    #ifdef UNIT_TEST_FORK
+    // the forked cases count their runs in the worker process
+    ASSERT_UINT32_EQ(2, fork);
+    #endif
+    #ifdef UNIT_TEST_PARALLEL
+    ASSERT_UINT32_EQ(2, pool);
+    ASSERT_UINT32_EQ(7, runs);
+    #else
+    ASSERT_UINT32_EQ(5, runs);
+    #endif
+
+    test_case_end();
+    test_suite_end();
+}
+#endif
+
+#ifdef UNIT_TEST_FIXTURES
+//! State shared by the cases of the fixture suite, 42 when built
+static uint32_t fixture_value = 0;
+
+//! Number of calls of each fixture hook
+static uint32_t fixture_builds    = 0;
+static uint32_t fixture_teardowns = 0;
+static uint32_t fixture_cases     = 0;
+static uint32_t fixture_case_ends = 0;
+
+static unit_test_fixture_t const fixture =
+{
+    fixture_suite_setup, fixture_suite_teardown,
+    fixture_case_setup,  fixture_case_teardown
+};
+
+TEST_SUITE_FIXTURE(fixture_suite, "Fixture suite", fixture);
+
+TEST_CASE(fixture_suite, fixture_read_one, "Fixture read one, should pass")
+{
+    ASSERT_UINT32_EQ(42, fixture_value);
+}
+
+TEST_CASE(fixture_suite, fixture_read_two, "Fixture read two, should pass")
+{
+    ASSERT_UINT32_EQ(42, fixture_value);
+}
+
+TEST_CASE(fixture_suite, fixture_change, "Fixture change, should pass")
+{
+    // the next case gets a fixture built again
+    ASSERT_UINT32_EQ(42, fixture_value);
+    fixture_value = 0;
+    unit_test_fixture_dirty();
+}
+
+/**
+ * Test the fixture of a suite, shared by its cases and built again after a
+ * case marked it dirty.
+ */
+static void test_fixtures (void)
+{
+    uint32_t const shared     = unit_test_run("Fixture suite/Fixture read*");
+    uint32_t const builds     = fixture_builds;
+    uint32_t const all        = unit_test_run("Fixture suite");
+    uint32_t const all_builds = fixture_builds - builds;
+
+    test_suite_start("Fixture verification");
+    test_case_start("Test fixtures, these should pass");
+
+    // the two cases that read the fixture share one build
+    ASSERT_UINT32_EQ(2, shared);
+    ASSERT_UINT32_EQ(1, builds);
+
+    // registry order decides whether a case follows the change
+    ASSERT_UINT32_EQ(3, all);
+    ASSERT_BOOL_EQ  (true, (all_builds >= 1) && (all_builds <= 2));
+    ASSERT_UINT32_EQ(fixture_builds, fixture_teardowns);
+    ASSERT_UINT32_EQ(5, fixture_cases);
+    ASSERT_UINT32_EQ(5, fixture_case_ends);
+
+    test_case_end();
+    test_suite_end();
+}
+
+/**
+ * Build the state shared by the cases of the fixture suite.
+ */
+static void fixture_suite_setup (void)
+{
+    fixture_value = 42;
+    fixture_builds++;
+}
+
+/**
+ * Tear down the state shared by the cases of the fixture suite.
+ */
+static void fixture_suite_teardown (void)
+{
+    fixture_value = 0;
+    fixture_teardowns++;
+}
+
+/**
+ * Count the cases of the fixture suite as they start.
+ */
+static void fixture_case_setup (void)
+{
+    fixture_cases++;
+}
+
+/**
+ * Count the cases of the fixture suite as they end.
+ */
+static void fixture_case_teardown (void)
+{
+    fixture_case_ends++;
+}
+#endif
+
+#ifdef UNIT_TEST_PARAMS
+typedef struct
+{
+    uint8_t  input;
+    uint16_t doubled;
+} param_vector_t;
+
+//! Vectors of the parameterized cases, two of them are wrong
+static param_vector_t const param_vectors[] =
+{
+    { 0, 0 }, { 1, 2 }, { 2, 5 }, { 3, 6 }, { 4, 9 }, { 5, 10 }
+};
+
+//! Sum of the indexes the parameterized cases have run with
+static uint32_t param_index_sum = 0;
+
+TEST_SUITE(param_suite, "Param suite");
+
+TEST_CASE_PARAM(param_suite, param_first, "Param first vectors, should pass",
+    param_vectors, 2)
+{
+    param_vector_t const *const vector = TEST_PARAM(param_vector_t);
+
+    param_index_sum += unit_test_param_index();
+    ASSERT_UINT16_EQ(vector->doubled, (uint16_t) (vector->input * 2));
+}
+
+TEST_CASE_PARAM(param_suite, param_all, "Param all vectors, should fail",
+    param_vectors, sizeof(param_vectors) / sizeof(param_vectors[0]))
+{
+    param_vector_t const *const vector = TEST_PARAM(param_vector_t);
+
+    param_index_sum += unit_test_param_index();
+    ASSERT_UINT16_EQ(vector->doubled, (uint16_t) (vector->input * 2));
+}
+
+/**
+ * Test parameterized test cases, each table is one case.
+ */
+static void test_params (void)
+{
+    unit_test_stats_t const before = unit_test_get_stats();
+    uint32_t const          run    = unit_test_run("Param suite");
+    unit_test_stats_t const after  = unit_test_get_stats();
+
+    test_suite_start("Param verification");
+    test_case_start("Test parameterized cases, these should pass");
+
+    ASSERT_UINT32_EQ(2, run);
+    ASSERT_UINT32_EQ(2, after.cases - before.cases);
+    ASSERT_UINT32_EQ(1, after.cases_failed - before.cases_failed);
+    ASSERT_UINT32_EQ(2, after.asserts_failed - before.asserts_failed);
+
+    // every element ran, the failed ones too
+    ASSERT_UINT32_EQ(1 + 15, param_index_sum);
+
+    test_case_end();
+    test_suite_end();
+}
+#endif
+
+#ifdef UNIT_TEST_PROPERTY
+//! Last input the properties ran with, the logged run is the last
+static uint32_t property_last_u32 = 0;
+static int8_t   property_last_i8  = 0;
+
+/**
+ * Holds for any input: xor with the same value twice gives the value back.
+ */
+static void property_xor_undo (void)
+{
+    uint32_t const value = unit_test_gen_uint32();
+    uint32_t const key   = unit_test_gen_uint32();
+
+    property_last_u32 = value;
+    ASSERT_UINT32_EQ(value, (value ^ key) ^ key);
+}
+
+/**
+ * Fails from 1000 up, the smallest counterexample is 1000.
+ */
+static void property_below_1000 (void)
+{
+    property_last_u32 = unit_test_gen_uint32();
+
+    ASSERT_BOOL_EQ(true, property_last_u32 < 1000u);
+}
+
+/**
+ * Fails when doubling overflows, the smallest counterexample is 64.
+ */
+static void property_int8_double (void)
+{
+    property_last_i8 = unit_test_gen_int8();
+
+    ASSERT_BOOL_EQ(true, (property_last_i8 >= -64) && (property_last_i8 < 64));
+}
+
+/**
+ * Test property checks, a holding one and two failing ones whose inputs
+ * are shrunk to the smallest counterexample.
+ */
+static void test_property (void)
+{
+    unit_test_stats_t before;
+    unit_test_stats_t after;
+    uint32_t          first;
+    bool              held;
+
+    test_suite_start("Property suite");
+
+    test_case_start("Property holds, should pass");
+    held = unit_test_property_check(property_xor_undo, 1000);
+    ASSERT_BOOL_EQ(true, held);
+    test_case_end();
+
+    before = unit_test_get_stats();
+    test_case_start("Property fails and is shrunk, should fail");
+    (void) unit_test_property_check(property_below_1000, 1000);
+    (void) unit_test_property_check(property_int8_double, 1000);
+    test_case_end();
+    after = unit_test_get_stats();
+
+    test_suite_end();
+
+    test_suite_start("Property verification");
+    test_case_start("Test property checks, these should pass");
+
+    // only the logged run of each failing check counts
+    ASSERT_UINT32_EQ(2, after.asserts - before.asserts);
+    ASSERT_UINT32_EQ(2, after.asserts_failed - before.asserts_failed);
+    ASSERT_UINT32_EQ(1000, property_last_u32);
+    ASSERT_INT8_EQ(64, property_last_i8);
+
+    // the same seed generates the same input
+    unit_test_property_seed(0x1234u);
+    (void) unit_test_property_check(property_xor_undo, 1);
+    first = property_last_u32;
+    unit_test_property_seed(0x1234u);
+    (void) unit_test_property_check(property_xor_undo, 1);
+    ASSERT_UINT32_EQ(first, property_last_u32);
+
+    test_case_end();
+    test_suite_end();
+}
+#endif
+
 /**
  * Test the SimplyC boolean assertions.
  */
@@ -345,6 +985,62 @@ static void test_uint32_asserts (void)
     test_case_end();
 }
 
+/**
+ * Test the SimplyC buffer and array assertions.
+ */
+static void test_mem_asserts (void)
+{
+    static uint8_t  expected[1100];
+    static uint8_t  actual[1100];
+    static uint16_t expected16[300];
+    static uint16_t actual16[300];
+    static uint32_t expected32[300];
+    static uint32_t actual32[300];
+
+    for (uint16_t index = 0; index < 1100; index++)
+    {
+        expected[index] = (uint8_t) index;
+        actual[index]   = (uint8_t) index;
+    }
+
+    for (uint16_t index = 0; index < 300; index++)
+    {
+        expected16[index] = (uint16_t) (index * 251u);
+        actual16[index]   = (uint16_t) (index * 251u);
+        expected32[index] = index * 65521u;
+        actual32[index]   = index * 65521u;
+    }
+
+    // test the buffer and array asserts, pass and fail
+    test_case_start("Test buffer asserts, these should pass");
+
+    ASSERT_MEM_EQ(expected, actual, sizeof(expected));
+    ASSERT_MEM_EQ(&expected[3], &actual[3], sizeof(expected) - 3);
+    ASSERT_MEM_EQ(expected, actual, 0);
+    ASSERT_UINT16_ARRAY_EQ(expected16, actual16, 300);
+    ASSERT_UINT32_ARRAY_EQ(expected32, actual32, 300);
+
+    test_case_end();
+
+    test_case_start("Test buffer asserts, these should fail");
+
+    // 3 differences from index 1029, past the equal chunks
+    actual[1029] = 0;
+    actual[1031] = 0;
+    actual[1099] = 0;
+    ASSERT_MEM_EQ(expected, actual, sizeof(expected));
+
+    // a difference in the last element, the window is cut short
+    actual16[299] = 0;
+    ASSERT_UINT16_ARRAY_EQ(expected16, actual16, 300);
+
+    actual32[0]   = 1;
+    actual32[150] = 0;
+    ASSERT_UINT32_ARRAY_EQ(expected32, actual32, 300);
+
+    test_case_end();
+}
+
 /**
  * Test the SimplyC int64 assertions.
  */
@@ -489,5 +1185,768 @@ static void test_float64_asserts (void)
     test_case_end();
 }
 
+/**
+ * Test the SimplyC float array assertions.
+ */
+static void test_float_array_asserts (void)
+{
+    static float32_t expected[10];
+    static float32_t actual[10];
+    volatile float32_t zero = 0.0f;
+
+    // 10 elements, the vector compare and the scalar tail are both used
+    for (uint8_t index = 0; index < 10; index++)
+    {
+        expected[index] = (float32_t) index * 0.5f;
+        actual[index]   = expected[index];
+    }
+
+    // test the float array asserts, pass and fail
+    test_case_start("Test float array asserts, these should pass");
+
+    ASSERT_FLOAT32_ARRAY_NEAR(expected, actual, 10, 0.0f);
+    ASSERT_FLOAT32_ARRAY_ULPS(expected, actual, 10, 0);
+    actual[3] += 0.125f;
+    ASSERT_FLOAT32_ARRAY_NEAR(expected, actual, 10, 0.125f);
+    actual[3] = expected[3];
+
+    // 1 ulp above 1.0, and -0 is the same as +0
+    actual[2] = 1.00000012f;
+    actual[0] = -0.0f;
+    ASSERT_FLOAT32_ARRAY_ULPS(expected, actual, 10, 1);
+    actual[2] = expected[2];
+
+    test_case_end();
+
+    test_case_start("Test float array asserts, these should fail");
+
+    actual[3] += 0.25f;
+    actual[9] += 0.5f;
+    ASSERT_FLOAT32_ARRAY_NEAR(expected, actual, 10, 0.125f);
+
+    // a NaN is out of tolerance however large the tolerance is
+    actual[1] = zero / zero;
+    ASSERT_FLOAT32_ARRAY_NEAR(expected, actual, 10, 1.0f);
+    actual[1] = expected[1];
 
+    actual[2] = 1.00000012f;
+    ASSERT_FLOAT32_ARRAY_ULPS(expected, actual, 3, 0);
+
+    test_case_end();
+}
+
+#ifdef UNIT_TEST_GENERIC_ASSERTS
+/**
+ * Test the type generic asserts, each compares its values in a type that
+ * holds both, so an expected value out of the range of the actual type
+ * fails rather than being truncated.
+ */
+static void test_generic_asserts (void)
+{
+    bool      flag   = true;
+    int8_t    small  = INT8_MIN;
+    uint8_t   byte   = 44;
+    uint16_t  length = 1500;
+    uint32_t  mask   = UINT32_MAX;
+    int       count  = 3;
+    long      delta  = -3L;
+    int32_t   offset = -70000;
+    uint64_t  total  = UINT64_MAX;
+    float32_t gain   = 0.5f;
+    float64_t ratio  = 1.0e-3;
+
+    // test the generic asserts, pass and fail
+    test_case_start("Test generic asserts, these should pass");
+
+    ASSERT_EQ(true, flag);
+    ASSERT_EQ(-128, small);
+    ASSERT_EQ(UINT8_C(44), byte);
+    ASSERT_NE(300, byte);
+    ASSERT_NE(1501, length);
+    ASSERT_EQ((uint16_t) 1500, length);
+    ASSERT_EQ(UINT16_C(1500), length);
+    ASSERT_EQ(UINT32_MAX, mask);
+    ASSERT_EQ(3, count);
+    ASSERT_EQ(-3L, delta);
+    ASSERT_EQ(-count, delta);
+    ASSERT_NE(count, offset);
+    ASSERT_EQ(-70000, offset);
+    ASSERT_EQ(UINT64_MAX, total);
+    ASSERT_EQ(0.5f, gain);
+    ASSERT_NE(1.0e-2, ratio);
+
+    test_case_end();
+
+    test_case_start("Test generic asserts, these should fail");
+
+    // the values are logged in the format of the type that holds both
+    ASSERT_NE(true, flag);
+    ASSERT_EQ(127, small);
+    ASSERT_EQ(300, byte);
+    ASSERT_EQ(1024, length);
+    ASSERT_EQ((uint16_t) 1024, length);
+    ASSERT_EQ(4, count);
+    ASSERT_EQ(count, delta);
+    ASSERT_NE(-70000, offset);
+    ASSERT_EQ(INT64_C(4294897296), offset);
+    ASSERT_EQ(-1, mask);
+    ASSERT_EQ(UINT64_C(0), total);
+    ASSERT_EQ(-0.5f, gain);
+
+    test_case_end();
+}
+#endif
 
+#ifdef UNIT_TEST_TIMESTAMPS
+//! Count returned by the fake timestamp source
+static uint32_t fake_ticks = 0;
+
+/**
+ * Test timing test cases and suites.
+ */
+static void test_timestamps (void)
+{
+    uint32_t case_ticks;
+    uint32_t suite_ticks;
+
+    // each timestamp is 10 ticks after the one before
+    unit_test_timestamp_set(fake_ticks_get);
+    test_suite_start("Timed suite");
+    test_case_start("Timed case, should pass");
+    test_case_end();
+    test_suite_end();
+
+    case_ticks  = unit_test_context_get()->case_ticks;
+    suite_ticks = unit_test_context_get()->suite_ticks;
+
+    // each assert takes a timestamp, 10 ticks after the one before
+    test_suite_start("Performance budgets");
+    test_case_start("Test performance budgets, these should pass");
+    PERF_REGION_BEGIN();
+    ASSERT_MAX_CYCLES(10);
+    ASSERT_MAX_US    (20);
+    test_case_end();
+
+    test_case_start("Test performance budgets, these should fail");
+    ASSERT_MAX_CYCLES(9);
+    PERF_REGION_BEGIN();
+    ASSERT_MAX_US    (9);
+    test_case_end();
+    test_suite_end();
+    unit_test_timestamp_set(0);
+
+    test_suite_start("Timestamp verification");
+    test_case_start("Test timestamps, these should pass");
+
+    ASSERT_UINT32_EQ(10, case_ticks);
+    ASSERT_UINT32_EQ(30, suite_ticks);
+
+    #ifdef UNIT_TEST_CLOCK_US
+    {
+        uint32_t const start = unit_test_clock_us();
+
+        ASSERT_BOOL_EQ(true, (uint32_t) (unit_test_clock_us() - start)
+            < UINT32_C(1000000));
+    }
+    #endif
+
+    test_case_end();
+    test_suite_end();
+}
+
+#ifdef UNIT_TEST_BENCH
+/**
+ * Test the benchmark statistics.
+ */
+static void test_bench (void)
+{
+    // ticks added by each timed run, on top of the 10 from the fake source
+    static uint32_t const run_ticks[] = { 50, 10, 30, 20, 40 };
+    unit_test_bench_t     bench;
+    uint32_t              runs = 0;
+
+    unit_test_timestamp_set(fake_ticks_get);
+    test_suite_start("Benchmark suite");
+
+    BENCH_CASE("Benchmark case, should pass", 5)
+    {
+        if (runs >= UNIT_TEST_BENCH_WARMUP)
+        {
+            fake_ticks += run_ticks[runs - UNIT_TEST_BENCH_WARMUP];
+        }
+
+        runs++;
+        bench_do_not_optimize(&runs);
+    }
+
+    test_suite_end();
+    unit_test_timestamp_set(0);
+
+    bench = unit_test_context_get()->bench;
+
+    test_suite_start("Benchmark verification");
+    test_case_start("Test benchmark statistics, these should pass");
+
+    ASSERT_UINT32_EQ(5 + UNIT_TEST_BENCH_WARMUP, runs);
+    ASSERT_UINT32_EQ(20, bench.min);
+    ASSERT_UINT32_EQ(40, bench.median);
+    ASSERT_UINT32_EQ(60, bench.max);
+    ASSERT_UINT32_EQ(40, bench.mean);
+
+    test_case_end();
+    test_suite_end();
+}
+#endif
+
+#ifdef UNIT_TEST_BASELINE
+/**
+ * Test comparing test cases with the baseline file.
+ */
+static void test_baseline (void)
+{
+    bool warned_pass;
+    bool failed_pass;
+
+    // the first run takes 10 ticks and is the baseline, or matches it
+    unit_test_timestamp_set(fake_ticks_get);
+    test_suite_start("Baseline suite");
+    test_case_start("Baseline case, slower runs warn then fail");
+    test_case_end();
+
+    test_case_start("Baseline case, slower runs warn then fail");
+    fake_ticks += 90;
+    test_case_end();
+    warned_pass = unit_test_context_get()->current_test_case_pass;
+
+    unit_test_baseline_set(UNIT_TEST_BASELINE_THRESHOLD, true);
+    test_case_start("Baseline case, slower runs warn then fail");
+    fake_ticks += 90;
+    test_case_end();
+    failed_pass = unit_test_context_get()->current_test_case_pass;
+
+    unit_test_baseline_set(UNIT_TEST_BASELINE_THRESHOLD, false);
+    test_suite_end();
+    unit_test_timestamp_set(0);
+
+    test_suite_start("Baseline verification");
+    test_case_start("Test baseline comparison, these should pass");
+
+    ASSERT_BOOL_EQ(true,  warned_pass);
+    ASSERT_BOOL_EQ(false, failed_pass);
+
+    test_case_end();
+    test_suite_end();
+}
+#endif
+
+/**
+ * Fake timestamp source, the count goes up by 10 at each call.
+ */
+static uint32_t fake_ticks_get (void)
+{
+    fake_ticks += 10;
+
+    return fake_ticks;
+}
+#endif
+
+#ifdef UNIT_TEST_STACK
+//! Bytes of stack used by stack_use
+#define STACK_USE_LEN 2048
+
+//! Called through a pointer so the compiler cannot inline it, its frame must
+//! be below the frame of test_case_start
+static void (* volatile stack_user)(void) = stack_use;
+
+/**
+ * Test measuring the stack used by test cases.
+ */
+static void test_stack (void)
+{
+    uint8_t  here = 0;
+    uint32_t used;
+
+    // measure 16 KB of stack below this function
+    unit_test_stack_set((void const *) ((uintptr_t) &here - 16384u));
+
+    test_suite_start("Stack suite");
+    test_case_start("Test stack use, these should pass");
+    stack_user();
+    ASSERT_MAX_STACK(STACK_USE_LEN + 1024);
+    test_case_end();
+    used = unit_test_context_get()->stack_used;
+
+    test_case_start("Test stack use, these should fail");
+    stack_user();
+    ASSERT_MAX_STACK(STACK_USE_LEN / 2);
+    test_case_end();
+    test_suite_end();
+
+    unit_test_stack_set(0);
+
+    test_suite_start("Stack verification");
+    test_case_start("Test stack measurement, these should pass");
+
+    // the frames of test_case_start are not counted
+    ASSERT_BOOL_EQ(true, used >  STACK_USE_LEN - 256);
+    ASSERT_BOOL_EQ(true, used <  STACK_USE_LEN + 1024);
+
+    test_case_end();
+    test_suite_end();
+}
+
+/**
+ * Use STACK_USE_LEN bytes of stack.
+ */
+static void stack_use (void)
+{
+    volatile uint8_t buffer[STACK_USE_LEN];
+
+    for (uint16_t index = 0; index < STACK_USE_LEN; index++)
+    {
+        buffer[index] = (uint8_t) index;
+    }
+
+    (void) buffer[0];
+}
+#endif
+
+#ifdef UNIT_TEST_ALLOC
+/**
+ * Test counting the heap allocations of test cases, the allocations are
+ * recorded by hand as an allocator hook would.
+ */
+static void test_alloc (void)
+{
+    uint32_t count;
+    uint32_t peak;
+    bool     leak_pass;
+
+    test_suite_start("Heap suite");
+    test_case_start("Test heap use, these should pass");
+    unit_test_alloc_record(16);
+    unit_test_alloc_record(8);
+    unit_test_free_record(8);
+    unit_test_free_record(16);
+    ALLOC_REGION_BEGIN();
+    ASSERT_NO_ALLOC();
+    ASSERT_MAX_ALLOC_BYTES(0);
+    test_case_end();
+    count = unit_test_context_get()->alloc_count;
+    peak  = unit_test_context_get()->alloc_peak;
+
+    test_case_start("Test heap use, these should fail");
+    unit_test_alloc_record(32);
+    ASSERT_NO_ALLOC();
+    ASSERT_MAX_ALLOC_BYTES(16);
+    test_case_end();
+    leak_pass = unit_test_context_get()->current_test_case_pass;
+    test_suite_end();
+
+    test_suite_start("Heap verification");
+    test_case_start("Test heap counting, these should pass");
+
+    ASSERT_UINT32_EQ(2,  count);
+    ASSERT_UINT32_EQ(24, peak);
+    ASSERT_BOOL_EQ(false, leak_pass);
+
+    test_case_end();
+    test_suite_end();
+}
+#endif
+
+#ifdef UNIT_TEST_FAIL_FAST
+#ifdef UNIT_TEST_REGISTRY
+//! Number of times the fail fast cases have run, and have gone on after a
+//! failed assert
+static uint32_t fail_fast_runs  = 0;
+static uint32_t fail_fast_after = 0;
+
+TEST_SUITE(fail_fast_suite, "Fail fast suite");
+
+TEST_CASE(fail_fast_suite, fail_fast_case_a, "Fail fast first, should fail")
+{
+    fail_fast_runs++;
+    ASSERT_BOOL_EQ(true, false);
+    fail_fast_after++;
+}
+
+TEST_CASE(fail_fast_suite, fail_fast_case_b, "Fail fast second, should fail")
+{
+    fail_fast_runs++;
+    ASSERT_BOOL_EQ(true, false);
+    fail_fast_after++;
+}
+#endif
+
+/**
+ * Test ending test cases at their first failed assert.
+ */
+static void test_fail_fast (void)
+{
+    volatile bool reached = false;
+    #ifdef UNIT_TEST_REGISTRY
+    uint32_t      run;
+    #endif
+
+    test_suite_start("Fail fast checkpoint suite");
+    test_case_start("Test fail fast, these should fail");
+
+    if (TEST_CASE_CHECKPOINT())
+    {
+        ASSERT_BOOL_EQ(true, false);
+        reached = true;
+    }
+
+    test_case_end();
+    test_suite_end();
+
+    #ifdef UNIT_TEST_REGISTRY
+    // stop after the first failed case
+    unit_test_fail_fast_set(true, 1);
+    run = unit_test_run("Fail fast suite");
+    unit_test_fail_fast_set(true, 0);
+    #endif
+
+    test_suite_start("Fail fast verification");
+    test_case_start("Test fail fast, these should pass");
+
+    ASSERT_BOOL_EQ(false, reached);
+    #ifdef UNIT_TEST_REGISTRY
+    ASSERT_UINT32_EQ(1, run);
+    ASSERT_UINT32_EQ(1, fail_fast_runs);
+    ASSERT_UINT32_EQ(0, fail_fast_after);
+    #endif
+
+    test_case_end();
+    test_suite_end();
+}
+#endif
+
+#ifdef UNIT_TEST_TIMER_MS
+//! Counted up by the cases that hang until their timeout expires
+static volatile uint32_t timeout_spins = 0;
+
+#ifdef UNIT_TEST_REGISTRY
+//! Number of times the case after the hung case has run
+static uint32_t timeout_next_runs = 0;
+
+TEST_SUITE(timeout_suite, "Timeout suite");
+
+TEST_CASE_TIMEOUT(timeout_suite, timeout_case_hang,
+    "Timeout hang, should fail", 20)
+{
+    for (;;)
+    {
+        timeout_spins++;
+    }
+}
+
+TEST_CASE(timeout_suite, timeout_case_next, "Timeout next, should pass")
+{
+    timeout_next_runs++;
+    ASSERT_BOOL_EQ(true, true);
+}
+#endif
+
+/**
+ * Test ending test cases that hang with the hosted timer, in milliseconds.
+ */
+static void test_timeout (void)
+{
+    bool     hang_pass;
+    #ifdef UNIT_TEST_REGISTRY
+    uint32_t run;
+    #endif
+
+    unit_test_timer_set(unit_test_timer_ms);
+
+    test_suite_start("Timeout checkpoint suite");
+    test_case_timeout(20);
+    test_case_start("Test timeout, these should fail");
+
+    if (TEST_CASE_CHECKPOINT())
+    {
+        for (;;)
+        {
+            timeout_spins++;
+        }
+    }
+
+    test_case_end();
+    hang_pass = unit_test_context_get()->current_test_case_pass;
+
+    // the timeout was for the case before only
+    test_case_start("Test no timeout, these should pass");
+    ASSERT_BOOL_EQ(true, true);
+    test_case_end();
+    test_suite_end();
+
+    #ifdef UNIT_TEST_REGISTRY
+    run = unit_test_run("Timeout suite");
+    #endif
+
+    unit_test_timer_set(0);
+
+    test_suite_start("Timeout verification");
+    test_case_start("Test timeouts, these should pass");
+
+    ASSERT_BOOL_EQ(false, hang_pass);
+    #ifdef UNIT_TEST_REGISTRY
+    ASSERT_UINT32_EQ(2, run);
+    ASSERT_UINT32_EQ(1, timeout_next_runs);
+    #endif
+
+    test_case_end();
+    test_suite_end();
+}
+#endif
+
+#ifdef UNIT_TEST_RESULTS
+//! Result records written to the results sink, null terminated
+static char results_records[1024];
+
+//! Number of bytes in results_records
+static size_t results_len = 0;
+
+/**
+ * Test the result records in JSON Lines and JUnit XML.
+ */
+static void test_results (void)
+{
+    unit_test_sink_t const results_sink = { results_sink_write, 0, 0 };
+    bool                   json_case_pass;
+    bool                   json_case_fail;
+    bool                   json_assert;
+    bool                   json_counts;
+    uint32_t               json_lines = 0;
+
+    unit_test_results_set_sink(&results_sink);
+
+    results_suite(UNIT_TEST_RESULTS_JSON_LINES);
+
+    json_case_pass = 0 != strstr(results_records,
+        "\"name\":\"Test results, these should pass\",\"passed\":true,"
+        "\"failed_asserts\":0");
+    json_case_fail = 0 != strstr(results_records,
+        "\"name\":\"Test results \\\"quoted\\\", these should fail\","
+        "\"passed\":false,\"failed_asserts\":1");
+    json_assert = 0 != strstr(results_records,
+        "\"message\":\"expected: 1, got: 2\"}\n");
+    json_counts = 0 != strstr(results_records, "\"cases\":2,\"failed\":1");
+
+    for (size_t index = 0; index < results_len; index++)
+    {
+        json_lines += ('\n' == results_records[index]);
+    }
+
+    results_suite(UNIT_TEST_RESULTS_JUNIT);
+    unit_test_results_set_sink(0);
+
+    test_suite_start("Results verification");
+    test_case_start("Test result records, these should pass");
+
+    // suite, 2 cases, the failed assert and the end of the suite
+    ASSERT_UINT32_EQ(5, json_lines);
+    ASSERT_BOOL_EQ(true, json_case_pass);
+    ASSERT_BOOL_EQ(true, json_case_fail);
+    ASSERT_BOOL_EQ(true, json_assert);
+    ASSERT_BOOL_EQ(true, json_counts);
+
+    ASSERT_BOOL_EQ(true, 0 == strncmp(results_records, "<?xml", 5));
+    ASSERT_BOOL_EQ(true, 0 != strstr(results_records,
+        "<testcase classname=\"Results suite\" "
+        "name=\"Test results &quot;quoted&quot;, these should fail\">\n"));
+    ASSERT_BOOL_EQ(true, 0 != strstr(results_records,
+        "<failure type=\"assert\" message=\"expected: 1, got: 2\">"));
+    ASSERT_BOOL_EQ(true, 0 != strstr(results_records,
+        "  </testsuite>\n</testsuites>\n"));
+
+    test_case_end();
+    test_suite_end();
+}
+
+/**
+ * Run a suite with a passing and a failing case, its result records are
+ * written to results_records.
+ *
+ * @param format format of the records
+ */
+static void results_suite (unit_test_results_format_t format)
+{
+    results_len        = 0;
+    results_records[0] = 0;
+
+    unit_test_results_on(0, format);
+    test_suite_start("Results suite");
+
+    test_case_start("Test results, these should pass");
+    ASSERT_UINT8_EQ(1, 1);
+    test_case_end();
+
+    test_case_start("Test results \"quoted\", these should fail");
+    ASSERT_UINT8_EQ(1, 2);
+    test_case_end();
+
+    test_suite_end();
+    unit_test_results_off();
+}
+
+/**
+ * Results sink that keeps the records in results_records.
+ */
+static void results_sink_write (void *context, uint8_t const *data,
+    size_t len)
+{
+    (void) context;
+
+    for (size_t index = 0; (index < len)
+        && (results_len < sizeof(results_records) - 1); index++)
+    {
+        results_records[results_len++] = (char) data[index];
+    }
+
+    results_records[results_len] = 0;
+}
+#endif
+
+#ifdef UNIT_TEST_RERUN
+//! The cases of the rerun suite that have run, one letter each, in order
+static char   rerun_order[16];
+static size_t rerun_len = 0;
+
+//! Number of times the flaky case has run, it only fails the first time
+static uint32_t rerun_flaky_runs = 0;
+
+TEST_SUITE(rerun_suite, "Rerun suite");
+
+TEST_CASE(rerun_suite, rerun_case_pass, "Rerun pass, should pass")
+{
+    rerun_order[rerun_len++] = 'p';
+    ASSERT_BOOL_EQ(true, true);
+}
+
+TEST_CASE(rerun_suite, rerun_case_flaky, "Rerun flaky, should fail once")
+{
+    rerun_order[rerun_len++] = 'f';
+    ASSERT_UINT32_NOT_EQ(0, rerun_flaky_runs++);
+}
+
+TEST_CASE(rerun_suite, rerun_case_fail, "Rerun fail, should fail")
+{
+    rerun_order[rerun_len++] = 'x';
+    ASSERT_BOOL_EQ(true, false);
+}
+
+/**
+ * Test running the failed cases first and only the failed cases.
+ */
+static void test_rerun (void)
+{
+    // not cleared by the framework, a record that is not valid is
+    static unit_test_rerun_record_t record;
+    uint32_t                        all;
+    uint32_t                        only;
+    uint32_t                        first;
+    uint32_t                        again;
+    bool                            order;
+    #ifdef UNIT_TEST_PARALLEL
+    uint32_t                        pool;
+    #endif
+    #ifdef UNIT_TEST_FORK
+    uint32_t                        fork;
+    #endif
+
+    unit_test_rerun_record_set(&record);
+
+    // the flaky case passes from its second run
+    all   = unit_test_run("Rerun suite");
+    unit_test_run_mode_set(UNIT_TEST_RUN_FAILED_ONLY);
+    only  = unit_test_run("Rerun suite");
+
+    // the failed case, then the flaky case that failed before, the order of
+    // the earlier runs is the registry order
+    rerun_len = 0;
+    unit_test_run_mode_set(UNIT_TEST_RUN_FAILED_FIRST);
+    first = unit_test_run("Rerun suite");
+    unit_test_run_mode_set(UNIT_TEST_RUN_FAILED_ONLY);
+    again = unit_test_run("Rerun suite");
+    order = (4 == rerun_len) && (0 == memcmp("xfpx", rerun_order, 4));
+
+    // the other runners select by the record the same way
+    #ifdef UNIT_TEST_PARALLEL
+    pool  = unit_test_run_parallel("Rerun suite", 2);
+    #endif
+    #ifdef UNIT_TEST_FORK
+    fork  = unit_test_run_forked("Rerun suite", 2);
+    #endif
+
+    unit_test_run_mode_set(UNIT_TEST_RUN_ALL);
+    unit_test_rerun_record_set(0);
+
+    test_suite_start("Rerun verification");
+    test_case_start("Test rerun of failed cases, these should pass");
+
+    ASSERT_UINT32_EQ(3, all);
+    ASSERT_UINT32_EQ(2, only);
+    ASSERT_UINT32_EQ(3, first);
+    ASSERT_UINT32_EQ(1, again);
+    ASSERT_BOOL_EQ  (true, order);
+    #ifdef UNIT_TEST_PARALLEL
+    ASSERT_UINT32_EQ(1, pool);
+    #endif
+    #ifdef UNIT_TEST_FORK
+    ASSERT_UINT32_EQ(1, fork);
+    #endif
+    ASSERT_UINT16_EQ(2, record.count);
+
+    test_case_end();
+    test_suite_end();
+}
+#endif
+
+#ifdef UNIT_TEST_REPORT
+/**
+ * Test the failure records and counts of the report block.
+ */
+static void test_report (void)
+{
+    uint32_t const                    before = unit_test_report.failures;
+    unit_test_report_failure_t const *failure;
+    uint16_t                          values[2];
+    int                               line;
+    bool                              complete;
+
+    test_suite_start("Report block suite");
+    test_case_start("Test report block, should fail");
+
+    line = __LINE__ + 1;
+    ASSERT_UINT16_EQ(7, 9);
+
+    test_case_end();
+    test_suite_end();
+
+    (void) unit_test_all_success();
+    complete = (1u == unit_test_report.complete);
+    failure  = &unit_test_report.recent[before
+        % UNIT_TEST_REPORT_MAX_FAILURES];
+    (void) memcpy(values, failure->values, sizeof(values));
+
+    test_suite_start("Report block verification");
+    test_case_start("Test report block, these should pass");
+
+    ASSERT_MEM_EQ   ("SCRB", unit_test_report.magic, 4);
+    ASSERT_UINT32_EQ(before + 1, unit_test_report.failures);
+    ASSERT_UINT16_EQ(UNIT_TEST_FILE, failure->file);
+    ASSERT_UINT16_EQ((uint16_t) line, failure->line);
+    ASSERT_UINT8_EQ (UNIT_TEST_TYPE_UINT16, failure->type);
+    ASSERT_UINT8_EQ (4, failure->len);
+    ASSERT_UINT16_EQ(7, values[0]);
+    ASSERT_UINT16_EQ(9, values[1]);
+    ASSERT_BOOL_EQ  (true, complete);
+    ASSERT_BOOL_EQ  (false, unit_test_report.complete);
+
+    test_case_end();
+    test_suite_end();
+}
+#endif
@@ -15,6 +15,7 @@ extern "C" {
 #endif
 
 extern void simplyc_test(void);
+extern void simplyc_test_cpp(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,176 @@
+/**
+ * @file simplyc_test_cpp.cpp
+ *
+ * @brief Tests of the SimplyC type generic asserts built as C++11, with the
+ * types only C++ has: enums, enum classes, containers and built-in arrays.
+ *
+ * This program is free software. You can redistribute it and/or modify it
+ * under the terms of the GNU General Public License, version 3 (GPLv3).
+ */
+#include <array>
+#include <cstdint>
+#include "unit_test.h"
+#include "simplyc_test.h"
+
+#ifdef UNIT_TEST_GENERIC_ASSERTS
+
+//! An enum with the underlying type picked by the compiler
+enum colour
+{
+    colour_red,
+    colour_green,
+    colour_blue
+};
+
+//! An enum class with a small underlying type
+enum class mode : uint8_t
+{
+    off = 1,
+    on  = 200
+};
+
+// static function declarations
+static void test_generic_ints(void);
+static void test_generic_enums(void);
+static void test_generic_ranges(void);
+
+/**
+ * Entry point of the C++ tests of the SimplyC framework. Call it after
+ * simplyc_test in a project that builds this file as C++11 or later, with
+ * the options simplyc_test is built with. Mixing types that no type holds,
+ * such as ASSERT_EQ(-1, a_uint64), or values of different kinds, such as
+ * ASSERT_EQ(1, an_enum), does not compile, so those are not tested here.
+ */
+void simplyc_test_cpp (void)
+{
+    unit_test_stats_t before;
+    unit_test_stats_t after;
+
+    unit_test_log_on("simplyc_test_cpp_output.txt");
+
+    test_suite_start("C++ generic assert tests");
+    before = unit_test_get_stats();
+    test_generic_ints();
+    test_generic_enums();
+    test_generic_ranges();
+    after = unit_test_get_stats();
+    test_suite_end();
+
+    test_suite_start("C++ generic assert verification");
+    test_case_start("Test the C++ generic assert counts, these should pass");
+
+    ASSERT_UINT32_EQ(6, after.cases - before.cases);
+    ASSERT_UINT32_EQ(3, after.cases_failed - before.cases_failed);
+    ASSERT_UINT32_EQ(29, after.asserts - before.asserts);
+    ASSERT_UINT32_EQ(10, after.asserts_failed - before.asserts_failed);
+
+    test_case_end();
+    test_suite_end();
+
+    unit_test_log_off();
+}
+
+/**
+ * Test integers of the C++ types and widths, and expected values outside
+ * the range of the actual type, which fail rather than being truncated.
+ */
+static void test_generic_ints (void)
+{
+    bool               flag   = true;
+    char               letter = 'a';
+    uint8_t            byte   = 44;
+    int32_t            offset = -70000;
+    uint32_t           mask   = UINT32_MAX;
+    unsigned long long total  = 5;
+    float32_t          gain   = 0.5f;
+
+    test_case_start("Test C++ generic int asserts, these should pass");
+
+    ASSERT_EQ(true, flag);
+    ASSERT_EQ('a', letter);
+    ASSERT_EQ(44, byte);
+    ASSERT_NE(300, byte);
+    ASSERT_EQ(-70000, offset);
+    ASSERT_NE(INT64_C(4294897296), offset);
+    ASSERT_EQ(UINT32_MAX, mask);
+    ASSERT_NE(-1, mask);
+    ASSERT_EQ(5u, total);
+    ASSERT_EQ(0.5, gain);
+
+    test_case_end();
+
+    test_case_start("Test C++ generic int asserts, these should fail");
+
+    // each is compared in a type that holds both values
+    ASSERT_EQ(300, byte);
+    ASSERT_EQ(INT64_C(4294897296), offset);
+    ASSERT_EQ(-1, mask);
+    ASSERT_EQ(6u, total);
+
+    test_case_end();
+}
+
+/**
+ * Test enums and enum classes, compared by their underlying type.
+ */
+static void test_generic_enums (void)
+{
+    colour const paint = colour_green;
+    mode const   power = mode::on;
+
+    test_case_start("Test C++ generic enum asserts, these should pass");
+
+    ASSERT_EQ(colour_green, paint);
+    ASSERT_NE(colour_blue, paint);
+    ASSERT_EQ(mode::on, power);
+    ASSERT_NE(mode::off, power);
+
+    test_case_end();
+
+    test_case_start("Test C++ generic enum asserts, these should fail");
+
+    ASSERT_EQ(colour_red, paint);
+    ASSERT_EQ(mode::off, power);
+
+    test_case_end();
+}
+
+/**
+ * Test containers and built-in arrays, compared by the width of their
+ * elements, and a difference in length.
+ */
+static void test_generic_ranges (void)
+{
+    std::array<uint8_t, 4> const  bytes        = {{ 1, 2, 3, 4 }};
+    uint8_t const                 raw[4]       = { 1, 2, 3, 4 };
+    uint8_t const                 short_raw[3] = { 1, 2, 3 };
+    std::array<uint16_t, 3> const halves       = {{ 1000, 2000, 3000 }};
+    uint16_t const                other[3]     = { 1000, 2001, 3000 };
+    std::array<uint32_t, 2> const words        = {{ 70000, 80000 }};
+    uint32_t const                more[2]      = { 70000, 80000 };
+    std::array<mode, 2> const     modes        = {{ mode::on, mode::off }};
+    std::array<mode, 2> const     swapped      = {{ mode::off, mode::on }};
+    mode const                    states[2]    = { mode::on, mode::off };
+
+    test_case_start("Test C++ generic range asserts, these should pass");
+
+    ASSERT_EQ(raw, bytes);
+    ASSERT_EQ(bytes, raw);
+    ASSERT_EQ(halves, halves);
+    ASSERT_EQ(more, words);
+    ASSERT_EQ(states, modes);
+
+    test_case_end();
+
+    test_case_start("Test C++ generic range asserts, these should fail");
+
+    // the lengths are compared first
+    ASSERT_EQ(short_raw, bytes);
+    ASSERT_EQ(bytes, short_raw);
+    ASSERT_EQ(other, halves);
+    ASSERT_EQ(swapped, modes);
+
+    test_case_end();
+}
+
+#endif // UNIT_TEST_GENERIC_ASSERTS
@@ -10,39 +10,282 @@
  * modify it under the terms of the GNU General Public License, version 3 
  * (GPLv3).
  */
+#if (defined(UNIT_TEST_PARALLEL) || defined(UNIT_TEST_FORK) \
+    || defined(UNIT_TEST_LOG_ASYNC_THREAD) \
+    || ((defined(UNIT_TEST_TIMESTAMPS) || defined(UNIT_TEST_BENCH) \
+        || defined(UNIT_TEST_BASELINE) || defined(UNIT_TEST_TIMEOUT)) \
+        && (defined(__unix__) || defined(__APPLE__)))) \
+    && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L   // to provide pthreads, fork, sysconf,
+                                  // clock_gettime and sigaction
+#endif
+
 #include <stdbool.h>       // allow the use of boolean data type
 #include <stdint.h>        // standard fixed-width data types
+#include <string.h>        // to provide memcmp/memcpy/strlen
 #include "unit_test.h"     // common declarations for the unit test project
 
 #ifdef UNIT_TEST_FLOATING_POINT
 #include <math.h>          // to provide fabs
 #endif
 
+#if defined(__SSE2__)
+#include <emmintrin.h>     // to provide the SSE2 compares
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>      // to provide the NEON compares
+#endif
+
+#if defined(UNIT_TEST_PARALLEL) || defined(UNIT_TEST_FORK)
+#include <stdlib.h>        // to provide calloc/realloc/free
+#include <unistd.h>        // to provide sysconf/fork/pipe
+#endif
+
+#if defined(UNIT_TEST_PARALLEL) || defined(UNIT_TEST_LOG_ASYNC_THREAD)
+#include <pthread.h>       // to provide the worker and log drain threads
+#endif
+
+#ifdef UNIT_TEST_FORK
+#include <errno.h>         // to provide EINTR
+#include <poll.h>          // to provide poll
+#include <stdio.h>         // to provide fflush
+#include <sys/wait.h>      // to provide waitpid
+#endif
+
+#ifdef UNIT_TEST_CLOCK_US
+#include <time.h>          // to provide clock_gettime
+#endif
+
+#ifdef UNIT_TEST_TIMER_MS
+#include <signal.h>        // to provide sigaction
+#include <sys/time.h>      // to provide setitimer
+#endif
+
+#ifdef UNIT_TEST_BASELINE
+#include <stdlib.h>        // to provide malloc/realloc/free/strtoul
+#endif
+
+#if defined(UNIT_TEST_RERUN) && defined(UNIT_TEST_LOG) \
+    && !defined(UNIT_TEST_LOG_NO_STDIO)
+#include <stdlib.h>        // to provide malloc/free
+#endif
+
+#if defined(UNIT_TEST_RESULTS) && !defined(UNIT_TEST_LOG)
+#include <stdio.h>         // to provide snprintf
+#endif
+
 #ifdef UNIT_TEST_LOG
+#include <stdio.h>         // to provide snprintf/fopen/fwrite
+
+//! true while logging is turned on
+static bool log_enabled = false;
+
+#ifndef UNIT_TEST_LOG_NO_STDIO
 //! Unit test results can be logged to a file
-#include <stdio.h>         // to provide printf/fprintf/snprintf
 static FILE *log_file = 0;
+
+// built-in sink functions
+static void sink_stdout_write(void *, uint8_t const *, size_t);
+static void sink_stdout_flush(void *);
+static void sink_file_write(void *, uint8_t const *, size_t);
+static void sink_file_flush(void *);
+static void sink_stdout_file_write(void *, uint8_t const *, size_t);
+static void sink_stdout_file_flush(void *);
+
+unit_test_sink_t const unit_test_sink_stdout =
+{
+    sink_stdout_write, sink_stdout_flush, 0
+};
+
+unit_test_sink_t const unit_test_sink_file =
+{
+    sink_file_write, sink_file_flush, 0
+};
+
+unit_test_sink_t const unit_test_sink_stdout_file =
+{
+    sink_stdout_file_write, sink_stdout_file_flush, 0
+};
+
+//! By default text is written to stdout and the log file, binary records
+//! only to the log file
+#ifdef UNIT_TEST_LOG_BINARY
+#define LOG_DEFAULT_SINK (&unit_test_sink_file)
+#else
+#define LOG_DEFAULT_SINK (&unit_test_sink_stdout_file)
+#endif
+#else
+//! Without stdio there is no built-in sink, one must be set
+#define LOG_DEFAULT_SINK ((unit_test_sink_t const *) 0)
+#endif
+#endif
+
+#if defined(UNIT_TEST_LOG) && !defined(UNIT_TEST_LOG_BINARY)
+//! Text format of each log event, indexed by unit_test_event_t
+#define LOG_FORMAT_ENTRY(id, fmt, arg) fmt,
+static char const * const log_formats[] =
+{
+    UNIT_TEST_LOG_EVENTS(LOG_FORMAT_ENTRY)
+};
+
+//! Maximum length of a formatted log message
+#define MAX_LOG_LEN ((int) UNIT_TEST_MAX_LOG_LEN)
+
+//! Buffer of the current context used to format a log message before it is
+//! written
+#define LOG_LINE (current_context->log_line)
+#endif
+
+#ifdef UNIT_TEST_PROPERTY
+//! Number of generated values of a run that are recorded to shrink them
+#define PROPERTY_MAX_DRAWS ((uint16_t) UNIT_TEST_PROPERTY_MAX_DRAWS)
+
+//! Number of runs spent shrinking the input of a failed property check
+#define PROPERTY_MAX_SHRINKS ((uint32_t) UNIT_TEST_PROPERTY_MAX_SHRINKS)
+#endif
+
+#if defined(UNIT_TEST_LOG) && defined(UNIT_TEST_LOG_RING_SIZE)
+//! Each message in the ring is stored behind a 2 byte length, this allows
+//! whole messages to be dropped when the ring overflows
+#define RING_PREFIX_LEN ((size_t) 2)
+
+//! Ring buffer holding log messages until they are flushed
+static uint8_t log_ring[UNIT_TEST_LOG_RING_SIZE];
+
+//! Index of the oldest byte in the ring
+static size_t log_ring_tail = 0;
+
+//! Number of bytes in the ring
+static size_t log_ring_used = 0;
+
+//! Number of messages dropped since the last flush
+static uint16_t log_ring_dropped = 0;
+
+//! Set while the drop notice is written past the ring, ahead of its messages
+static bool log_ring_bypass = false;
+#endif
+
+#if defined(UNIT_TEST_LOG) && defined(UNIT_TEST_LOG_ASYNC_SIZE)
+//! The two log buffers, one is filled while the other is sent by the drain
+static uint8_t log_async[2][UNIT_TEST_LOG_ASYNC_SIZE];
+
+//! Index of the buffer being filled
+static uint8_t log_async_fill = 0;
+
+//! Number of bytes in the buffer being filled
+static size_t log_async_used = 0;
+
+//! true from the start of a transfer until the drain reports it done
+static volatile bool log_async_busy = false;
+
+//! The busy flag is cleared by an interrupt handler or another thread, with
+//! GCC atomics this also orders the accesses to the buffer and the sink
+#ifdef __GNUC__
+#define ASYNC_BUSY_GET()     __atomic_load_n(&log_async_busy, __ATOMIC_ACQUIRE)
+#define ASYNC_BUSY_SET(busy) \
+    __atomic_store_n(&log_async_busy, (busy), __ATOMIC_RELEASE)
+#else
+#define ASYNC_BUSY_GET()     (log_async_busy)
+#define ASYNC_BUSY_SET(busy) (log_async_busy = (busy))
+#endif
+
+//! Producer statistics since logging was turned on
+static unit_test_log_async_stats_t log_async_counts;
+
+#ifdef UNIT_TEST_LOG_ASYNC_THREAD
+// built-in drain functions
+static void drain_thread_start(void *, uint8_t const *, size_t);
+static void drain_thread_wait(void *);
+static void drain_thread_stop(void *);
+static void *drain_thread_main(void *);
+
+unit_test_log_drain_t const unit_test_log_drain_thread =
+{
+    drain_thread_start, drain_thread_wait, drain_thread_stop, 0
+};
+
+//! Guards the hand-over between the test thread and the drain thread
+static pthread_mutex_t drain_lock = PTHREAD_MUTEX_INITIALIZER;
+
+//! Signalled when a buffer is handed over, sent or the thread is stopped
+static pthread_cond_t drain_cond = PTHREAD_COND_INITIALIZER;
+
+//! The drain thread, started by the first buffer handed to it
+static pthread_t drain_thread;
+
+//! true while the drain thread runs, used by the test thread only
+static bool drain_running = false;
+
+//! true to make the drain thread exit once it has sent its buffer
+static bool drain_stopping = false;
+
+//! The buffer handed to the drain thread, null when it has none
+static uint8_t const *drain_data = 0;
+
+//! Number of bytes in the buffer handed to the drain thread
+static size_t drain_len = 0;
+
+//! The background writer thread is the default drain
+#define LOG_DEFAULT_DRAIN (&unit_test_log_drain_thread)
+#else
+//! Without a drain the buffers are written to the sink as they fill
+#define LOG_DEFAULT_DRAIN ((unit_test_log_drain_t const *) 0)
+#endif
+
+//! The drain sending the buffers
+static unit_test_log_drain_t const *log_drain = LOG_DEFAULT_DRAIN;
 #endif
 
-//! Maximum length of an error message
-#define MAX_MSG_LEN ((int) 100)
+#if defined(UNIT_TEST_LOG) && defined(UNIT_TEST_LOG_BINARY) \
+    && !defined(UNIT_TEST_FILE_IDS)
+//! Binary log records refer to source files by id, without UNIT_TEST_FILE_IDS
+//! the ids are assigned as the file names are seen
+#define LOG_FILE_NAMES 1
 
-//! Buffer used to create assertion failure messages
-static char error_msg[MAX_MSG_LEN + 1];
+//! Number of source file names remembered by the binary log. Each name is
+//! written to the log once and referred to by its id after that.
+#define LOG_MAX_FILES ((uint16_t) UNIT_TEST_LOG_MAX_FILES)
+#endif
+
+//! Maximum length of an error message. The error_msg buffer of the context
+//! is used to create assertion failure messages, in binary mode it holds the
+//! raw failure record instead of text.
+#define MAX_MSG_LEN ((int) UNIT_TEST_MAX_MSG_LEN)
+
+//! Buffer of the current context used to create assertion failure messages
+#define ERROR_MSG (current_context->error_msg)
+
+//! Bytes compared at a time by the buffer asserts, a multiple of the width
+//! of every element type
+#define MEM_CHUNK ((size_t) 16)
+
+//! Keep the values of a failed assert for its record in the report block
+#ifdef UNIT_TEST_REPORT
+#define REPORT_VALUES(t, e, a)     report_values(t, &(e), &(a), sizeof(e))
+#define REPORT_VALUE(t, e)         report_values(t, &(e), 0, sizeof(e))
+#define REPORT_WIDE(t, q, e, a)    report_wide(t, q, e, a)
+#else
+#define REPORT_VALUES(t, e, a)     ((void) 0)
+#define REPORT_VALUE(t, e)         ((void) 0)
+#define REPORT_WIDE(t, q, e, a)    ((void) 0)
+#endif
 
 //! Macro to allow creation of assertion failure messages when 2 values
 //! should be equal. By default, this uses snprintf. Change this to suit
 //! your environment if needed.\n
 //!
 //! msg: char buffer used to hold the message    \n
+//! t:   type tag of the values                  \n
 //! s:   format string                           \n
 //! e:   expected value                          \n
 //! a:   actual value                            \n
-#ifdef UNIT_TEST_LOG
-#define EQ_ERR_MSG_CREATE(msg, s, e, a) \
-    (void) snprintf(msg, MAX_MSG_LEN, s, e, a)
+#if defined(UNIT_TEST_LOG) && defined(UNIT_TEST_LOG_BINARY)
+#define EQ_ERR_MSG_CREATE(msg, t, s, e, a) (REPORT_VALUES(t, e, a), \
+    log_bin_values(msg, UNIT_TEST_EVT_ASSERT_EQ, t, &(e), &(a), sizeof(e)))
+#elif defined(UNIT_TEST_LOG)
+#define EQ_ERR_MSG_CREATE(msg, t, s, e, a) (REPORT_VALUES(t, e, a), \
+    (void) snprintf(msg, MAX_MSG_LEN, s, e, a))
 #else
-#define EQ_ERR_MSG_CREATE(msg, s, e, a) ((void) 0)
+#define EQ_ERR_MSG_CREATE(msg, t, s, e, a) REPORT_VALUES(t, e, a)
 #endif
     
 //! Macro to allow creation of assertion failure messages when a value is equal
@@ -50,40 +293,627 @@ static char error_msg[MAX_MSG_LEN + 1];
 //! this to suit your environment if needed.\n
 //!
 //! msg: char buffer used to hold the message
+//! t:   type tag of the value                   \n
 //! s:   format string                           \n
 //! e:   value that is not expected              \n
-#ifdef UNIT_TEST_LOG
-#define NOT_EQ_ERR_MSG_CREATE(msg, s, e) \
-    (void) snprintf(msg, MAX_MSG_LEN, s, e)
+#if defined(UNIT_TEST_LOG) && defined(UNIT_TEST_LOG_BINARY)
+#define NOT_EQ_ERR_MSG_CREATE(msg, t, s, e) (REPORT_VALUE(t, e), \
+    log_bin_values(msg, UNIT_TEST_EVT_ASSERT_NOT_EQ, t, &(e), 0, sizeof(e)))
+#elif defined(UNIT_TEST_LOG)
+#define NOT_EQ_ERR_MSG_CREATE(msg, t, s, e) (REPORT_VALUE(t, e), \
+    (void) snprintf(msg, MAX_MSG_LEN, s, e))
+#else
+#define NOT_EQ_ERR_MSG_CREATE(msg, t, s, e) REPORT_VALUE(t, e)
+#endif
+
+#if defined(UNIT_TEST_COMPACT_ASSERTS) && defined(UNIT_TEST_LOG)
+//! Description of each type tag used to create assertion failure messages,
+//! indexed by unit_test_type_t
+typedef struct
+{
+    uint8_t          width;
+    unit_test_kind_t kind;
+    #ifndef UNIT_TEST_LOG_BINARY
+    char const      *eq_format;
+    char const      *not_eq_format;
+    #endif
+} type_desc_t;
+
+#ifdef UNIT_TEST_LOG_BINARY
+#define TYPE_DESC_ENTRY(tag, width, kind, eq, not_eq) { width, kind },
+#else
+#define TYPE_DESC_ENTRY(tag, width, kind, eq, not_eq) \
+    { width, kind, eq, not_eq },
+#endif
+
+static type_desc_t const type_descs[] =
+{
+    UNIT_TEST_TYPES(TYPE_DESC_ENTRY)
+};
+#endif
+
+//! Macro to allow creation of assertion failure messages for the compact
+//! integer asserts, the values are passed widened.\n
+//!
+//! msg: char buffer used to hold the message    \n
+//! t:   type tag of the values                  \n
+//! q:   true if the values should be equal      \n
+//! e:   expected value                          \n
+//! a:   actual value                            \n
+#if defined(UNIT_TEST_LOG) && defined(UNIT_TEST_LOG_BINARY)
+#define INT_ERR_MSG_CREATE(msg, t, q, e, a) (REPORT_WIDE(t, q, e, a), \
+    log_bin_wide(msg, t, q, e, a))
+#elif defined(UNIT_TEST_LOG)
+#define INT_ERR_MSG_CREATE(msg, t, q, e, a) (REPORT_WIDE(t, q, e, a), \
+    int_msg_create(msg, t, q, e, a))
+#else
+#define INT_ERR_MSG_CREATE(msg, t, q, e, a) REPORT_WIDE(t, q, e, a)
+#endif
+
+//! The current context of each thread is thread-local with UNIT_TEST_THREADS
+#define THREAD_LOCAL UNIT_TEST_THREAD_LOCAL
+
+//! Context used by the global API until another one is set. In a context:\n
+//!
+//! test_suite_active       true if a test suite is currently executing \n
+//! test_case_active        true if a test case is currently executing  \n
+//! current_test_case_pass  false if a test case assertion failed       \n
+//! failed_assert           true if any asserts fail during a run       \n
+//! test_suite_num          number of the last test suite started       \n
+static unit_test_context_t default_context =
+{
+    .current_test_case_pass = true,
+    #ifdef UNIT_TEST_PROPERTY
+    .property_seed          = UNIT_TEST_PROPERTY_SEED,
+    .property_rng           = UNIT_TEST_PROPERTY_SEED,
+    #endif
+    #ifdef UNIT_TEST_LOG
+    .log_sink               = LOG_DEFAULT_SINK,
+    #endif
+};
+
+//! Context used by the framework functions and the asserts
+static THREAD_LOCAL unit_test_context_t *current_context = &default_context;
+
+//! Log level set by unit_test_verbosity_set
+static uint8_t log_verbosity = UNIT_TEST_VERBOSITY;
+
+//! true if messages of a log level are logged, the levels above
+//! UNIT_TEST_VERBOSITY are compiled out
+#define LOG_LEVEL(level) \
+    ((UNIT_TEST_VERBOSITY >= (level)) && (log_verbosity >= (level)))
+
+//! Count an assert checked in the current context
+#define ASSERT_COUNT() (current_context->stats.asserts++)
+
+#ifdef UNIT_TEST_INLINE_ASSERTS
+THREAD_LOCAL uint32_t unit_test_inline_passed = 0;
+#endif
+
+#ifdef UNIT_TEST_REGISTRY
+//! Table of test cases set by unit_test_registry_set, when not set the
+//! linker section is used
+static unit_test_case_t const * const *registry_table = 0;
+
+//! Number of test cases in registry_table
+static size_t registry_count = 0;
+
+#ifdef UNIT_TEST_REGISTRY_SECTION
+//! Bounds of the unit_test_cases section, provided by the linker. These are
+//! weak so that a program without registered cases still links.
+extern unit_test_case_t const * const __start_unit_test_cases[]
+    __attribute__((weak));
+extern unit_test_case_t const * const __stop_unit_test_cases[]
+    __attribute__((weak));
+#endif
+#endif
+
+#ifdef UNIT_TEST_TIMESTAMPS
+//! Timestamp source set by unit_test_timestamp_set, null when not timing
+static unit_test_timestamp_t timestamp_source = 0;
+#endif
+
+#ifdef UNIT_TEST_FLOATING_POINT
+//! Errors of a float array compared against a tolerance
+typedef struct
+{
+    uint32_t  out; //!< number of elements out of tolerance
+    float32_t max; //!< largest error, NaNs left out
+    float64_t sum; //!< sum of the errors
+} float_errors_t;
+#endif
+
+#ifdef UNIT_TEST_FAIL_FAST
+//! true if a failed assert ends the test case, set by unit_test_fail_fast_set
+static bool fail_fast_enabled = true;
+
+//! Number of failed cases after which the registry runners stop, 0 for no
+//! limit
+static uint32_t fail_fast_limit = 0;
+#endif
+
+#ifdef UNIT_TEST_TIMEOUT
+//! Timer set by unit_test_timer_set, null when cases have no timeout
+static unit_test_timer_t timeout_timer = 0;
+#endif
+
+#ifdef UNIT_TEST_REPORT
+//! The report block, in a section of its own so the linker script can give
+//! it a fixed address
+#if defined(__GNUC__) && defined(__ELF__)
+#define REPORT_PLACE __attribute__((used, section(UNIT_TEST_REPORT_SECTION)))
 #else
-#define NOT_EQ_ERR_MSG_CREATE(msg, s, e) ((void) 0)
+#define REPORT_PLACE
+#endif
+
+unit_test_report_t unit_test_report REPORT_PLACE;
+
+//! Values of the failed assert being recorded, kept by the failure message
+//! macros until assert_record adds the failure to the report block
+static uint8_t report_type = 0;
+static uint8_t report_len  = 0;
+static uint8_t report_data[sizeof(unit_test_report.recent[0].values)];
+#endif
+
+#ifdef UNIT_TEST_RESULTS
+//! true while result records are written
+static bool results_enabled = false;
+
+//! Format of the result records
+static unit_test_results_format_t results_format =
+    UNIT_TEST_RESULTS_JSON_LINES;
+
+//! Sink of the result records when no results file is open
+static unit_test_sink_t const *results_sink = 0;
+
+//! Maximum length of a result record
+#define RESULTS_LEN ((size_t) UNIT_TEST_RESULTS_MAX_LEN)
+
+//! Room kept after a name or message for the rest of its record
+#define RESULTS_TAIL ((size_t) 80)
+
+#if defined(UNIT_TEST_LOG) && !defined(UNIT_TEST_LOG_NO_STDIO)
+//! Result records can be written to a file of their own
+static FILE *results_file = 0;
+
+// results file sink functions
+static void results_file_write(void *, uint8_t const *, size_t);
+static void results_file_flush(void *);
+
+static unit_test_sink_t const results_file_sink =
+{
+    results_file_write, results_file_flush, 0
+};
+#endif
+#endif
+
+#ifdef UNIT_TEST_ALLOC_WRAP
+//! Header in front of each block allocated through the wrappers, the union
+//! keeps the block aligned for any type
+typedef union
+{
+    struct
+    {
+        size_t                     size;
+        unit_test_context_t const *owner; //!< context the block is counted
+                                          //!< in, null if it is not counted
+        uint32_t                   alloc_case;
+    } block;
+    long double align_float;
+    long long   align_int;
+    void       *align_pointer;
+} alloc_header_t;
+
+//! The allocator functions wrapped by the linker
+extern void *__real_malloc (size_t);
+extern void *__real_calloc (size_t, size_t);
+extern void *__real_realloc(void *, size_t);
+extern void  __real_free   (void *);
+#endif
+
+#ifdef UNIT_TEST_BASELINE
+//! Ticks of a test case in the baseline, key is "suite/case"
+typedef struct
+{
+    char    *key;
+    uint32_t ticks;
+} baseline_entry_t;
+
+//! Cases of the baseline, loaded by unit_test_log_on
+static baseline_entry_t *baseline_entries = 0;
+static size_t            baseline_count   = 0;
+static size_t            baseline_size    = 0;
+
+//! true when cases have been added to the baseline since it was loaded
+static bool baseline_changed = false;
+
+//! Name of the baseline file, null when logging is not to a file
+static char *baseline_file_name = 0;
+
+//! Percentage a case can be slower than its baseline
+static uint16_t baseline_threshold = UNIT_TEST_BASELINE_THRESHOLD;
+
+//! true if a case slower than its baseline fails
+static bool baseline_fail = false;
+
+#ifdef UNIT_TEST_PARALLEL
+//! The worker threads of a parallel run share the baseline
+static pthread_mutex_t baseline_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+#endif
+
+#ifdef UNIT_TEST_REGISTRY
+//! Shard of the selected suites to run, set by unit_test_shard_set
+static size_t shard_index = 0;
+
+//! Number of shards the selected suites are split into
+static size_t shard_count = 1;
+#endif
+
+#ifdef UNIT_TEST_RERUN
+//! Magic of a valid rerun record
+#define RERUN_MAGIC 0x52524e31u
+
+//! Rank of a case that failed the last time, above any failure rate
+#define RERUN_RANK_FAILED 101u
+
+//! The record used when the application does not set one, a record of no
+//! cases has a check value of 0
+static unit_test_rerun_record_t rerun_default =
+{
+    RERUN_MAGIC, 0, 0, { { 0, 0, 0, 0, 0 } }
+};
+static unit_test_rerun_record_t *rerun_record = &rerun_default;
+
+//! How the runners use the record, set by unit_test_run_mode_set
+static unit_test_run_mode_t rerun_mode = UNIT_TEST_RUN_ALL;
+
+//! true while a runner runs a pass of the cases of rank rerun_rank
+static bool     rerun_passing = false;
+static uint16_t rerun_rank    = 0;
+
+#if defined(UNIT_TEST_LOG) && !defined(UNIT_TEST_LOG_NO_STDIO)
+//! Name of the rerun file, null when logging is not to a file
+static char *rerun_file_name = 0;
+
+//! true when the record has changed since it was loaded
+static bool rerun_changed = false;
+#endif
+
+#ifdef UNIT_TEST_PARALLEL
+//! The worker threads of a parallel run share the record
+static pthread_mutex_t rerun_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+#endif
+
+#if defined(UNIT_TEST_PARALLEL) || defined(UNIT_TEST_FORK)
+//! A suite run by the parallel or forked runner and its buffered log output
+typedef struct
+{
+    size_t   first;              //!< index of the first selected case
+    uint16_t number;             //!< test suite number to log
+    bool     done;               //!< true when the suite has been run
+    uint8_t *output;             //!< log output of the suite
+    size_t   output_len;
+    size_t   output_size;
+} run_suite_t;
 #endif
 
-//! true   if a test suite is currently executing
-//! false  if a test suite is currently NOT executing
-static bool test_suite_active = false;
+#ifdef UNIT_TEST_PARALLEL
 
-//! true   if a test case is currently executing
-//! false  if a test case is currently NOT executing
-static bool test_case_active = false;
+//! Suites queued for a worker. The worker takes suites from the head, other
+//! workers steal them from the tail.
+typedef struct
+{
+    pthread_mutex_t lock;
+    size_t         *slots;       //!< indexes of the queued suites
+    size_t          head;
+    size_t          tail;
+} parallel_queue_t;
+
+struct parallel_run;
+
+//! State of one worker thread
+typedef struct
+{
+    struct parallel_run *run;
+    size_t               index;  //!< index of the worker in the run
+    parallel_queue_t     queue;
+    run_suite_t    *suite;  //!< suite being run
+    unit_test_sink_t     sink;   //!< sink buffering the log of the suite
+    unit_test_context_t  context;
+    uint32_t             cases;  //!< number of test cases run
+    pthread_t            thread;
+    bool                 started;
+} parallel_worker_t;
+
+//! State shared by the workers of a parallel run
+typedef struct parallel_run
+{
+    unit_test_case_t const * const *cases;
+    size_t                          count;
+    char const                     *filter;
+    run_suite_t               *suites;
+    size_t                          suite_count;
+    parallel_worker_t              *workers;
+    size_t                          worker_count;
+    unit_test_sink_t const         *sink;        //!< sink of the caller
+    pthread_mutex_t                 output_lock;
+    size_t                          next_output; //!< next suite to output
+} parallel_run_t;
+#endif
+
+#ifdef UNIT_TEST_FORK
+//! Frames sent by a worker process to the parent. Each frame is a type byte
+//! and a 32-bit value in host byte order, a FORK_FRAME_LOG frame is followed
+//! by value bytes of log output and a FORK_FRAME_STATS frame by the stats.
+typedef enum
+{
+    FORK_FRAME_SUITE,            //!< the suite at position value has started
+    FORK_FRAME_CASE,             //!< a test case has started
+    FORK_FRAME_CASE_END,         //!< the test case has ended, value is
+                                 //!< true if it failed
+    FORK_FRAME_SUITE_END,        //!< the suite has ended, value is true if
+                                 //!< an assert has failed in the worker
+    FORK_FRAME_LOG,              //!< log output of the suite
+    FORK_FRAME_STATS             //!< stats counted since the last stats
+                                 //!< frame, value bytes follow
+} fork_frame_t;
+
+//! Length of a frame without the log output
+#define FORK_FRAME_LEN ((size_t) 5)
+
+//! A worker process of the forked runner
+typedef struct
+{
+    pid_t    pid;
+    int      fd;                 //!< read end of the pipe, -1 when done
+    size_t   next;               //!< position of the next suite to run
+    size_t   resume;             //!< index of the case to resume the next
+                                 //!< suite at after a crash, 0 to start it
+    size_t   suite;              //!< position of the suite being run
+    size_t   test_case;          //!< index of the case being run
+    bool     suite_active;
+    bool     case_active;
+    #ifdef UNIT_TEST_TIMESTAMPS
+    uint32_t suite_start;        //!< when the parent saw the suite and case
+    uint32_t case_start;         //!< start, used to time a crashed case
+    #endif
+    uint8_t *input;              //!< bytes read that are not a whole frame
+    size_t   input_len;
+    size_t   input_size;
+} fork_worker_t;
 
-//! true   if the current test case passed all assertions
-//! false  if at least one test case assertion failed
-static bool current_test_case_pass = true;
+//! State of a forked run
+typedef struct
+{
+    unit_test_case_t const * const *cases;
+    size_t                          count;
+    char const                     *filter;
+    run_suite_t                    *suites;
+    size_t                          suite_count;
+    fork_worker_t                  *workers;
+    size_t                          worker_count;
+    unit_test_sink_t const         *sink;        //!< sink of the caller
+    run_suite_t                    *current;     //!< suite logged to
+    size_t                          next_output; //!< next suite to output
+    uint32_t                        cases_run;
+    bool                            failed;
+    unit_test_stats_t               stats;       //!< stats of the workers
+} fork_run_t;
 
-//! if any asserts fail during a run, this is set to true
-static bool failed_assert = false;
+//! Write end of the pipe of a worker process, used in the worker only
+static int fork_pipe = -1;
+#endif
 
 // static function declarations
-static void log_msg(char const *);
-static void log_msg_num(char const *, uint16_t const);
-static void log_msg_str(char const *, char const *);
-static void log_assert_fail(char const *, char const *, 
-    int const, char const *);
-static void assert_failed(char const *, int, char const *);
+static void log_msg(unit_test_event_t const);
+static void log_msg_num(unit_test_event_t const, uint16_t const);
+static void log_msg_u32(unit_test_event_t const, uint32_t const);
+#ifdef UNIT_TEST_TIMESTAMPS
+static uint32_t timestamp_now(void);
+#endif
+static void log_msg_str(unit_test_event_t const, char const *);
+static void log_msg_hex(unit_test_event_t const, uint8_t const *, size_t);
+static void log_assert_fail(unit_test_file_t, int const, char const *);
+static void assert_failed(unit_test_file_t, int, char const *);
+static void assert_record(unit_test_file_t, int, char const *);
+static void log_held_back(unit_test_context_t *);
+static void stats_fold(unit_test_context_t *);
+#if defined(UNIT_TEST_PARALLEL) || defined(UNIT_TEST_FORK)
+static void stats_add(unit_test_stats_t *, unit_test_stats_t const *);
+#endif
+#ifdef UNIT_TEST_FAIL_FAST
+static void fail_fast_jump(void);
+#ifdef UNIT_TEST_REGISTRY
+static bool fail_fast_stopped(void);
+#endif
+#endif
+#ifdef UNIT_TEST_TIMER_MS
+static void timer_ms_expired(int);
+#endif
+#ifdef UNIT_TEST_PROPERTY
+static bool property_run(void (*)(void));
+static uint32_t property_shrink(void (*)(void));
+static uint32_t property_draw(uint32_t);
+static uint32_t property_xorshift(uint32_t *);
+static int32_t property_zigzag(uint32_t);
+#endif
+static void mem_assert(void const *, void const *, size_t, size_t,
+    unit_test_file_t, int);
+static uint32_t mem_diff(uint8_t const *, uint8_t const *, size_t, size_t,
+    uint32_t *);
+static size_t mem_skip(uint8_t const *, uint8_t const *, size_t);
+
+#ifdef UNIT_TEST_LOG
+static void log_write(uint8_t const *, size_t);
+static void log_output(unit_test_sink_t const *, uint8_t const *, size_t);
+#endif
+
+#if defined(UNIT_TEST_LOG) && !defined(UNIT_TEST_LOG_BINARY)
+static void log_line_write(int);
+#endif
+
+#if defined(UNIT_TEST_LOG) && defined(UNIT_TEST_LOG_RING_SIZE)
+static void log_ring_put(uint8_t const *, size_t);
+static void log_ring_drain(void);
+static void log_ring_copy_in(uint8_t const *, size_t);
+static void log_ring_copy_out(uint8_t *, size_t);
+#endif
+
+#if defined(UNIT_TEST_LOG) && defined(UNIT_TEST_LOG_ASYNC_SIZE)
+static void log_async_put(uint8_t const *, size_t);
+static void log_async_send(void);
+static void log_async_wait(void);
+#endif
+
+#if defined(UNIT_TEST_LOG) && defined(UNIT_TEST_LOG_BINARY)
+static void log_bin_header(void);
+#ifdef LOG_FILE_NAMES
+static uint16_t log_bin_file_id(char const *);
+#endif
+static void log_bin_values(char *, unit_test_event_t, unit_test_type_t,
+    void const *, void const *, size_t);
+#ifdef UNIT_TEST_COMPACT_ASSERTS
+static void log_bin_wide(char *, unit_test_type_t, bool, unit_test_uint_t,
+    unit_test_uint_t);
+#endif
+#endif
 
 #ifdef UNIT_TEST_FLOATING_POINT
+static void log_msg_float(unit_test_event_t const, float64_t const);
 static bool float64_eq(float64_t, float64_t);
+static void float_near_scan(float32_t const *, float32_t const *, size_t,
+    float32_t, float_errors_t *);
+static uint32_t float_near_worst(float32_t const *, float32_t const *,
+    size_t);
+static uint32_t float_ulps(float32_t, float32_t);
+#endif
+
+#ifdef UNIT_TEST_RESULTS
+static void results_suite_start(unit_test_context_t *);
+static void results_suite_end(unit_test_context_t *);
+static void results_case_start(unit_test_context_t *);
+static void results_case_end(unit_test_context_t *);
+static void results_assert(unit_test_file_t, int, char const *);
+static void results_write(char const *, size_t);
+static size_t results_text(char *, size_t, char const *);
+static size_t results_name(char *, size_t, char const *);
+static size_t results_u32(char *, size_t, uint32_t);
+#endif
+
+#ifdef UNIT_TEST_REPORT
+static void report_stats(unit_test_context_t *);
+static void report_failure(unit_test_file_t, int);
+static void report_values(unit_test_type_t, void const *, void const *,
+    size_t);
+#ifdef UNIT_TEST_COMPACT_ASSERTS
+static void report_wide(unit_test_type_t, bool, unit_test_uint_t,
+    unit_test_uint_t);
+#endif
+#endif
+
+#ifdef UNIT_TEST_BASELINE
+static void baseline_load(char const *);
+static void baseline_save(void);
+static void baseline_check(unit_test_context_t *, uint32_t);
+static baseline_entry_t *baseline_find(char const *);
+static bool baseline_add(char const *, size_t, uint32_t);
+#endif
+
+#ifdef UNIT_TEST_STACK
+static void stack_paint(unit_test_context_t *);
+static uint32_t stack_scan(unit_test_context_t const *);
+#endif
+
+#ifdef UNIT_TEST_ALLOC
+static void alloc_check(unit_test_context_t *);
+#endif
+
+#ifdef UNIT_TEST_ALLOC_WRAP
+static void alloc_header_set(alloc_header_t *, size_t);
+static void alloc_release(unit_test_context_t const *, uint32_t, size_t);
+#endif
+
+#ifdef UNIT_TEST_BENCH
+static void bench_sample(unit_test_bench_t *, uint32_t);
+static void bench_end(unit_test_bench_t *);
+#endif
+
+#ifdef UNIT_TEST_REGISTRY
+static size_t registry_cases(unit_test_case_t const * const **);
+static bool suite_first(unit_test_case_t const * const *, size_t,
+    char const *);
+static uint32_t suite_run(unit_test_case_t const * const *, size_t, size_t,
+    char const *, void (*)(size_t, bool));
+static uint32_t suite_cases(unit_test_case_t const * const *, size_t, size_t,
+    unit_test_suite_t const *, char const *, void (*)(size_t, bool));
+static void case_run(unit_test_case_t const *);
+#ifdef UNIT_TEST_FIXTURES
+static bool fixture_build(unit_test_fixture_t const *, bool);
+#endif
+#ifdef UNIT_TEST_PARAMS
+static void param_cases(unit_test_case_t const *);
+static bool param_run(unit_test_case_t const *, uint32_t);
+#endif
+static bool filter_match(char const *, unit_test_case_t const *);
+static bool pattern_match(char const *, size_t, char const *);
+#endif
+
+#ifdef UNIT_TEST_RERUN
+static bool rerun_start(void);
+static bool rerun_next(void);
+static bool rerun_selected(unit_test_case_t const *);
+static void rerun_update(char const *, char const *, bool);
+static unit_test_rerun_entry_t *rerun_find(uint32_t);
+static uint32_t rerun_hash(char const *, char const *);
+static uint32_t rerun_check(unit_test_rerun_record_t const *);
+#if defined(UNIT_TEST_LOG) && !defined(UNIT_TEST_LOG_NO_STDIO)
+static void rerun_load(char const *);
+static void rerun_save(void);
+#endif
+#endif
+
+#if defined(UNIT_TEST_PARALLEL) || defined(UNIT_TEST_FORK)
+static size_t run_suites_collect(run_suite_t *,
+    unit_test_case_t const * const *, size_t, char const *, uint16_t);
+static unsigned run_workers(unsigned);
+static bool run_suite_append(run_suite_t *, uint8_t const *, size_t);
+#endif
+
+#ifdef UNIT_TEST_PARALLEL
+static void *parallel_worker(void *);
+static bool parallel_next(parallel_worker_t *, size_t *);
+static bool parallel_take(parallel_queue_t *, bool, size_t *);
+static void parallel_output(parallel_run_t *, run_suite_t *);
+static void parallel_sink_write(void *, uint8_t const *, size_t);
+#endif
+
+#ifdef UNIT_TEST_FORK
+static bool fork_start(fork_run_t *, fork_worker_t *);
+static void fork_child(fork_run_t *, fork_worker_t const *);
+static void fork_inline(fork_run_t *, fork_worker_t *);
+static void fork_read(fork_run_t *, fork_worker_t *);
+static void fork_frames(fork_run_t *, fork_worker_t *);
+static void fork_exited(fork_run_t *, fork_worker_t *);
+static void fork_report(fork_run_t *, int, fork_worker_t const *);
+static void fork_done(fork_run_t *, size_t);
+static void fork_append(fork_run_t *, run_suite_t *, uint8_t const *, size_t);
+static void fork_suite_write(void *, uint8_t const *, size_t);
+static void fork_case_hook(size_t, bool);
+static void fork_frame(fork_frame_t, uint32_t, uint8_t const *, size_t);
+static void fork_stats(void);
+static void fork_pipe_write(uint8_t const *, size_t);
+static void fork_sink_write(void *, uint8_t const *, size_t);
+#endif
+
+#ifdef UNIT_TEST_COMPACT_ASSERTS
+static void assert_int_core(unit_test_type_t, bool, unit_test_uint_t,
+    unit_test_uint_t, unit_test_file_t, int);
+#if defined(UNIT_TEST_LOG) && !defined(UNIT_TEST_LOG_BINARY)
+static void int_msg_create(char *, unit_test_type_t, bool, unit_test_uint_t,
+    unit_test_uint_t);
+#endif
 #endif
 
 /**
@@ -98,757 +928,7080 @@ static bool float64_eq(float64_t, float64_t);
  */
 void test_suite_start (char const *test_suite_name)
 {
-    static uint16_t test_suite_num = 0;
+    unit_test_context_t *const context = current_context;
 
-    if (!test_suite_active)
+    if (!context->test_suite_active)
     {
         /*
          * Create a unique number for each test suite. This is to make it
          * easier to refer to the output when analyzing the results.
          */
-        log_msg_num("\n\nTest Suite Number: %d", ++test_suite_num);
-        log_msg_str("\nTest Suite Name: %s", test_suite_name);
+        context->test_suite_num++;
+        context->suite_name        = test_suite_name;
+        context->suite_logged      = false;
+        context->test_suite_active = true;
+
+        if (LOG_LEVEL(UNIT_TEST_VERBOSITY_SUITES))
+        {
+            log_held_back(context);
+        }
 
-        test_suite_active = true;
+        #ifdef UNIT_TEST_RESULTS
+        results_suite_start(context);
+        #endif
+
+        #ifdef UNIT_TEST_REPORT
+        unit_test_report.complete = 0u;
+        #endif
 
         // clear the error message buffer
-        for(uint16_t index = 0; index < sizeof(error_msg); index++)
+        for(uint16_t index = 0; index < sizeof(context->error_msg); index++)
         {
-            error_msg[index] = 0;
+            context->error_msg[index] = 0;
         }
+
+        #ifdef UNIT_TEST_TIMESTAMPS
+        context->suite_start = timestamp_now();
+        #endif
     }
     else
     {
         // A test suite is already active: Bad use of API!
-        log_msg("\n\nERROR: A test suite is already active.");
-        log_msg_str("\nCannot execute \"%s\"", test_suite_name);
-        log_msg("\nOnly one test suite can be executed at a time.\n");
+        log_msg(UNIT_TEST_EVT_SUITE_ACTIVE);
+        log_msg_str(UNIT_TEST_EVT_CANNOT_EXECUTE, test_suite_name);
+        log_msg(UNIT_TEST_EVT_SUITE_ONE_AT_A_TIME);
+    }
+}
+
+/**
+ *  Call this to indicate a test suite has completed. The framework checks to
+ *  see if a test suite is active and logs the appropriate message.
+ */
+void test_suite_end (void)
+{
+    unit_test_context_t *const context = current_context;
+
+    if (context->test_suite_active)
+    {
+        #ifdef UNIT_TEST_TIMESTAMPS
+        if (timestamp_source)
+        {
+            context->suite_ticks = timestamp_now() - context->suite_start;
+
+            if (context->suite_logged)
+            {
+                log_msg_u32(UNIT_TEST_EVT_SUITE_TICKS, context->suite_ticks);
+            }
+        }
+        #endif
+
+        // a quiet suite is only logged if one of its cases has failed
+        if (context->suite_logged)
+        {
+            log_msg(UNIT_TEST_EVT_SUITE_COMPLETE);
+        }
+
+        context->test_suite_active = false;
+        context->stats.suites++;
+
+        #ifdef UNIT_TEST_RESULTS
+        results_suite_end(context);
+        #endif
+
+        #ifdef UNIT_TEST_REPORT
+        report_stats(context);
+        #endif
+
+        #ifdef UNIT_TEST_LOG_ASYNC_SIZE
+        // hand the log buffer to the drain and go on with the next suite
+        if (context == &default_context)
+        {
+            log_async_send();
+        }
+        else
+        #endif
+        {
+            // a suite boundary is a good time to empty the log ring buffer
+            unit_test_log_flush();
+        }
+    }
+    else
+    {
+        // A test suite is not active: Bad use of API!
+        log_msg(UNIT_TEST_EVT_SUITE_NOT_ACTIVE);
+        log_msg(UNIT_TEST_EVT_SUITE_CALL_START);
+    }
+}
+
+/**
+ *  Call this to indicate the start of a new test case. If any of the asserts
+ *  fail for a test case, then the entire test case fails.
+ *
+ *  @attention - Remember to call test_case_end when you are done with a
+ *  test case.
+ *
+ *  @param test_case_name - string containing the name of the test case.
+ *  In most cases this would contain the name of the function being tested.
+ */
+void test_case_start (char const *test_case_name)
+{
+    unit_test_context_t *const context = current_context;
+
+    if (!context->test_case_active)
+    {
+        context->case_name    = test_case_name;
+        context->case_logged  = false;
+
+        // reset the flag indicating the test case result
+        context->current_test_case_pass = true;
+
+        // set the flag indicating that a test case is active
+        context->test_case_active = true;
+
+        if (LOG_LEVEL(UNIT_TEST_VERBOSITY_CASES))
+        {
+            log_held_back(context);
+        }
+
+        #ifdef UNIT_TEST_RESULTS
+        results_case_start(context);
+        #endif
+
+        #ifdef UNIT_TEST_FAIL_FAST
+        context->checkpoint_set = false;
+        #endif
+
+        #ifdef UNIT_TEST_STACK
+        stack_paint(context);
+        #endif
+
+        #ifdef UNIT_TEST_ALLOC
+        // a new case id, blocks allocated in earlier cases are not counted
+        context->alloc_case++;
+        context->alloc_count        = 0;
+        context->alloc_bytes        = 0;
+        context->alloc_live         = 0;
+        context->alloc_peak         = 0;
+        context->alloc_region_count = 0;
+        context->alloc_region_bytes = 0;
+        #endif
+
+        #ifdef UNIT_TEST_TIMESTAMPS
+        context->case_start = timestamp_now();
+        context->perf_start = context->case_start;
+        #endif
+
+        #ifdef UNIT_TEST_TIMEOUT
+        // the timeout of the next case is used up by this one
+        context->case_timeout = context->timeout_next ? context->timeout_next
+            : context->timeout;
+        context->timeout_next = 0;
+
+        if (timeout_timer && context->case_timeout)
+        {
+            context->timeout_armed = true;
+            timeout_timer(context->case_timeout);
+        }
+        #endif
+    }
+    else
+    {
+        // A test case is already active: Bad use of API!
+        log_msg(UNIT_TEST_EVT_CASE_ACTIVE);
+        log_msg_str(UNIT_TEST_EVT_CANNOT_EXECUTE, test_case_name);
+        log_msg(UNIT_TEST_EVT_CASE_ONE_AT_A_TIME);
+    }
+}
+
+/**
+ *  Call this to indicate a test case has completed. The framework checks that
+ *  a test case passed all assertions and logs the appropriate message.
+ */
+void test_case_end (void)
+{
+    unit_test_context_t *const context = current_context;
+
+    if (context->test_case_active)
+    {
+        #ifdef UNIT_TEST_TIMEOUT
+        if (timeout_timer && context->case_timeout)
+        {
+            context->timeout_armed = false;
+            timeout_timer(0);
+        }
+        #endif
+
+        #ifdef UNIT_TEST_TIMESTAMPS
+        context->case_ticks = timestamp_now() - context->case_start;
+        #endif
+
+        stats_fold(context);
+
+        #ifdef UNIT_TEST_ALLOC
+        alloc_check(context);
+        #endif
+
+        #ifdef UNIT_TEST_BASELINE
+        if (timestamp_source && context->case_name)
+        {
+            #ifdef UNIT_TEST_BENCH
+            // a benchmark is compared by its median
+            baseline_check(context, context->bench.active
+                ? context->bench.median : context->case_ticks);
+            #else
+            baseline_check(context, context->case_ticks);
+            #endif
+        }
+        #endif
+
+        context->stats.cases++;
+
+        if (context->current_test_case_pass)
+        {
+            if (LOG_LEVEL(UNIT_TEST_VERBOSITY_CASES))
+            {
+                log_msg(UNIT_TEST_EVT_CASE_PASSED);
+            }
+        }
+        else
+        {
+            context->stats.cases_failed++;
+            log_held_back(context);
+            log_msg(UNIT_TEST_EVT_CASE_FAILED);
+        }
+
+        #ifdef UNIT_TEST_TIMESTAMPS
+        if (timestamp_source && context->case_logged)
+        {
+            // on the passed/failed line
+            log_msg_u32(UNIT_TEST_EVT_CASE_TICKS, context->case_ticks);
+        }
+        #endif
+
+        #ifdef UNIT_TEST_STACK
+        if (context->stack_top)
+        {
+            context->stack_used = stack_scan(context);
+
+            if (context->case_logged)
+            {
+                log_msg_u32(UNIT_TEST_EVT_CASE_STACK, context->stack_used);
+            }
+        }
+        #endif
+
+        #ifdef UNIT_TEST_ALLOC
+        if (context->alloc_count && context->case_logged)
+        {
+            log_msg_u32(UNIT_TEST_EVT_CASE_ALLOCS, context->alloc_count);
+            log_msg_u32(UNIT_TEST_EVT_CASE_ALLOC_PEAK, context->alloc_peak);
+        }
+        #endif
+
+        #ifdef UNIT_TEST_FAIL_FAST
+        // the frame of the checkpoint may not live past the case
+        context->checkpoint_set = false;
+
+        if (!context->current_test_case_pass
+            && (++context->failed_cases == fail_fast_limit))
+        {
+            log_msg_u32(UNIT_TEST_EVT_RUN_STOPPED, context->failed_cases);
+        }
+        #endif
+
+        #ifdef UNIT_TEST_RESULTS
+        results_case_end(context);
+        #endif
+
+        #ifdef UNIT_TEST_RERUN
+        rerun_update(context->suite_name, context->case_name,
+            !context->current_test_case_pass);
+        #endif
+
+        #ifdef UNIT_TEST_REPORT
+        report_stats(context);
+        #endif
+
+        context->test_case_active = false;
+    }
+    else
+    {
+        // A test case is not active: Bad use of API!
+        log_msg(UNIT_TEST_EVT_CASE_NOT_ACTIVE);
+        log_msg(UNIT_TEST_EVT_CASE_CALL_START);
+    }
+}
+
+/**
+ * @return true if all tests have passed in a run, false otherwise.
+ */
+bool unit_test_all_success (void)
+{
+    #ifdef UNIT_TEST_REPORT
+    // the end of the run for a debugger that reads the report block
+    report_stats(current_context);
+    unit_test_report.complete = 1u;
+    #endif
+
+    return !current_context->failed_assert;
+}
+
+/**
+ * Set the log level, see "Verbosity" in unit_test.h. A level above
+ * UNIT_TEST_VERBOSITY is the same as UNIT_TEST_VERBOSITY.
+ *
+ * @param level UNIT_TEST_VERBOSITY_QUIET, _SUITES or _CASES
+ */
+void unit_test_verbosity_set (uint8_t level)
+{
+    log_verbosity = (level > UNIT_TEST_VERBOSITY) ? UNIT_TEST_VERBOSITY
+        : level;
+}
+
+/**
+ * @return the counts of suites, cases and asserts of the current context
+ */
+unit_test_stats_t unit_test_get_stats (void)
+{
+    stats_fold(current_context);
+
+    return current_context->stats;
+}
+
+/**
+ * Initialize a test context, for example for a worker thread. Call this
+ * before the context is set with unit_test_context_set.
+ *
+ * @param context the context to initialize
+ * @param sink    where the log output of the context is written, or null for
+ *                the default sink
+ */
+void unit_test_context_init (unit_test_context_t *context,
+    unit_test_sink_t const *sink)
+{
+    context->test_suite_active      = false;
+    context->test_case_active       = false;
+    context->current_test_case_pass = true;
+    context->failed_assert          = false;
+    context->test_suite_num         = 0;
+    context->suite_name             = 0;
+    context->case_name              = 0;
+    context->suite_logged           = false;
+    context->case_logged            = false;
+    context->stats.suites           = 0;
+    context->stats.cases            = 0;
+    context->stats.cases_failed     = 0;
+    context->stats.asserts          = 0;
+    context->stats.asserts_failed   = 0;
+
+    #ifdef UNIT_TEST_TIMESTAMPS
+    context->suite_start            = 0;
+    context->suite_ticks            = 0;
+    context->case_start             = 0;
+    context->case_ticks             = 0;
+    context->perf_start             = 0;
+    #endif
+
+    #ifdef UNIT_TEST_BENCH
+    context->bench.samples_len      = 0;
+    context->bench.active           = false;
+    #endif
+
+    #ifdef UNIT_TEST_RESULTS
+    context->results_cases          = 0;
+    context->results_failed         = 0;
+    context->results_asserts        = 0;
+    #endif
+
+    #ifdef UNIT_TEST_STACK
+    context->stack_limit            = 0;
+    context->stack_top              = 0;
+    context->stack_used             = 0;
+    #endif
+
+    #ifdef UNIT_TEST_FIXTURES
+    context->fixture_dirty          = false;
+    #endif
+
+    #ifdef UNIT_TEST_PARAMS
+    context->param_active           = false;
+    context->param_logged           = false;
+    context->param_index            = 0;
+    #endif
+
+    #ifdef UNIT_TEST_PROPERTY
+    context->property_seed          = UNIT_TEST_PROPERTY_SEED;
+    context->property_rng           = UNIT_TEST_PROPERTY_SEED;
+    context->property_len           = 0;
+    context->property_next          = 0;
+    context->property_replay        = false;
+    context->property_quiet         = false;
+    context->property_failed        = false;
+    #ifdef UNIT_TEST_FAIL_FAST
+    context->property_armed         = false;
+    #endif
+    #endif
+
+    #ifdef UNIT_TEST_FAIL_FAST
+    context->checkpoint_set         = false;
+    context->failed_cases           = 0;
+    #endif
+
+    #ifdef UNIT_TEST_TIMEOUT
+    context->timeout                = 0;
+    context->timeout_next           = 0;
+    context->case_timeout           = 0;
+    context->timeout_armed          = false;
+    #endif
+
+    #ifdef UNIT_TEST_ALLOC
+    context->alloc_paused           = false;
+    context->alloc_case             = 0;
+    context->alloc_count            = 0;
+    context->alloc_bytes            = 0;
+    context->alloc_live             = 0;
+    context->alloc_peak             = 0;
+    context->alloc_region_count     = 0;
+    context->alloc_region_bytes     = 0;
+    #endif
+
+    for(uint16_t index = 0; index < sizeof(context->error_msg); index++)
+    {
+        context->error_msg[index] = 0;
+    }
+
+    #ifdef UNIT_TEST_LOG
+    context->log_sink = sink ? sink : LOG_DEFAULT_SINK;
+    #else
+    (void) sink;
+    #endif
+
+    #ifdef LOG_FILE_NAMES
+    for (uint16_t index = 0; index < LOG_MAX_FILES; index++)
+    {
+        context->log_file_names[index] = 0;
+    }
+
+    context->log_file_next = 0;
+    #endif
+}
+
+/**
+ * Set the context used by the framework functions and the asserts. With
+ * UNIT_TEST_THREADS this sets the context of the calling thread.
+ *
+ * @param context the context to use, or null for the default context
+ *
+ * @return the context used before
+ */
+unit_test_context_t *unit_test_context_set (unit_test_context_t *context)
+{
+    unit_test_context_t *const previous = current_context;
+
+    // the inline asserts passed so far belong to the previous context
+    stats_fold(previous);
+    current_context = context ? context : &default_context;
+
+    return previous;
+}
+
+/**
+ * @return the context used by the framework functions and the asserts
+ */
+unit_test_context_t *unit_test_context_get (void)
+{
+    return current_context;
+}
+
+#ifdef UNIT_TEST_TIMESTAMPS
+/**
+ * Set the timestamp source used to time the test cases and suites. Set it
+ * between suites.
+ *
+ * @param source function returning a free running count, or null to stop
+ *               timing
+ */
+void unit_test_timestamp_set (unit_test_timestamp_t source)
+{
+    timestamp_source = source;
+}
+
+/**
+ * Begin a region of a test case timed by ASSERT_MAX_CYCLES/ASSERT_MAX_US.
+ */
+void perf_region_begin (void)
+{
+    current_context->perf_start = timestamp_now();
+}
+
+/**
+ *  Asserts if more ticks than the budget have gone by since the beginning of
+ *  the performance region.
+ *
+ *  @param budget     the most ticks the region can take
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_max_cycles (uint32_t budget, unit_test_file_t file, int line_num)
+{
+    uint32_t const ticks = timestamp_now() - current_context->perf_start;
+
+    ASSERT_COUNT();
+
+    if (ticks > budget)
+    {
+        // create error message with details
+        EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_TICKS,
+                " budget: %u ticks, took: %u", budget, ticks);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if more microseconds than the budget have gone by since the
+ *  beginning of the performance region.
+ *
+ *  @param budget       the most microseconds the region can take
+ *  @param ticks_per_us ticks of the timestamp source in a microsecond
+ *  @param file         the source file name
+ *  @param line_num     the source code line number
+ */
+void assert_max_us (uint32_t budget, uint32_t ticks_per_us,
+    unit_test_file_t file, int line_num)
+{
+    uint32_t const ticks = timestamp_now() - current_context->perf_start;
+    uint32_t const us    = ticks / ticks_per_us;
+
+    ASSERT_COUNT();
+
+    // whole microseconds, a part of one does not go over the budget
+    if (us > budget)
+    {
+        // create error message with details
+        EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_US,
+                " budget: %u us, took: %u", budget, us);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+#ifdef UNIT_TEST_CLOCK_US
+/**
+ * Timestamp source for hosted builds, a count of microseconds from the
+ * monotonic clock.
+ *
+ * @return the count, it wraps after about 71 minutes
+ */
+uint32_t unit_test_clock_us (void)
+{
+    struct timespec now;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t) (((uint32_t) now.tv_sec * UINT32_C(1000000))
+        + ((uint32_t) now.tv_nsec / UINT32_C(1000)));
+}
+#endif
+#endif
+
+#ifdef UNIT_TEST_BASELINE
+/**
+ * Set how test cases are compared with the baseline. Call this before the
+ * test suites are run.
+ *
+ * @param threshold percentage the ticks of a case can be above its baseline
+ * @param fail      true to fail a case that is slower than its baseline,
+ *                  false to log a warning
+ */
+void unit_test_baseline_set (uint16_t threshold, bool fail)
+{
+    baseline_threshold = threshold;
+    baseline_fail      = fail;
+}
+#endif
+
+#ifdef UNIT_TEST_STACK
+/**
+ * Set the limit of the stack of the current context, the stack used by the
+ * test cases is measured from then on.
+ *
+ * @param limit lowest address the stack can grow down to, or null to stop
+ *              measuring
+ */
+void unit_test_stack_set (void const *limit)
+{
+    current_context->stack_limit = limit;
+    current_context->stack_top   = 0;
+}
+
+/**
+ *  Asserts if the current test case has used more stack than the budget.
+ *
+ *  @param budget     the most bytes of stack the case can use
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_max_stack (uint32_t budget, unit_test_file_t file, int line_num)
+{
+    uint32_t const used = stack_scan(current_context);
+
+    ASSERT_COUNT();
+
+    if (used > budget)
+    {
+        // create error message with details
+        EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_STACK,
+                " budget: %u bytes, used: %u", budget, used);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+#endif
+
+#ifdef UNIT_TEST_ALLOC
+/**
+ * Record a heap allocation in the current test case, this is called by the
+ * allocator wrappers or by a custom allocator. Allocations made outside a
+ * test case, or by the framework, are not counted.
+ *
+ * @param size size of the allocation in bytes
+ */
+void unit_test_alloc_record (size_t size)
+{
+    unit_test_context_t *const context = current_context;
+
+    if (!context->test_case_active || context->alloc_paused)
+    {
+        return;
+    }
+
+    context->alloc_count++;
+    context->alloc_bytes += (uint32_t) size;
+    context->alloc_live  += (uint32_t) size;
+
+    if (context->alloc_live > context->alloc_peak)
+    {
+        context->alloc_peak = context->alloc_live;
+    }
+}
+
+/**
+ * Record the release of a heap allocation recorded in the current test case.
+ *
+ * @param size size of the allocation in bytes
+ */
+void unit_test_free_record (size_t size)
+{
+    unit_test_context_t *const context = current_context;
+
+    if (!context->test_case_active)
+    {
+        return;
+    }
+
+    // saturate, a block recorded before the case started is not in live
+    context->alloc_live = ((uint32_t) size < context->alloc_live)
+        ? context->alloc_live - (uint32_t) size : 0;
+}
+
+/**
+ * Start the region of the current test case measured by the heap budget
+ * asserts, this is called by ALLOC_REGION_BEGIN.
+ */
+void alloc_region_begin (void)
+{
+    current_context->alloc_region_count = current_context->alloc_count;
+    current_context->alloc_region_bytes = current_context->alloc_bytes;
+}
+
+/**
+ *  Asserts if more allocations were made since the region began than the
+ *  budget.
+ *
+ *  @param budget     the most allocations the region can make
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_max_alloc_count (uint32_t budget, unit_test_file_t file,
+    int line_num)
+{
+    uint32_t const made = current_context->alloc_count
+        - current_context->alloc_region_count;
+
+    ASSERT_COUNT();
+
+    if (made > budget)
+    {
+        // create error message with details
+        EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_ALLOCS,
+                " budget: %u allocations, made: %u", budget, made);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if more bytes were allocated since the region began than the
+ *  budget.
+ *
+ *  @param budget     the most bytes the region can allocate
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_max_alloc_bytes (uint32_t budget, unit_test_file_t file,
+    int line_num)
+{
+    uint32_t const bytes = current_context->alloc_bytes
+        - current_context->alloc_region_bytes;
+
+    ASSERT_COUNT();
+
+    if (bytes > budget)
+    {
+        // create error message with details
+        EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_HEAP,
+                " budget: %u bytes, allocated: %u", budget, bytes);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+#endif
+
+#ifdef UNIT_TEST_ALLOC_WRAP
+/**
+ * Wrapper of malloc, linked in place of it with -Wl,--wrap=malloc.
+ *
+ * @param size size of the block in bytes
+ *
+ * @return the block, or null if there is no memory
+ */
+void *__wrap_malloc (size_t size)
+{
+    alloc_header_t *header;
+
+    if (size > SIZE_MAX - sizeof(*header))
+    {
+        return 0;
+    }
+
+    header = __real_malloc(sizeof(*header) + size);
+    if (!header)
+    {
+        return 0;
+    }
+
+    alloc_header_set(header, size);
+
+    return header + 1;
+}
+
+/**
+ * Wrapper of calloc, linked in place of it with -Wl,--wrap=calloc.
+ *
+ * @param count number of elements
+ * @param size  size of an element in bytes
+ *
+ * @return the zeroed block, or null if there is no memory
+ */
+void *__wrap_calloc (size_t count, size_t size)
+{
+    alloc_header_t *header;
+
+    if (size && count > (SIZE_MAX - sizeof(*header)) / size)
+    {
+        return 0;
+    }
+
+    header = __real_calloc(1, sizeof(*header) + count * size);
+    if (!header)
+    {
+        return 0;
+    }
+
+    alloc_header_set(header, count * size);
+
+    return header + 1;
+}
+
+/**
+ * Wrapper of realloc, linked in place of it with -Wl,--wrap=realloc. The
+ * old block is released and the new block allocated in the counters.
+ *
+ * @param block the block to resize, or null to allocate one
+ * @param size  new size of the block in bytes
+ *
+ * @return the resized block, or null if there is no memory
+ */
+void *__wrap_realloc (void *block, size_t size)
+{
+    alloc_header_t            *header;
+    unit_test_context_t const *owner;
+    uint32_t                   alloc_case;
+    size_t                     old_size;
+
+    if (!block)
+    {
+        return __wrap_malloc(size);
+    }
+
+    if (size > SIZE_MAX - sizeof(*header))
+    {
+        return 0;
+    }
+
+    header     = (alloc_header_t *) block - 1;
+    owner      = header->block.owner;
+    alloc_case = header->block.alloc_case;
+    old_size   = header->block.size;
+
+    header = __real_realloc(header, sizeof(*header) + size);
+    if (!header)
+    {
+        return 0;
+    }
+
+    alloc_release(owner, alloc_case, old_size);
+    alloc_header_set(header, size);
+
+    return header + 1;
+}
+
+/**
+ * Wrapper of free, linked in place of it with -Wl,--wrap=free.
+ *
+ * @param block the block to free, or null
+ */
+void __wrap_free (void *block)
+{
+    alloc_header_t *header;
+
+    if (!block)
+    {
+        return;
+    }
+
+    header = (alloc_header_t *) block - 1;
+    alloc_release(header->block.owner, header->block.alloc_case,
+        header->block.size);
+
+    __real_free(header);
+}
+#endif
+
+#ifdef UNIT_TEST_FAIL_FAST
+/**
+ * Set the checkpoint of the current test case, this is called by
+ * TEST_CASE_CHECKPOINT. A failed assert jumps back to the checkpoint until
+ * the case ends.
+ *
+ * @return the checkpoint to set with setjmp
+ */
+jmp_buf *unit_test_checkpoint (void)
+{
+    current_context->checkpoint_set = true;
+
+    return &current_context->checkpoint;
+}
+
+/**
+ * Set the fail fast mode.
+ *
+ * @param end_case     true if a failed assert ends the test case
+ * @param max_failures number of failed test cases from now on after which
+ *                     the registry runners stop, 0 for no limit
+ */
+void unit_test_fail_fast_set (bool end_case, uint32_t max_failures)
+{
+    fail_fast_enabled = end_case;
+    fail_fast_limit   = max_failures;
+
+    // the failed cases are counted from here
+    current_context->failed_cases = 0;
+}
+#endif
+
+#ifdef UNIT_TEST_TIMEOUT
+/**
+ * Set the timer used for the timeouts of the test cases.
+ *
+ * @param timer function that starts a one-shot timer of the given length,
+ *              or stops the timer when given 0, null for no timeouts
+ */
+void unit_test_timer_set (unit_test_timer_t timer)
+{
+    timeout_timer = timer;
+}
+
+/**
+ * Set the timeout of each test case of the current context.
+ *
+ * @param timeout timeout in the units of the timer, 0 for none
+ */
+void unit_test_timeout_set (uint32_t timeout)
+{
+    current_context->timeout = timeout;
+}
+
+/**
+ * Set the timeout of the next test case started in the current context, in
+ * place of the timeout set with unit_test_timeout_set.
+ *
+ * @param timeout timeout in the units of the timer
+ */
+void test_case_timeout (uint32_t timeout)
+{
+    current_context->timeout_next = timeout;
+}
+
+/**
+ * End the current test case when its timeout has expired, this is called
+ * by the timer. The case is marked failed and the run goes on at the
+ * checkpoint of the case, this function only returns if there is none.
+ */
+void unit_test_timeout_expired (void)
+{
+    unit_test_context_t *const context = current_context;
+
+    // the timer may expire just as the case ends
+    if (!context->test_case_active || !context->timeout_armed)
+    {
+        return;
+    }
+
+    context->timeout_armed = false;
+
+    #ifdef UNIT_TEST_PROPERTY
+    // a property check that is cut short is logged again
+    context->property_quiet  = false;
+    context->property_replay = false;
+    #ifdef UNIT_TEST_FAIL_FAST
+    context->property_armed  = false;
+    #endif
+    #endif
+
+    log_held_back(context);
+    log_msg_u32(UNIT_TEST_EVT_CASE_TIMEOUT, context->case_timeout);
+
+    context->current_test_case_pass = false;
+    context->failed_assert          = true;
+
+    if (context->checkpoint_set)
+    {
+        context->checkpoint_set = false;
+        longjmp(context->checkpoint, 1);
+    }
+}
+
+#ifdef UNIT_TEST_TIMER_MS
+/**
+ * Timer for the timeouts of a hosted build, in milliseconds. SIGALRM is
+ * handled with SA_NODEFER, so it is not left blocked when the handler is
+ * left with longjmp.
+ *
+ * @param ms length of the timer, 0 to stop it
+ */
+void unit_test_timer_ms (uint32_t ms)
+{
+    static bool      installed = false;
+    struct itimerval timer;
+
+    if (!installed)
+    {
+        struct sigaction action;
+
+        action.sa_handler = timer_ms_expired;
+        action.sa_flags   = SA_NODEFER;
+        (void) sigemptyset(&action.sa_mask);
+        installed = (0 == sigaction(SIGALRM, &action, 0));
+    }
+
+    timer.it_interval.tv_sec  = 0;
+    timer.it_interval.tv_usec = 0;
+    timer.it_value.tv_sec     = (time_t) (ms / 1000u);
+    timer.it_value.tv_usec    = (suseconds_t) ((ms % 1000u) * 1000u);
+    (void) setitimer(ITIMER_REAL, &timer, 0);
+}
+#endif
+#endif
+
+#ifdef UNIT_TEST_BENCH
+/**
+ * Start a benchmark test case, this is called by BENCH_CASE. The body of the
+ * benchmark is run as long as bench_case_next returns true.
+ *
+ * @param bench_case_name string containing the name of the test case
+ * @param iterations      number of timed runs of the body
+ */
+void bench_case_start (char const *bench_case_name, uint32_t iterations)
+{
+    unit_test_bench_t *const bench = &current_context->bench;
+
+    test_case_start(bench_case_name);
+
+    bench->iterations  = iterations;
+    bench->run         = 0;
+    bench->start       = 0;
+    bench->min         = UINT32_MAX;
+    bench->median      = 0;
+    bench->max         = 0;
+    bench->mean        = 0;
+    bench->sum         = 0;
+    bench->samples_len = 0;
+    bench->active      = true;
+}
+
+/**
+ * Called by BENCH_CASE before each run of the body of a benchmark. Times the
+ * run that has finished and ends the test case after the last run.
+ *
+ * @return true if the body is to be run again
+ */
+bool bench_case_next (void)
+{
+    unit_test_bench_t *const bench = &current_context->bench;
+    uint32_t const           now   = timestamp_now();
+
+    if (bench->run > UNIT_TEST_BENCH_WARMUP)
+    {
+        bench_sample(bench, now - bench->start);
+    }
+
+    if (bench->run == (UNIT_TEST_BENCH_WARMUP + bench->iterations))
+    {
+        bench_end(bench);
+        test_case_end();
+        bench->active = false;
+
+        return false;
+    }
+
+    bench->run++;
+
+    // the bookkeeping above is not part of the timed run
+    bench->start = timestamp_now();
+
+    return true;
+}
+
+#ifndef __GNUC__
+//! Written by bench_do_not_optimize so the compiler cannot drop the object
+static void const * volatile bench_object;
+
+/**
+ * Make the compiler assume the object is used, so work done on it in a
+ * benchmark is not optimized away.
+ *
+ * @param object the object
+ */
+void bench_do_not_optimize (void const *object)
+{
+    bench_object = object;
+}
+#endif
+#endif
+
+#ifdef UNIT_TEST_REGISTRY
+/**
+ * Set the table of test cases walked by unit_test_run, this replaces the
+ * cases registered in the linker section. Pass a null table to go back to
+ * the linker section.
+ *
+ * @param cases table of pointers to the test cases
+ * @param count number of entries in the table
+ */
+void unit_test_registry_set (unit_test_case_t const * const *cases,
+    size_t count)
+{
+    registry_table = cases;
+    registry_count = cases ? count : 0;
+}
+
+/**
+ * Set the shard of the selected suites run by the runners, for example from
+ * a --shard option. With shard "i/n" every n-th selected suite is run,
+ * starting with suite i.
+ *
+ * @param shard "i/n" with 0 <= i < n, NULL or "" to run all the suites
+ *
+ * @return false if the shard is not valid, the shard is then not changed
+ */
+bool unit_test_shard_set (char const *shard)
+{
+    size_t index = 0;
+    size_t count = 0;
+
+    if (!shard || !*shard)
+    {
+        shard_index = 0;
+        shard_count = 1;
+
+        return true;
+    }
+
+    while ((*shard >= '0') && (*shard <= '9') && (index < UINT16_MAX))
+    {
+        index = (10 * index) + (size_t) (*shard++ - '0');
+    }
+
+    if ('/' != *shard++)
+    {
+        return false;
+    }
+
+    while ((*shard >= '0') && (*shard <= '9') && (count < UINT16_MAX))
+    {
+        count = (10 * count) + (size_t) (*shard++ - '0');
+    }
+
+    if (*shard || (index >= count))
+    {
+        return false;
+    }
+
+    shard_index = index;
+    shard_count = count;
+
+    return true;
+}
+
+#ifdef UNIT_TEST_RERUN
+/**
+ * Choose how the runners use the record of the failed test cases, see the
+ * description of the rerun of failed cases in unit_test.h.
+ *
+ * @param mode UNIT_TEST_RUN_ALL, UNIT_TEST_RUN_FAILED_FIRST or
+ *             UNIT_TEST_RUN_FAILED_ONLY
+ */
+void unit_test_run_mode_set (unit_test_run_mode_t mode)
+{
+    rerun_mode = mode;
+}
+
+/**
+ * Use a record of the failed test cases kept by the application, for example
+ * in RAM that is not cleared at reset. A record that is not valid is cleared.
+ * Call this before running the cases.
+ *
+ * @param record the record, null to go back to the record of the framework
+ */
+void unit_test_rerun_record_set (unit_test_rerun_record_t *record)
+{
+    rerun_record = record ? record : &rerun_default;
+
+    if ((RERUN_MAGIC != rerun_record->magic)
+        || (rerun_record->count > UNIT_TEST_RERUN_MAX_CASES)
+        || (rerun_check(rerun_record) != rerun_record->check))
+    {
+        (void) memset(rerun_record, 0, sizeof(*rerun_record));
+        rerun_record->magic = RERUN_MAGIC;
+        rerun_record->check = rerun_check(rerun_record);
+    }
+}
+#endif
+
+/**
+ * Run the registered test cases selected by a filter, see the description
+ * of the test registry in unit_test.h. Each suite is started once and its
+ * selected cases are run in registry order.
+ *
+ * @param filter comma separated list of patterns, NULL or "" for all cases
+ *
+ * @return number of test cases run
+ */
+uint32_t unit_test_run (char const *filter)
+{
+    unit_test_case_t const * const *cases;
+    size_t const count  = registry_cases(&cases);
+    size_t       suites = 0;
+    uint32_t     run    = 0;
+
+    #ifdef UNIT_TEST_RERUN
+    // run a pass for each rank of the cases in the record
+    if (rerun_start())
+    {
+        while (rerun_next())
+        {
+            run += unit_test_run(filter);
+        }
+
+        return run;
+    }
+    #endif
+
+    for (size_t first = 0; first < count; first++)
+    {
+        #ifdef UNIT_TEST_FAIL_FAST
+        if (fail_fast_stopped())
+        {
+            break;
+        }
+        #endif
+
+        if (suite_first(cases, first, filter)
+            && (shard_index == (suites++ % shard_count)))
+        {
+            run += suite_run(cases, count, first, filter, 0);
+        }
+    }
+
+    return run;
+}
+
+#ifdef UNIT_TEST_FIXTURES
+/**
+ * Mark the fixture of the suite as changed by the current test case, see
+ * "Fixtures" in unit_test.h. The fixture is built again before the next case
+ * of the suite runs.
+ */
+void unit_test_fixture_dirty (void)
+{
+    current_context->fixture_dirty = true;
+}
+#endif
+
+#ifdef UNIT_TEST_PARAMS
+/**
+ * Get the index of the parameter a parameterized test case is running with,
+ * see "Parameterized test cases" in unit_test.h.
+ *
+ * @return index of the parameter in the table of the case
+ */
+uint32_t unit_test_param_index (void)
+{
+    return current_context->param_index;
+}
+#endif
+
+#ifdef UNIT_TEST_PARALLEL
+/**
+ * Run the registered test cases selected by a filter on a pool of worker
+ * threads, see the description of the parallel runner in unit_test.h. If
+ * the pool cannot be allocated, the cases are run by unit_test_run.
+ *
+ * @param filter  comma separated list of patterns, NULL or "" for all cases
+ * @param workers number of worker threads, 0 for one per online processor
+ *
+ * @return number of test cases run
+ */
+uint32_t unit_test_run_parallel (char const *filter, unsigned workers)
+{
+    unit_test_context_t *const caller = current_context;
+    parallel_run_t run;
+    size_t        *slots;
+    size_t         slot = 0;
+    uint32_t       cases_run = 0;
+
+    #ifdef UNIT_TEST_RERUN
+    // run a pass for each rank of the cases in the record
+    if (rerun_start())
+    {
+        while (rerun_next())
+        {
+            cases_run += unit_test_run_parallel(filter, workers);
+        }
+
+        return cases_run;
+    }
+    #endif
+
+    run.count       = registry_cases(&run.cases);
+    run.filter      = filter;
+    run.next_output = 0;
+    workers         = run_workers(workers);
+
+    // a suite has at least one case, so there are no more suites than cases
+    run.suites  = calloc(run.count + 1, sizeof(*run.suites));
+    slots       = calloc(run.count + 1, sizeof(*slots));
+    run.workers = calloc(workers, sizeof(*run.workers));
+
+    if (!run.suites || !slots || !run.workers)
+    {
+        free(run.suites);
+        free(slots);
+        free(run.workers);
+
+        return unit_test_run(filter);
+    }
+
+    run.suite_count = run_suites_collect(run.suites, run.cases, run.count,
+        filter, caller->test_suite_num);
+
+    // more workers than suites would only sit idle
+    run.worker_count = (workers < run.suite_count) ? workers : run.suite_count;
+    if (0 == run.worker_count)
+    {
+        run.worker_count = 1;
+    }
+
+    // the output of the workers is written straight to the sink of the
+    // caller, anything held for it is written first
+    unit_test_log_flush();
+    #ifdef UNIT_TEST_LOG
+    run.sink = caller->log_sink;
+    #else
+    run.sink = 0;
+    #endif
+    (void) pthread_mutex_init(&run.output_lock, 0);
+
+    for (size_t index = 0; index < run.worker_count; index++)
+    {
+        parallel_worker_t *const worker = &run.workers[index];
+
+        worker->run          = &run;
+        worker->index        = index;
+        worker->sink.write   = parallel_sink_write;
+        worker->sink.flush   = 0;
+        worker->sink.context = worker;
+        unit_test_context_init(&worker->context, &worker->sink);
+
+        // the suites are dealt out in turn, so the output is mostly ready
+        // in registry order
+        worker->queue.slots = &slots[slot];
+        worker->queue.head  = 0;
+        worker->queue.tail  = 0;
+        for (size_t suite = index; suite < run.suite_count;
+            suite += run.worker_count)
+        {
+            slots[slot++] = suite;
+            worker->queue.tail++;
+        }
+        (void) pthread_mutex_init(&worker->queue.lock, 0);
+    }
+
+    // the calling thread is the first worker, if a thread cannot be created
+    // its suites are stolen by the others
+    for (size_t index = 1; index < run.worker_count; index++)
+    {
+        parallel_worker_t *const worker = &run.workers[index];
+
+        worker->started = (0 == pthread_create(&worker->thread, 0,
+            parallel_worker, worker));
+    }
+
+    (void) parallel_worker(&run.workers[0]);
+
+    for (size_t index = 0; index < run.worker_count; index++)
+    {
+        parallel_worker_t *const worker = &run.workers[index];
+
+        if (worker->started)
+        {
+            (void) pthread_join(worker->thread, 0);
+        }
+
+    }
+
+    // the queues can be stolen from until all the workers are done
+    for (size_t index = 0; index < run.worker_count; index++)
+    {
+        parallel_worker_t *const worker = &run.workers[index];
+
+        cases_run += worker->cases;
+        stats_add(&caller->stats, &worker->context.stats);
+
+        // a failure in any worker is a failure of the run
+        if (worker->context.failed_assert)
+        {
+            caller->failed_assert = true;
+        }
+
+        (void) pthread_mutex_destroy(&worker->queue.lock);
+    }
+
+    caller->test_suite_num = (uint16_t) (caller->test_suite_num
+        + run.suite_count);
+
+    #ifdef LOG_FILE_NAMES
+    // the workers have given the file ids of the log to other names
+    for (uint16_t index = 0; index < LOG_MAX_FILES; index++)
+    {
+        caller->log_file_names[index] = 0;
+    }
+    #endif
+
+    (void) pthread_mutex_destroy(&run.output_lock);
+    free(run.suites);
+    free(slots);
+    free(run.workers);
+
+    unit_test_log_flush();
+
+    return cases_run;
+}
+#endif
+
+#ifdef UNIT_TEST_FORK
+/**
+ * Run the registered test cases selected by a filter in worker processes,
+ * see the description of the forked runner in unit_test.h. If the run
+ * cannot be allocated, the cases are run by unit_test_run.
+ *
+ * @param filter  comma separated list of patterns, NULL or "" for all cases
+ * @param workers number of worker processes, 0 for one per online processor
+ *
+ * @return number of test cases run
+ */
+uint32_t unit_test_run_forked (char const *filter, unsigned workers)
+{
+    unit_test_context_t *const caller = current_context;
+    fork_run_t     run;
+    struct pollfd *polls;
+    size_t        *polled;
+
+    #ifdef UNIT_TEST_RERUN
+    // run a pass for each rank of the cases in the record
+    if (rerun_start())
+    {
+        uint32_t cases_run = 0;
+
+        while (rerun_next())
+        {
+            cases_run += unit_test_run_forked(filter, workers);
+        }
+
+        return cases_run;
+    }
+    #endif
+
+    run.count       = registry_cases(&run.cases);
+    run.filter      = filter;
+    run.current     = 0;
+    run.next_output = 0;
+    run.cases_run   = 0;
+    run.failed      = false;
+    (void) memset(&run.stats, 0, sizeof(run.stats));
+    workers         = run_workers(workers);
+
+    // a suite has at least one case, so there are no more suites than cases
+    run.suites  = calloc(run.count + 1, sizeof(*run.suites));
+    run.workers = calloc(workers, sizeof(*run.workers));
+    polls       = calloc(workers, sizeof(*polls));
+    polled      = calloc(workers, sizeof(*polled));
+
+    if (!run.suites || !run.workers || !polls || !polled)
+    {
+        free(run.suites);
+        free(run.workers);
+        free(polls);
+        free(polled);
+
+        return unit_test_run(filter);
+    }
+
+    run.suite_count = run_suites_collect(run.suites, run.cases, run.count,
+        filter, caller->test_suite_num);
+    run.worker_count = (workers < run.suite_count) ? workers : run.suite_count;
+
+    // the output of the workers is written straight to the sink of the
+    // caller, anything held for it is written first
+    unit_test_log_flush();
+    #ifdef UNIT_TEST_LOG
+    run.sink = caller->log_sink;
+    #else
+    run.sink = 0;
+    #endif
+
+    // worker k runs the suites k, k + workers, ...
+    for (size_t index = 0; index < run.worker_count; index++)
+    {
+        run.workers[index].next = index;
+
+        if (!fork_start(&run, &run.workers[index]))
+        {
+            fork_inline(&run, &run.workers[index]);
+        }
+    }
+
+    for (;;)
+    {
+        nfds_t count = 0;
+
+        for (size_t index = 0; index < run.worker_count; index++)
+        {
+            if (run.workers[index].fd >= 0)
+            {
+                polls[count].fd     = run.workers[index].fd;
+                polls[count].events = POLLIN;
+                polled[count]       = index;
+                count++;
+            }
+        }
+
+        if (0 == count)
+        {
+            break;
+        }
+
+        if (poll(polls, count, -1) < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            // without poll, read the workers in turn
+            for (nfds_t index = 0; index < count; index++)
+            {
+                polls[index].revents = POLLIN;
+            }
+        }
+
+        for (nfds_t index = 0; index < count; index++)
+        {
+            if (polls[index].revents)
+            {
+                fork_read(&run, &run.workers[polled[index]]);
+            }
+        }
+    }
+
+    if (run.failed)
+    {
+        caller->failed_assert = true;
+    }
+
+    stats_add(&caller->stats, &run.stats);
+
+    caller->test_suite_num = (uint16_t) (caller->test_suite_num
+        + run.suite_count);
+
+    #ifdef LOG_FILE_NAMES
+    // the workers have given the file ids of the log to other names
+    for (uint16_t index = 0; index < LOG_MAX_FILES; index++)
+    {
+        caller->log_file_names[index] = 0;
+    }
+    #endif
+
+    free(run.suites);
+    free(run.workers);
+    free(polls);
+    free(polled);
+
+    unit_test_log_flush();
+
+    return run.cases_run;
+}
+#endif
+#endif
+
+#ifdef UNIT_TEST_COMPACT_ASSERTS
+
+/**
+ *  Integer and bool asserts for UNIT_TEST_COMPACT_ASSERTS. Each typed assert
+ *  is a thin wrapper that passes its values widened, with the type tag, to
+ *  assert_int_core. There is a single comparison and message creation for
+ *  all the types, this saves code space on small targets.
+ */
+#define COMPACT_ASSERT(name, type, tag) \
+    void assert_##name##_eq (type expected, type actual, \
+            unit_test_file_t file, int line_num) \
+    { \
+        assert_int_core(tag, true, (unit_test_uint_t) expected, \
+            (unit_test_uint_t) actual, file, line_num); \
+    } \
+    void assert_##name##_not_eq (type expected, type actual, \
+            unit_test_file_t file, int line_num) \
+    { \
+        assert_int_core(tag, false, (unit_test_uint_t) expected, \
+            (unit_test_uint_t) actual, file, line_num); \
+    }
+
+COMPACT_ASSERT(bool,   bool,     UNIT_TEST_TYPE_BOOL)
+COMPACT_ASSERT(int8,   int8_t,   UNIT_TEST_TYPE_INT8)
+COMPACT_ASSERT(uint8,  uint8_t,  UNIT_TEST_TYPE_UINT8)
+COMPACT_ASSERT(int16,  int16_t,  UNIT_TEST_TYPE_INT16)
+COMPACT_ASSERT(uint16, uint16_t, UNIT_TEST_TYPE_UINT16)
+COMPACT_ASSERT(int32,  int32_t,  UNIT_TEST_TYPE_INT32)
+COMPACT_ASSERT(uint32, uint32_t, UNIT_TEST_TYPE_UINT32)
+
+#ifdef UNIT_TEST_INT64
+COMPACT_ASSERT(int64,  int64_t,  UNIT_TEST_TYPE_INT64)
+COMPACT_ASSERT(uint64, uint64_t, UNIT_TEST_TYPE_UINT64)
+#endif
+
+/**
+ *  Asserts if widened integer values ARE NOT equal when they should be, or
+ *  ARE equal when they should not be.
+ *
+ *  @param type       type tag of the values
+ *  @param equal      true if the values should be equal
+ *  @param expected   the expected value, widened
+ *  @param actual     the value to compare to, widened
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+static void assert_int_core (unit_test_type_t type, bool equal,
+    unit_test_uint_t expected, unit_test_uint_t actual,
+    unit_test_file_t file, int line_num)
+{
+    (void) type;
+
+    ASSERT_COUNT();
+
+    if ((expected == actual) != equal)
+    {
+        // create an error message with details
+        INT_ERR_MSG_CREATE(ERROR_MSG, type, equal, expected, actual);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+#if defined(UNIT_TEST_LOG) && !defined(UNIT_TEST_LOG_BINARY)
+
+/**
+ *  Create the failure message of a compact integer assert. The values are
+ *  narrowed back according to the type, a "not equal" format only has one
+ *  value and the second argument is ignored by snprintf.
+ *
+ *  @param msg        buffer for the message
+ *  @param type       type tag of the values
+ *  @param equal      true if the values should have been equal
+ *  @param expected   the expected value, widened
+ *  @param actual     the value compared to, widened
+ */
+//lint -e{592} non-literal format specifier
+static void int_msg_create (char *msg, unit_test_type_t type, bool equal,
+    unit_test_uint_t expected, unit_test_uint_t actual)
+{
+    type_desc_t const *desc   = &type_descs[type];
+    char const        *format = equal ? desc->eq_format : desc->not_eq_format;
+
+    #ifdef UNIT_TEST_INT64
+    if ((8 == desc->width) && (UNIT_TEST_KIND_SIGNED == desc->kind))
+    {
+        (void) snprintf(msg, MAX_MSG_LEN, format,
+            (long long) (int64_t) expected, (long long) (int64_t) actual);
+    }
+    else if (8 == desc->width)
+    {
+        (void) snprintf(msg, MAX_MSG_LEN, format,
+            (unsigned long long) expected, (unsigned long long) actual);
+    }
+    else
+    #endif
+    if (UNIT_TEST_KIND_SIGNED == desc->kind)
+    {
+        (void) snprintf(msg, MAX_MSG_LEN, format,
+            (int) (int32_t) expected, (int) (int32_t) actual);
+    }
+    else
+    {
+        (void) snprintf(msg, MAX_MSG_LEN, format,
+            (unsigned) expected, (unsigned) actual);
+    }
+}
+
+#endif
+
+#else // UNIT_TEST_COMPACT_ASSERTS
+
+/**
+ *  Asserts if the bool values ARE NOT equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_bool_eq (bool expected, bool actual,
+        unit_test_file_t file, int line_num)
+{
+    ASSERT_COUNT();
+
+    if (expected != actual)
+    {
+        // create an error message with details
+        EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_BOOL,
+                " expected: %u, got: %u", expected, actual);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if the bool values ARE equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_bool_not_eq (bool expected, bool actual,
+        unit_test_file_t file, int line_num)
+{
+    ASSERT_COUNT();
+
+    if (expected == actual)
+    {
+        // create an error message with details
+        NOT_EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_BOOL,
+                " should not be: %u", expected);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if the int8_t ARE NOT equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ *
+ */
+void assert_int8_eq (int8_t expected, int8_t actual,
+        unit_test_file_t file, int line_num)
+{
+    ASSERT_COUNT();
+
+    if (expected != actual)
+    {
+        // create an error message with details
+        EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_INT8,
+                " expected: %d, got: %d", expected, actual);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if the int8_t ARE equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_int8_not_eq (int8_t expected, int8_t actual,
+        unit_test_file_t file, int line_num)
+{
+    ASSERT_COUNT();
+
+    if (expected == actual)
+    {
+        // create an error message with details
+        NOT_EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_INT8,
+                " should not be: %d", expected);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if the uint8_t ARE NOT equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_uint8_eq (uint8_t expected, uint8_t actual,
+        unit_test_file_t file, int line_num)
+{
+    ASSERT_COUNT();
+
+    if (expected != actual)
+    {
+        // create an error message with details
+        EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_UINT8,
+                " expected: %u, got: %u", expected, actual);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if the uint8_t ARE equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_uint8_not_eq (uint8_t expected, uint8_t actual,
+        unit_test_file_t file, int line_num)
+{
+    ASSERT_COUNT();
+
+    if (expected == actual)
+    {
+        // create an error message with details
+        NOT_EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_UINT8,
+                " should not be: %u", expected);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if the int16_t ARE NOT equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_int16_eq (int16_t expected, int16_t actual,
+        unit_test_file_t file, int line_num)
+{
+    ASSERT_COUNT();
+
+    if (expected != actual)
+    {
+        // create an error message with details
+        EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_INT16,
+                " expected: %d, got: %d", expected, actual);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if the int16_t ARE equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_int16_not_eq (int16_t expected, int16_t actual,
+        unit_test_file_t file, int line_num)
+{
+    ASSERT_COUNT();
+
+    if (expected == actual)
+    {
+        // create an error message with details
+        NOT_EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_INT16,
+                " should not be: %d", expected);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if the uint16_t ARE NOT equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_uint16_eq (uint16_t expected, uint16_t actual,
+        unit_test_file_t file, int line_num)
+{
+    ASSERT_COUNT();
+
+    if (expected != actual)
+    {
+        // create an error message with details
+        EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_UINT16,
+                " expected: %u, got: %u", expected, actual);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if the uint16_t ARE equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_uint16_not_eq (uint16_t expected, uint16_t actual,
+        unit_test_file_t file, int line_num)
+{
+    ASSERT_COUNT();
+
+    if (expected == actual)
+    {
+        // create an error message with details
+        NOT_EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_UINT16,
+                " should not be: %u", expected);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if the int32_t ARE NOT equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ *
+ */
+void assert_int32_eq (int32_t expected, int32_t actual,
+        unit_test_file_t file, int line_num)
+{
+    ASSERT_COUNT();
+
+    if (expected != actual)
+    {
+        // create error message with details
+        EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_INT32,
+                " expected: %d, got: %d", expected, actual);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if the int32_t ARE equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ *
+ */
+void assert_int32_not_eq (int32_t expected, int32_t actual,
+        unit_test_file_t file, int line_num)
+{
+    ASSERT_COUNT();
+
+    if (expected == actual)
+    {
+        // create an error message with details
+        NOT_EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_INT32,
+                " should not be: %d", expected);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if the uint32_t ARE NOT equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_uint32_eq (uint32_t expected, uint32_t actual,
+        unit_test_file_t file, int line_num)
+{
+    ASSERT_COUNT();
+
+    if (expected != actual)
+    {
+        // create error message with details
+        EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_UINT32,
+                " expected: %u, got: %u", expected, actual);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if the uint32_t ARE equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_uint32_not_eq (uint32_t expected, uint32_t actual,
+        unit_test_file_t file, int line_num)
+{
+    ASSERT_COUNT();
+
+    if (expected == actual)
+    {
+        // create an error message with details
+        NOT_EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_UINT32,
+                " should not be: %u", expected);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+#ifdef UNIT_TEST_INT64
+
+/**
+ *  Asserts if the int64_t ARE NOT equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_int64_eq (int64_t expected, int64_t actual,
+        unit_test_file_t file, int line_num)
+{
+    ASSERT_COUNT();
+
+    if (expected != actual)
+    {
+        // create error message with details
+        EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_INT64,
+                " expected: %lld, got: %lld", expected, actual);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if the int64_t ARE equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_int64_not_eq (int64_t expected, int64_t actual,
+        unit_test_file_t file, int line_num)
+{
+    ASSERT_COUNT();
+
+    if (expected == actual)
+    {
+        // create an error message with details
+        NOT_EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_INT64,
+                " should not be: %lld", expected);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if the uint64_t ARE NOT equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_uint64_eq (uint64_t expected, uint64_t actual,
+        unit_test_file_t file, int line_num)
+{
+    ASSERT_COUNT();
+
+    if (expected != actual)
+    {
+        // create error message with details
+        EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_UINT64,
+                " expected: %llu, got: %llu", expected, actual);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if the uint64_t ARE equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_uint64_not_eq (uint64_t expected, uint64_t actual,
+        unit_test_file_t file, int line_num)
+{
+    ASSERT_COUNT();
+
+    if (expected == actual)
+    {
+        // create an error message with details
+        NOT_EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_UINT64,
+                " should not be: %llu", expected);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+#endif
+
+#endif // UNIT_TEST_COMPACT_ASSERTS
+
+/**
+ *  Asserts if the bytes of two buffers ARE NOT equal.
+ *
+ *  @param expected   the expected bytes
+ *  @param actual     the bytes to compare to
+ *  @param len        number of bytes
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_mem_eq (void const *expected, void const *actual, size_t len,
+        unit_test_file_t file, int line_num)
+{
+    mem_assert(expected, actual, len, 1, file, line_num);
+}
+
+/**
+ *  Asserts if the elements of two uint16_t arrays ARE NOT equal.
+ *
+ *  @param expected   the expected elements
+ *  @param actual     the elements to compare to
+ *  @param count      number of elements
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_uint16_array_eq (uint16_t const *expected,
+        uint16_t const *actual, size_t count, unit_test_file_t file,
+        int line_num)
+{
+    mem_assert(expected, actual, count, sizeof(*expected), file, line_num);
+}
+
+/**
+ *  Asserts if the elements of two uint32_t arrays ARE NOT equal.
+ *
+ *  @param expected   the expected elements
+ *  @param actual     the elements to compare to
+ *  @param count      number of elements
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_uint32_array_eq (uint32_t const *expected,
+        uint32_t const *actual, size_t count, unit_test_file_t file,
+        int line_num)
+{
+    mem_assert(expected, actual, count, sizeof(*expected), file, line_num);
+}
+
+#ifdef UNIT_TEST_FLOATING_POINT
+
+/**
+ *  Asserts if the float32_t ARE NOT equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_float32_eq (float32_t expected, float32_t actual,
+        unit_test_file_t file, int line_num)
+{
+    assert_float64_eq((float64_t) expected, (float64_t) actual,
+            file, line_num);
+}
+
+/**
+ *  Asserts if the float32_t ARE equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_float32_not_eq (float32_t expected, float32_t actual,
+        unit_test_file_t file, int line_num)
+{
+    assert_float64_not_eq((float64_t) expected, (float64_t) actual,
+            file, line_num);
+}
+
+/**
+ *  Asserts if the float64_t ARE NOT equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_float64_eq (float64_t expected, float64_t actual,
+        unit_test_file_t file, int line_num)
+{
+    bool equal = float64_eq(expected, actual);
+
+    ASSERT_COUNT();
+
+    if (!equal)
+    {
+        // create an error message with details
+        EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_FLOAT64,
+                " expected: %e, got: %e", expected, actual);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if the float64_t ARE equal.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_float64_not_eq (float64_t expected, float64_t actual,
+        unit_test_file_t file, int line_num)
+{
+    bool equal = float64_eq(expected, actual);
+
+    ASSERT_COUNT();
+
+    if (equal)
+    {
+        // create an error message with details
+        NOT_EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_FLOAT64,
+                " should not be: %e", expected);
+
+        assert_failed(file, line_num, ERROR_MSG);
+    }
+}
+
+/**
+ *  Asserts if any element of a float32_t array differs from the expected
+ *  element by more than the tolerance.
+ *
+ *  @param expected   the expected elements
+ *  @param actual     the elements to compare to
+ *  @param count      number of elements
+ *  @param tol        the largest absolute error allowed
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_float32_array_near (float32_t const *expected,
+        float32_t const *actual, size_t count, float32_t tol,
+        unit_test_file_t file, int line_num)
+{
+    float_errors_t errors;
+
+    ASSERT_COUNT();
+
+    float_near_scan(expected, actual, count, tol, &errors);
+
+    if (errors.out)
+    {
+        #if defined(UNIT_TEST_LOG) || defined(UNIT_TEST_REPORT)
+        uint32_t const total = (uint32_t) count;
+        #endif
+        uint32_t const worst = float_near_worst(expected, actual, count);
+
+        // create an error message with details
+        EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_NEAR,
+                " %u of %u elements out of tolerance", errors.out, total);
+
+        assert_record(file, line_num, ERROR_MSG);
+
+        log_msg_u32(UNIT_TEST_EVT_FLOAT_WORST, worst);
+        log_msg_float(UNIT_TEST_EVT_FLOAT_EXPECTED, expected[worst]);
+        log_msg_float(UNIT_TEST_EVT_FLOAT_ACTUAL,   actual[worst]);
+        log_msg_float(UNIT_TEST_EVT_FLOAT_MAX_ERROR, errors.max);
+        log_msg_float(UNIT_TEST_EVT_FLOAT_MEAN_ERROR,
+            errors.sum / (float64_t) count);
+
+        #ifdef UNIT_TEST_FAIL_FAST
+        fail_fast_jump();
+        #endif
+    }
+}
+
+/**
+ *  Asserts if any element of a float32_t array is more than the given number
+ *  of representable floats (units in the last place) away from the expected
+ *  element.
+ *
+ *  @param expected   the expected elements
+ *  @param actual     the elements to compare to
+ *  @param count      number of elements
+ *  @param ulps       the largest error allowed, in units in the last place
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+void assert_float32_array_ulps (float32_t const *expected,
+        float32_t const *actual, size_t count, uint32_t ulps,
+        unit_test_file_t file, int line_num)
+{
+    uint32_t  out   = 0;
+    uint32_t  max   = 0;
+    uint32_t  worst = 0;
+    float64_t sum   = 0.0;
+
+    ASSERT_COUNT();
+
+    for (size_t index = 0; index < count; index++)
+    {
+        uint32_t const error = float_ulps(expected[index], actual[index]);
+
+        out += (error > ulps) ? 1u : 0u;
+        sum += (float64_t) error;
+
+        if (error > max)
+        {
+            max   = error;
+            worst = (uint32_t) index;
+        }
+    }
+
+    if (out)
+    {
+        #if defined(UNIT_TEST_LOG) || defined(UNIT_TEST_REPORT)
+        uint32_t const total = (uint32_t) count;
+        #endif
+
+        // create an error message with details
+        EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_NEAR,
+                " %u of %u elements out of tolerance", out, total);
+
+        assert_record(file, line_num, ERROR_MSG);
+
+        log_msg_u32(UNIT_TEST_EVT_FLOAT_WORST, worst);
+        log_msg_float(UNIT_TEST_EVT_FLOAT_EXPECTED, expected[worst]);
+        log_msg_float(UNIT_TEST_EVT_FLOAT_ACTUAL,   actual[worst]);
+        log_msg_u32(UNIT_TEST_EVT_FLOAT_MAX_ULPS, max);
+        log_msg_float(UNIT_TEST_EVT_FLOAT_MEAN_ULPS, sum / (float64_t) count);
+
+        #ifdef UNIT_TEST_FAIL_FAST
+        fail_fast_jump();
+        #endif
+    }
+}
+
+/**
+ *  Compare 2 floating point numbers for equality.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ * 
+ *  @return true if the values are equal, false otherwise
+ */
+//lint -e{777} allow explicit comparison to 0
+static bool float64_eq (float64_t expected, float64_t actual)
+{
+    float64_t relative_error;
+    bool equal = false;
+
+    // do explicit checks for zero to avoid any divide-by-zero issues
+    if ((float64_t) 0.0 == expected)
+    {
+        equal = (fabs(actual) < MAX_FLOAT_ABSOLUTE_ERROR)
+                ? true : false;
+    }
+    else if ((float64_t) 0.0 == actual)
+    {
+        equal = (fabs(expected) < MAX_FLOAT_ABSOLUTE_ERROR)
+                ? true : false;
+    }
+    else if (fabs(expected - actual) < MAX_FLOAT_ABSOLUTE_ERROR)
+    {
+        // see if they are close enough in absolute terms
+        equal = true;
+    }
+    else
+    {
+        // see if they are close enough in relative terms,
+        if (fabs(expected) > fabs(actual))
+        {
+            relative_error = fabs((expected - actual) / expected);
+        }
+        else
+        {
+            relative_error = fabs((actual - expected) / actual);
+        }
+
+        if (relative_error < MAX_FLOAT_RELATIVE_ERROR)
+        {
+            equal = true;
+        }
+    }
+
+    return equal;
+}
+
+/**
+ *  Compare 2 float32_t arrays against an absolute tolerance, 4 elements at
+ *  a time where SSE or NEON is available. Equal elements have no error, so
+ *  equal infinities pass, and a NaN is always out of tolerance. The max
+ *  error leaves out NaNs, the sum includes them.
+ *
+ *  @param[in]  expected  the expected elements
+ *  @param[in]  actual    the elements to compare to
+ *  @param[in]  count     number of elements
+ *  @param[in]  tol       the largest absolute error allowed
+ *  @param[out] errors    the errors over the array
+ */
+//lint -e{777} allow explicit comparison of floats
+static void float_near_scan (float32_t const *expected,
+    float32_t const *actual, size_t count, float32_t tol,
+    float_errors_t *errors)
+{
+    size_t    index = 0;
+    uint32_t  out   = 0;
+    float32_t max   = 0.0f;
+    float64_t sum   = 0.0;
+
+    #if defined(__SSE2__)
+    __m128 const  sign   = _mm_set1_ps(-0.0f);
+    __m128 const  tols   = _mm_set1_ps(tol);
+    __m128        maxs   = _mm_setzero_ps();
+    __m128        sums   = _mm_setzero_ps();
+    __m128i       outs   = _mm_setzero_si128();
+    float32_t     lanes[4];
+    uint32_t      counts[4];
+
+    for ( ; (count - index) >= 4; index += 4)
+    {
+        __m128 const e_vec = _mm_loadu_ps(&expected[index]);
+        __m128 const a_vec = _mm_loadu_ps(&actual[index]);
+        __m128 const error = _mm_andnot_ps(_mm_cmpeq_ps(e_vec, a_vec),
+            _mm_andnot_ps(sign, _mm_sub_ps(e_vec, a_vec)));
+
+        // the mask of an element out of tolerance is -1, NaN is never <= tol
+        outs = _mm_sub_epi32(outs,
+            _mm_castps_si128(_mm_cmpnle_ps(error, tols)));
+        maxs = _mm_max_ps(error, maxs);
+        sums = _mm_add_ps(sums, error);
+    }
+
+    _mm_storeu_ps(lanes, maxs);
+    _mm_storeu_si128((__m128i *) counts, outs);
+
+    for (uint8_t lane = 0; lane < 4; lane++)
+    {
+        out += counts[lane];
+        max  = (lanes[lane] > max) ? lanes[lane] : max;
+    }
+
+    _mm_storeu_ps(lanes, sums);
+    sum = (float64_t) lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    #elif defined(__ARM_NEON) && defined(__aarch64__)
+    float32x4_t const tols = vdupq_n_f32(tol);
+    float32x4_t       maxs = vdupq_n_f32(0.0f);
+    float32x4_t       sums = vdupq_n_f32(0.0f);
+    uint32x4_t        outs = vdupq_n_u32(0);
+
+    for ( ; (count - index) >= 4; index += 4)
+    {
+        float32x4_t const e_vec = vld1q_f32(&expected[index]);
+        float32x4_t const a_vec = vld1q_f32(&actual[index]);
+        float32x4_t const error = vreinterpretq_f32_u32(vbicq_u32(
+            vreinterpretq_u32_f32(vabdq_f32(e_vec, a_vec)),
+            vceqq_f32(e_vec, a_vec)));
+
+        // NaN is never <= tol, count the elements that are not in tolerance
+        outs = vaddq_u32(outs,
+            vshrq_n_u32(vmvnq_u32(vcleq_f32(error, tols)), 31));
+        maxs = vmaxnmq_f32(maxs, error);
+        sums = vaddq_f32(sums, error);
+    }
+
+    out = vaddvq_u32(outs);
+    max = vmaxvq_f32(maxs);
+    sum = (float64_t) vaddvq_f32(sums);
+    #endif
+
+    for ( ; index < count; index++)
+    {
+        float32_t const error = (expected[index] == actual[index])
+            ? 0.0f : fabsf(expected[index] - actual[index]);
+
+        out += (error <= tol) ? 0u : 1u;
+        max  = (error > max) ? error : max;
+        sum += (float64_t) error;
+    }
+
+    errors->out = out;
+    errors->max = max;
+    errors->sum = sum;
+}
+
+/**
+ *  Find the element of 2 float32_t arrays with the largest absolute error,
+ *  or the first NaN. This is only called when the arrays are out of
+ *  tolerance, so it is not vectorized.
+ *
+ *  @param expected   the expected elements
+ *  @param actual     the elements to compare to
+ *  @param count      number of elements
+ *
+ *  @return the index of the element
+ */
+//lint -e{777} allow explicit comparison of floats
+static uint32_t float_near_worst (float32_t const *expected,
+    float32_t const *actual, size_t count)
+{
+    uint32_t  worst = 0;
+    float32_t max   = 0.0f;
+
+    for (size_t index = 0; index < count; index++)
+    {
+        float32_t const error = (expected[index] == actual[index])
+            ? 0.0f : fabsf(expected[index] - actual[index]);
+
+        if (error != error)
+        {
+            return (uint32_t) index;
+        }
+
+        if (error > max)
+        {
+            max   = error;
+            worst = (uint32_t) index;
+        }
+    }
+
+    return worst;
+}
+
+/**
+ *  Count the representable floats between 2 float32_t values. The bits of
+ *  a float are mapped to an unsigned key that is ordered like the floats,
+ *  so the distance is the difference of the keys. +0 and -0 have the same
+ *  key, a NaN is as far as can be from any value.
+ *
+ *  @param expected   the expected value
+ *  @param actual     the value to compare to
+ *
+ *  @return the distance in units in the last place
+ */
+//lint -e{777} allow explicit comparison of floats
+static uint32_t float_ulps (float32_t expected, float32_t actual)
+{
+    uint32_t e_key;
+    uint32_t a_key;
+
+    if (expected == actual)
+    {
+        return 0;
+    }
+
+    if ((expected != expected) || (actual != actual))
+    {
+        return UINT32_MAX;
+    }
+
+    (void) memcpy(&e_key, &expected, sizeof(e_key));
+    (void) memcpy(&a_key, &actual,   sizeof(a_key));
+
+    e_key = (e_key & 0x80000000u) ? 0x80000000u - (e_key & 0x7FFFFFFFu)
+        : e_key + 0x80000000u;
+    a_key = (a_key & 0x80000000u) ? 0x80000000u - (a_key & 0x7FFFFFFFu)
+        : a_key + 0x80000000u;
+
+    return (e_key > a_key) ? e_key - a_key : a_key - e_key;
+}
+
+#endif // UNIT_TEST_FLOATING_POINT
+
+#ifdef UNIT_TEST_PROPERTY
+/**
+ * Check a property with generated inputs, see "Property tests" in
+ * unit_test.h. The runs are not logged. The input of a failing run is
+ * shrunk and the property is run once more with it, that run is logged
+ * after the seed of the check.
+ *
+ * @param property   the property, it takes its inputs from the generators
+ * @param iterations number of runs with new inputs
+ *
+ * @return true if the property held for every run
+ */
+bool unit_test_property_check (void (*property)(void), uint32_t iterations)
+{
+    unit_test_context_t *const context = current_context;
+    uint32_t const             seed    = context->property_seed;
+    uint32_t                   start   = seed;
+    uint32_t                   steps   = 0;
+    uint32_t                   run;
+    unit_test_stats_t          stats;
+    bool                       failed  = false;
+
+    // the next check goes on with other inputs
+    (void) property_xorshift(&context->property_seed);
+
+    // the runs leave the stats as they were
+    stats_fold(context);
+    stats = context->stats;
+
+    context->property_rng    = seed;
+    context->property_replay = false;
+    context->property_quiet  = true;
+
+    for (run = 0; (run < iterations) && !failed; run++)
+    {
+        start  = context->property_rng;
+        failed = property_run(property);
+    }
+
+    // every value the run generated must have been recorded to shrink them
+    if (failed && (context->property_next <= PROPERTY_MAX_DRAWS))
+    {
+        context->property_len    = (uint16_t) context->property_next;
+        context->property_replay = true;
+        steps = property_shrink(property);
+    }
+
+    stats_fold(context);
+    context->stats          = stats;
+    context->property_quiet = false;
+
+    if (failed)
+    {
+        log_held_back(context);
+        log_msg_u32(UNIT_TEST_EVT_PROPERTY_SEED,      seed);
+        log_msg_u32(UNIT_TEST_EVT_PROPERTY_ITERATION, run);
+        log_msg_u32(UNIT_TEST_EVT_PROPERTY_SHRINKS,   steps);
+
+        // without the recorded values the failing run is generated again
+        context->property_rng = start;
+
+        if (!property_run(property))
+        {
+            // the property does not only depend on its inputs
+            context->current_test_case_pass = false;
+            context->failed_assert          = true;
+        }
+    }
+
+    context->property_replay = false;
+
+    return !failed;
+}
+
+/**
+ * Set the seed of the next property checks of the current context. Pass
+ * the seed logged with a failure to replay it.
+ *
+ * @param seed the seed, 0 for the default seed
+ */
+void unit_test_property_seed (uint32_t seed)
+{
+    current_context->property_seed = seed ? seed : UNIT_TEST_PROPERTY_SEED;
+}
+
+/**
+ * @return a generated bool, shrinks to false
+ */
+bool unit_test_gen_bool (void)
+{
+    return 0u != property_draw(1u);
+}
+
+/**
+ * @return a generated int8_t, shrinks towards 0
+ */
+int8_t unit_test_gen_int8 (void)
+{
+    return (int8_t) property_zigzag(property_draw(UINT8_MAX));
+}
+
+/**
+ * @return a generated uint8_t, shrinks towards 0
+ */
+uint8_t unit_test_gen_uint8 (void)
+{
+    return (uint8_t) property_draw(UINT8_MAX);
+}
+
+/**
+ * @return a generated int16_t, shrinks towards 0
+ */
+int16_t unit_test_gen_int16 (void)
+{
+    return (int16_t) property_zigzag(property_draw(UINT16_MAX));
+}
+
+/**
+ * @return a generated uint16_t, shrinks towards 0
+ */
+uint16_t unit_test_gen_uint16 (void)
+{
+    return (uint16_t) property_draw(UINT16_MAX);
+}
+
+/**
+ * @return a generated int32_t, shrinks towards 0
+ */
+int32_t unit_test_gen_int32 (void)
+{
+    return property_zigzag(property_draw(UINT32_MAX));
+}
+
+/**
+ * @return a generated uint32_t, shrinks towards 0
+ */
+uint32_t unit_test_gen_uint32 (void)
+{
+    return property_draw(UINT32_MAX);
+}
+
+/**
+ * @param low  lowest value
+ * @param high highest value, not below low
+ *
+ * @return a generated int32_t from low to high, shrinks towards low
+ */
+int32_t unit_test_gen_int32_range (int32_t low, int32_t high)
+{
+    return (int32_t) ((uint32_t) low
+        + property_draw((uint32_t) high - (uint32_t) low));
+}
+
+/**
+ * @param low  lowest value
+ * @param high highest value, not below low
+ *
+ * @return a generated uint32_t from low to high, shrinks towards low
+ */
+uint32_t unit_test_gen_uint32_range (uint32_t low, uint32_t high)
+{
+    return low + property_draw(high - low);
+}
+
+#ifdef UNIT_TEST_INT64
+/**
+ * @return a generated int64_t, shrinks towards 0
+ */
+int64_t unit_test_gen_int64 (void)
+{
+    uint64_t const raw = unit_test_gen_uint64();
+
+    return (int64_t) (raw >> 1) ^ -(int64_t) (raw & 1u);
+}
+
+/**
+ * @return a generated uint64_t, shrinks towards 0
+ */
+uint64_t unit_test_gen_uint64 (void)
+{
+    // the high half is drawn first so it shrinks first
+    uint64_t const high = property_draw(UINT32_MAX);
+
+    return (high << 32) | property_draw(UINT32_MAX);
+}
+#endif
+
+#ifdef UNIT_TEST_FLOATING_POINT
+/**
+ * @return a generated finite float32_t, shrinks towards 0.0
+ */
+float32_t unit_test_gen_float32 (void)
+{
+    uint32_t const raw  = property_draw(UINT32_MAX);
+    uint32_t       bits = raw >> 1;
+    float32_t      value;
+
+    // the lowest bit is the sign, an infinity or NaN is made finite
+    if (0x7F800000u == (bits & 0x7F800000u))
+    {
+        bits ^= 0x40000000u;
+    }
+
+    bits |= raw << 31;
+    (void) memcpy(&value, &bits, sizeof(value));
+
+    return value;
+}
+
+/**
+ * @return a generated finite float64_t, shrinks towards 0.0
+ */
+float64_t unit_test_gen_float64 (void)
+{
+    uint64_t const high = property_draw(UINT32_MAX);
+    uint64_t const raw  = (high << 32) | property_draw(UINT32_MAX);
+    uint64_t       bits = raw >> 1;
+    float64_t      value;
+
+    // the lowest bit is the sign, an infinity or NaN is made finite
+    if (0x7FF0000000000000u == (bits & 0x7FF0000000000000u))
+    {
+        bits ^= 0x4000000000000000u;
+    }
+
+    bits |= raw << 63;
+    (void) memcpy(&value, &bits, sizeof(value));
+
+    return value;
+}
+
+/**
+ * @param low  lowest value
+ * @param high end of the range, above low
+ *
+ * @return a generated float64_t from low up to high, shrinks towards low
+ */
+float64_t unit_test_gen_float64_range (float64_t low, float64_t high)
+{
+    return low + ((high - low)
+        * ((float64_t) property_draw(UINT32_MAX) / 4294967296.0));
+}
+#endif
+#endif // UNIT_TEST_PROPERTY
+
+/**
+ *  Report a failed integer or bool assert, this is the out-of-line failure
+ *  path of the inline asserts (UNIT_TEST_INLINE_ASSERTS). The values are
+ *  passed to the assert function of their type, or straight to the integer
+ *  core with UNIT_TEST_COMPACT_ASSERTS, which creates the message and fails
+ *  the assert.
+ *
+ *  @param type       type tag of the values
+ *  @param equal      true if the values were expected to be equal
+ *  @param expected   the expected value, widened
+ *  @param actual     the value compared to, widened
+ *  @param file       the source file name
+ *  @param line_num   the source code line number
+ */
+#define VALUE_FAILED(name, type) \
+    (equal ? assert_##name##_eq((type) expected, (type) actual, \
+                 file, line_num) \
+           : assert_##name##_not_eq((type) expected, (type) actual, \
+                 file, line_num))
+
+void assert_value_failed (unit_test_type_t type, bool equal,
+    unit_test_uint_t expected, unit_test_uint_t actual,
+    unit_test_file_t file, int line_num)
+{
+    #ifdef UNIT_TEST_COMPACT_ASSERTS
+    assert_int_core(type, equal, expected, actual, file, line_num);
+    #else
+    switch (type)
+    {
+        case UNIT_TEST_TYPE_BOOL:   VALUE_FAILED(bool,   bool);     break;
+        case UNIT_TEST_TYPE_INT8:   VALUE_FAILED(int8,   int8_t);   break;
+        case UNIT_TEST_TYPE_UINT8:  VALUE_FAILED(uint8,  uint8_t);  break;
+        case UNIT_TEST_TYPE_INT16:  VALUE_FAILED(int16,  int16_t);  break;
+        case UNIT_TEST_TYPE_UINT16: VALUE_FAILED(uint16, uint16_t); break;
+        case UNIT_TEST_TYPE_INT32:  VALUE_FAILED(int32,  int32_t);  break;
+        case UNIT_TEST_TYPE_UINT32: VALUE_FAILED(uint32, uint32_t); break;
+        #ifdef UNIT_TEST_INT64
+        case UNIT_TEST_TYPE_INT64:  VALUE_FAILED(int64,  int64_t);  break;
+        case UNIT_TEST_TYPE_UINT64: VALUE_FAILED(uint64, uint64_t); break;
+        #endif
+        default: break;
+    }
+    #endif
+}
+
+/**
+ *  Open the unit test log file. This function should be called prior to
+ *  any test suites being called.
+ *
+ *  @param  file_name name of the file to open or null if no file is desired
+ */
+void unit_test_log_on (char const *file_name)
+{
+    #ifdef UNIT_TEST_LOG
+    if (file_name)
+    {
+        #ifndef UNIT_TEST_LOG_NO_STDIO
+        #ifdef UNIT_TEST_LOG_BINARY
+        log_file = fopen(file_name, "wb");
+        #else
+        log_file = fopen(file_name, "w");
+        #endif
+        #endif
+
+        #ifdef UNIT_TEST_BASELINE
+        baseline_load(file_name);
+        #endif
+
+        #if defined(UNIT_TEST_RERUN) && !defined(UNIT_TEST_LOG_NO_STDIO)
+        rerun_load(file_name);
+        #endif
+        
+        // track whether there are any failed asserts during the run
+        current_context->failed_assert = false;
+    }
+
+    log_enabled = true;
+
+    #ifdef UNIT_TEST_LOG_ASYNC_SIZE
+    (void) memset(&log_async_counts, 0, sizeof(log_async_counts));
+    #endif
+
+    #ifdef UNIT_TEST_LOG_BINARY
+    log_bin_header();
+    #endif
+    #else
+    (void) file_name;
+    #endif
+}
+
+/**
+ *  Close the unit test log file. This should be called only after all the test
+ *  suites have been executed.
+ */
+void unit_test_log_off (void)
+{
+    #ifdef UNIT_TEST_LOG
+    unit_test_stats_t const stats = unit_test_get_stats();
+
+    // the summary is logged at every level
+    log_msg_u32(UNIT_TEST_EVT_SUMMARY_SUITES,       stats.suites);
+    log_msg_u32(UNIT_TEST_EVT_SUMMARY_CASES,        stats.cases);
+    log_msg_u32(UNIT_TEST_EVT_SUMMARY_CASE_FAILS,   stats.cases_failed);
+    log_msg_u32(UNIT_TEST_EVT_SUMMARY_ASSERTS,      stats.asserts);
+    log_msg_u32(UNIT_TEST_EVT_SUMMARY_ASSERT_FAILS, stats.asserts_failed);
+
+    unit_test_log_flush();
+    log_enabled = false;
+
+    #ifdef UNIT_TEST_LOG_ASYNC_SIZE
+    if (log_drain && log_drain->stop)
+    {
+        log_drain->stop(log_drain->context);
+    }
+    #endif
+
+    #ifndef UNIT_TEST_LOG_NO_STDIO
+    if (log_file)
+    {
+        (void) fclose(log_file);
+        log_file = 0;
+    }
+    #endif
+
+    #ifdef UNIT_TEST_BASELINE
+    baseline_save();
+    #endif
+
+    #if defined(UNIT_TEST_RERUN) && !defined(UNIT_TEST_LOG_NO_STDIO)
+    rerun_save();
+    #endif
+    #endif
+}
+
+/**
+ *  Choose where log output is written. Any output held in the ring buffer is
+ *  flushed to the previous sink first.
+ *
+ *  Built-in sinks are unit_test_sink_stdout, unit_test_sink_file and
+ *  unit_test_sink_stdout_file (the default for text logs). The file sinks
+ *  write to the file opened by unit_test_log_on.
+ *
+ *  @param sink  the sink to use, or null to go back to the default sink
+ */
+void unit_test_log_set_sink (unit_test_sink_t const *sink)
+{
+    #ifdef UNIT_TEST_LOG
+    unit_test_log_flush();
+    current_context->log_sink = sink ? sink : LOG_DEFAULT_SINK;
+    #else
+    (void) sink;
+    #endif
+}
+
+#ifdef UNIT_TEST_LOG_ASYNC_SIZE
+/**
+ *  Choose the drain that sends the asynchronous log buffers, see
+ *  "Asynchronous log" in unit_test.h. The log held for the previous drain
+ *  is sent first.
+ *
+ *  @param drain  the drain to use, or null to go back to the default drain
+ */
+void unit_test_log_set_drain (unit_test_log_drain_t const *drain)
+{
+    #ifdef UNIT_TEST_LOG
+    unit_test_log_flush();
+
+    if (log_drain && log_drain->stop)
+    {
+        log_drain->stop(log_drain->context);
+    }
+
+    log_drain = drain ? drain : LOG_DEFAULT_DRAIN;
+    #else
+    (void) drain;
+    #endif
+}
+
+/**
+ *  Tell the framework that the buffer passed to the start function of the
+ *  drain has been sent. This can be called from an interrupt handler.
+ */
+void unit_test_log_drain_done (void)
+{
+    #ifdef UNIT_TEST_LOG
+    ASYNC_BUSY_SET(false);
+    #endif
+}
+
+/**
+ *  Get the statistics of the asynchronous log since logging was turned on.
+ *
+ *  @return the buffers and bytes handed to the drain and the waits for it
+ */
+unit_test_log_async_stats_t unit_test_log_async_stats (void)
+{
+    #ifdef UNIT_TEST_LOG
+    return log_async_counts;
+    #else
+    unit_test_log_async_stats_t const none = { 0 };
+
+    return none;
+    #endif
+}
+#endif // UNIT_TEST_LOG_ASYNC_SIZE
+
+#ifdef UNIT_TEST_RESULTS
+/**
+ *  Turn the result records on, see "Results" in unit_test.h. Call this
+ *  before the first test suite.
+ *
+ *  @param file_name name of the file the records are written to, or null to
+ *                   write them to the sink set with unit_test_results_set_sink
+ *  @param format    format of the records
+ */
+void unit_test_results_on (char const *file_name,
+    unit_test_results_format_t format)
+{
+    static char const junit_start[] =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n";
+
+    #if defined(UNIT_TEST_LOG) && !defined(UNIT_TEST_LOG_NO_STDIO)
+    if (file_name)
+    {
+        results_file = fopen(file_name, "w");
+
+        #ifdef UNIT_TEST_FORK
+        // the workers share the file, a whole record is written at a time
+        if (results_file)
+        {
+            (void) setvbuf(results_file, 0, _IOLBF, BUFSIZ);
+        }
+        #endif
+    }
+    #else
+    (void) file_name;
+    #endif
+
+    results_format  = format;
+    results_enabled = true;
+
+    if (UNIT_TEST_RESULTS_JUNIT == format)
+    {
+        results_write(junit_start, sizeof(junit_start) - 1);
+    }
+}
+
+/**
+ *  End the result records and close the results file. Call this after the
+ *  last test suite.
+ */
+void unit_test_results_off (void)
+{
+    static char const junit_end[] = "</testsuites>\n";
+    unit_test_sink_t const *sink  = results_sink;
+
+    if (!results_enabled)
+    {
+        return;
+    }
+
+    if (UNIT_TEST_RESULTS_JUNIT == results_format)
+    {
+        results_write(junit_end, sizeof(junit_end) - 1);
+    }
+
+    results_enabled = false;
+
+    #if defined(UNIT_TEST_LOG) && !defined(UNIT_TEST_LOG_NO_STDIO)
+    if (results_file)
+    {
+        (void) fclose(results_file);
+        results_file = 0;
+        return;
+    }
+    #endif
+
+    if (sink && sink->flush)
+    {
+        sink->flush(sink->context);
+    }
+}
+
+/**
+ *  Choose the sink the result records are written to when no results file
+ *  is open.
+ *
+ *  @param sink the sink, or null to not write the records
+ */
+void unit_test_results_set_sink (unit_test_sink_t const *sink)
+{
+    results_sink = sink;
+}
+#endif
+
+/**
+ *  This function is called when an assertion fails. An error message is
+ *  logged and test case failure is noted.
+ *
+ *  @param file     the source file name
+ *  @param line_num the source code line number
+ *  @param msg      the message to be displayed
+ */
+static void assert_failed (unit_test_file_t file, int line_num, char const *msg)
+{
+    assert_record(file, line_num, msg);
+
+    #ifdef UNIT_TEST_FAIL_FAST
+    fail_fast_jump();
+    #endif
+}
+
+/**
+ * Log an assert failure and mark the current test case as failed, without
+ * ending the case. This lets an assert log more detail after the failure.
+ *
+ *  @param[in] file       name of file
+ *  @param[in] line_num   line number
+ *  @param[in] msg        message to print
+ */
+static void assert_record (unit_test_file_t file, int line_num,
+    char const *msg)
+{
+    #ifdef UNIT_TEST_PROPERTY
+    // the runs of a property check only find out whether it fails
+    current_context->property_failed = true;
+    if (current_context->property_quiet)
+    {
+        return;
+    }
+    #endif
+
+    log_held_back(current_context);
+
+    #ifdef UNIT_TEST_PARAMS
+    // the failures of each element follow its index
+    if (current_context->param_active && !current_context->param_logged)
+    {
+        current_context->param_logged = true;
+        log_msg_u32(UNIT_TEST_EVT_PARAM_INDEX, current_context->param_index);
+    }
+    #endif
+
+    log_assert_fail(file, line_num, msg);
+    current_context->stats.asserts_failed++;
+
+    #ifdef UNIT_TEST_RESULTS
+    results_assert(file, line_num, msg);
+    #endif
+
+    #ifdef UNIT_TEST_REPORT
+    report_failure(file, line_num);
+    #endif
+
+    // the current test case has failed
+    current_context->current_test_case_pass = false;
+    
+    // if any unit test case fails during a run, this is set to true
+    current_context->failed_assert = true;
+}
+
+/**
+ * Log the names of the suite and case of a context that were held back by
+ * the log level. This is called before a failure is logged, so the failure
+ * is logged with the names at every level.
+ *
+ * @param context the context
+ */
+static void log_held_back (unit_test_context_t *context)
+{
+    if (context->test_suite_active && !context->suite_logged)
+    {
+        context->suite_logged = true;
+        log_msg_num(UNIT_TEST_EVT_SUITE_NUM, context->test_suite_num);
+        log_msg_str(UNIT_TEST_EVT_SUITE_NAME, context->suite_name);
+    }
+
+    if (context->test_case_active && !context->case_logged)
+    {
+        context->case_logged = true;
+        log_msg_str(UNIT_TEST_EVT_CASE_NAME, context->case_name);
+    }
+}
+
+/**
+ * Add the inline asserts that have passed on this thread to the stats of a
+ * context.
+ *
+ * @param context the context
+ */
+static void stats_fold (unit_test_context_t *context)
+{
+    #ifdef UNIT_TEST_INLINE_ASSERTS
+    context->stats.asserts  += unit_test_inline_passed;
+    unit_test_inline_passed  = 0;
+    #else
+    (void) context;
+    #endif
+}
+
+#if defined(UNIT_TEST_PARALLEL) || defined(UNIT_TEST_FORK)
+/**
+ * Add the stats of a worker to the stats of a run.
+ *
+ * @param total the stats of the run
+ * @param add   the stats of the worker
+ */
+static void stats_add (unit_test_stats_t *total, unit_test_stats_t const *add)
+{
+    total->suites         += add->suites;
+    total->cases          += add->cases;
+    total->cases_failed   += add->cases_failed;
+    total->asserts        += add->asserts;
+    total->asserts_failed += add->asserts_failed;
+}
+#endif
+
+/**
+ * If logging is turned on, log a message to stdout and to the log file.
+ *
+ * @param[in] event id of the message to print
+ */
+static void log_msg (unit_test_event_t const event)
+{
+    #ifdef UNIT_TEST_LOG
+    if (log_enabled)
+    {
+        #ifdef UNIT_TEST_LOG_BINARY
+        uint8_t const record = (uint8_t) event;
+
+        log_write(&record, sizeof(record));
+        #else
+        // the message has no arguments, there is nothing to format
+        log_write((uint8_t const *) log_formats[event],
+            strlen(log_formats[event]));
+        #endif
+    }
+    #else
+    (void) event;
+    #endif
+}
+
+/**
+ * If logging is turned on, log a message and single number to stdout and to
+ * the log file. It is assumed that the message format contains a single
+ * format specifier for a integer.
+ *
+ *  @param[in] event  id of the message to print
+ *  @param[in] num    number to print
+ */
+//lint -e{592} non-literal format specifier
+static void log_msg_num (unit_test_event_t const event, uint16_t const num)
+{
+    #ifdef UNIT_TEST_LOG
+    if(log_enabled)
+    {
+        #ifdef UNIT_TEST_LOG_BINARY
+        uint8_t const record[] =
+        {
+            (uint8_t) event, (uint8_t) num, (uint8_t) (num >> 8)
+        };
+
+        log_write(record, sizeof(record));
+        #else
+        log_line_write(snprintf(LOG_LINE, sizeof(LOG_LINE),
+            log_formats[event], num));
+        #endif
+    }
+    #else
+    (void) event;
+    (void) num;
+    #endif
+}
+
+/**
+ * If logging is turned on, log a message and a 32-bit number to stdout and
+ * to the log file. It is assumed that the message format contains a single
+ * format specifier for an unsigned long.
+ *
+ *  @param[in] event  id of the message to print
+ *  @param[in] num    number to print
+ */
+//lint -e{592} non-literal format specifier
+static void log_msg_u32 (unit_test_event_t const event, uint32_t const num)
+{
+    #ifdef UNIT_TEST_LOG
+    if(log_enabled)
+    {
+        #ifdef UNIT_TEST_LOG_BINARY
+        uint8_t const record[] =
+        {
+            (uint8_t) event, (uint8_t) num, (uint8_t) (num >> 8),
+            (uint8_t) (num >> 16), (uint8_t) (num >> 24)
+        };
+
+        log_write(record, sizeof(record));
+        #else
+        log_line_write(snprintf(LOG_LINE, sizeof(LOG_LINE),
+            log_formats[event], (unsigned long) num));
+        #endif
+    }
+    #else
+    (void) event;
+    (void) num;
+    #endif
+}
+
+#ifdef UNIT_TEST_TIMESTAMPS
+/**
+ * @return the count of the timestamp source, 0 when there is none
+ */
+static uint32_t timestamp_now (void)
+{
+    return timestamp_source ? timestamp_source() : 0;
+}
+#endif
+
+/**
+ * If logging is turned on, log a message and single string to stdout and to
+ * the log file. It is assumed that the message format contains a single
+ * format specifier for a string.
+ *
+ *  @param[in] event  id of the message to print
+ *  @param[in] str    string to print
+ */
+//lint -e{592} non-literal format specifier
+static void log_msg_str (unit_test_event_t const event, char const *str)
+{
+    #ifdef UNIT_TEST_LOG
+    if(log_enabled)
+    {
+        #ifdef UNIT_TEST_LOG_BINARY
+        uint8_t record[2 + UINT8_MAX];
+        size_t  len = strlen(str);
+
+        if (len > UINT8_MAX)
+        {
+            len = UINT8_MAX;
+        }
+
+        record[0] = (uint8_t) event;
+        record[1] = (uint8_t) len;
+        (void) memcpy(&record[2], str, len);
+        log_write(record, 2 + len);
+        #else
+        log_line_write(snprintf(LOG_LINE, sizeof(LOG_LINE),
+            log_formats[event], str));
+        #endif
+    }
+    #else
+    (void) event;
+    (void) str;
+    #endif
+}
+
+/**
+ * If logging is turned on, log a message and bytes printed as hex to stdout
+ * and to the log file. It is assumed that the message format contains a
+ * single format specifier for a string.
+ *
+ *  @param[in] event  id of the message to print
+ *  @param[in] bytes  bytes to print
+ *  @param[in] len    number of bytes, at most UNIT_TEST_MEM_WINDOW
+ */
+//lint -e{592} non-literal format specifier
+static void log_msg_hex (unit_test_event_t const event, uint8_t const *bytes,
+    size_t len)
+{
+    #ifdef UNIT_TEST_LOG
+    if(log_enabled)
+    {
+        #ifdef UNIT_TEST_LOG_BINARY
+        uint8_t record[2 + UNIT_TEST_MEM_WINDOW];
+
+        record[0] = (uint8_t) event;
+        record[1] = (uint8_t) len;
+        (void) memcpy(&record[2], bytes, len);
+        log_write(record, 2 + len);
+        #else
+        static char const digits[] = "0123456789abcdef";
+        char              hex[3 * UNIT_TEST_MEM_WINDOW + 1];
+        size_t            pos = 0;
+
+        for (size_t index = 0; index < len; index++)
+        {
+            if (index)
+            {
+                hex[pos++] = ' ';
+            }
+            hex[pos++] = digits[bytes[index] >> 4];
+            hex[pos++] = digits[bytes[index] & 0x0F];
+        }
+        hex[pos] = 0;
+
+        log_line_write(snprintf(LOG_LINE, sizeof(LOG_LINE),
+            log_formats[event], hex));
+        #endif
+    }
+    #else
+    (void) event;
+    (void) bytes;
+    (void) len;
+    #endif
+}
+
+#ifdef UNIT_TEST_FLOATING_POINT
+/**
+ * If logging is turned on, log a message and a floating point number to
+ * stdout and to the log file. It is assumed that the message format contains
+ * a single format specifier for a double.
+ *
+ *  @param[in] event  id of the message to print
+ *  @param[in] num    number to print
+ */
+//lint -e{592} non-literal format specifier
+static void log_msg_float (unit_test_event_t const event, float64_t const num)
+{
+    #ifdef UNIT_TEST_LOG
+    if(log_enabled)
+    {
+        #ifdef UNIT_TEST_LOG_BINARY
+        uint8_t record[1 + sizeof(num)];
+
+        record[0] = (uint8_t) event;
+        (void) memcpy(&record[1], &num, sizeof(num));
+        log_write(record, sizeof(record));
+        #else
+        log_line_write(snprintf(LOG_LINE, sizeof(LOG_LINE),
+            log_formats[event], num));
+        #endif
+    }
+    #else
+    (void) event;
+    (void) num;
+    #endif
+}
+#endif
+
+/**
+ * If logging is turned on, log an assert failure with the file name and line
+ * number to stdout and the log file.
+ *
+ *  @param[in] file_name   name of file
+ *  @param[in] line_num    line number
+ *  @param[in] msg_str     message to print, or the raw failure record
+ *                         created by log_bin_values in binary mode
+ */
+//lint -e{592} non-literal format specifier
+static void log_assert_fail (unit_test_file_t file_name, int const line_num,
+    char const *msg_str)
+{
+    #ifdef UNIT_TEST_LOG
+    if(log_enabled)
+    {
+        #ifdef UNIT_TEST_LOG_BINARY
+        uint8_t const *values  = (uint8_t const *) msg_str;
+        #ifdef LOG_FILE_NAMES
+        uint16_t const file_id = log_bin_file_id(file_name);
+        #else
+        uint16_t const file_id = file_name;
+        #endif
+        size_t const   len     = 2 + (size_t) values[2];
+        uint8_t        record[5 + MAX_MSG_LEN];
+
+        // event id, file id, line, then the type tag, length and values
+        record[0] = values[0];
+        record[1] = (uint8_t) file_id;
+        record[2] = (uint8_t) (file_id >> 8);
+        record[3] = (uint8_t) line_num;
+        record[4] = (uint8_t) ((uint16_t) line_num >> 8);
+        (void) memcpy(&record[5], &values[1], len);
+        log_write(record, 5 + len);
+        #elif defined(UNIT_TEST_FILE_IDS)
+        char file_str[sizeof("#65535")];
+
+        (void) snprintf(file_str, sizeof(file_str), "#%u",
+            (unsigned) file_name);
+        log_line_write(snprintf(LOG_LINE, sizeof(LOG_LINE),
+            log_formats[UNIT_TEST_EVT_ASSERT_EQ], file_str, line_num,
+            msg_str));
+        #else
+        log_line_write(snprintf(LOG_LINE, sizeof(LOG_LINE),
+            log_formats[UNIT_TEST_EVT_ASSERT_EQ], file_name, line_num,
+            msg_str));
+        #endif
+    }
+    #else
+    (void) file_name;
+    (void) line_num;
+    (void) msg_str;
+    #endif
+}
+
+/**
+ *  Write any log messages held in the ring buffer to the sink and flush the
+ *  sink. This is called by test_suite_end and unit_test_log_off, it can also
+ *  be called when the application is idle. With UNIT_TEST_LOG_ASYNC_SIZE the
+ *  buffer being filled is handed to the drain and this waits until it has
+ *  been sent.
+ */
+void unit_test_log_flush (void)
+{
+    #ifdef UNIT_TEST_LOG
+    unit_test_sink_t const *const sink = current_context->log_sink;
+
+    #ifdef UNIT_TEST_LOG_RING_SIZE
+    // only the default context logs through the ring
+    if (current_context == &default_context)
+    {
+        if (log_ring_dropped)
+        {
+            uint16_t const dropped = log_ring_dropped;
+
+            // the dropped messages are older than the ones kept in the ring
+            log_ring_dropped = 0;
+            log_ring_bypass  = true;
+            log_msg_num(UNIT_TEST_EVT_LOG_DROPPED, dropped);
+            log_ring_bypass  = false;
+        }
+
+        log_ring_drain();
+    }
+    #endif
+
+    #ifdef UNIT_TEST_LOG_ASYNC_SIZE
+    // only the default context logs through the buffers
+    if (current_context == &default_context)
+    {
+        log_async_send();
+        log_async_wait();
+    }
+    #endif
+
+    if (sink && sink->flush)
+    {
+        sink->flush(sink->context);
+    }
+    #endif
+}
+
+#ifdef UNIT_TEST_LOG
+
+/**
+ * Write the bytes of a log message to the sink of the current context. The
+ * bytes of the default context are held in the ring buffer or the
+ * asynchronous log buffers if one is configured, otherwise they are output
+ * immediately.
+ *
+ *  @param[in] data  bytes to write
+ *  @param[in] len   number of bytes
+ */
+static void log_write (uint8_t const *data, size_t len)
+{
+    #ifdef UNIT_TEST_PROPERTY
+    // the runs of a property check are not logged
+    if (current_context->property_quiet)
+    {
+        return;
+    }
+    #endif
+
+    #ifdef UNIT_TEST_LOG_RING_SIZE
+    if ((current_context == &default_context) && !log_ring_bypass)
+    {
+        log_ring_put(data, len);
+        return;
+    }
+    #endif
+
+    #ifdef UNIT_TEST_LOG_ASYNC_SIZE
+    if (current_context == &default_context)
+    {
+        log_async_put(data, len);
+        return;
+    }
+    #endif
+
+    log_output(current_context->log_sink, data, len);
+}
+
+/**
+ * Output log bytes to a sink.
+ *
+ *  @param[in] sink  sink to write to, may be null
+ *  @param[in] data  bytes to output
+ *  @param[in] len   number of bytes
+ */
+static void log_output (unit_test_sink_t const *sink, uint8_t const *data,
+    size_t len)
+{
+    if (sink && (len > 0))
+    {
+        sink->write(sink->context, data, len);
+    }
+}
+
+#ifndef UNIT_TEST_LOG_NO_STDIO
+
+/**
+ * Built-in sink, write log bytes to stdout.
+ */
+static void sink_stdout_write (void *context, uint8_t const *data, size_t len)
+{
+    (void) context;
+    (void) fwrite(data, 1, len, stdout);
+}
+
+/**
+ * Built-in sink, flush stdout.
+ */
+static void sink_stdout_flush (void *context)
+{
+    (void) context;
+    (void) fflush(stdout);
+}
+
+/**
+ * Built-in sink, write log bytes to the log file if one is open.
+ */
+static void sink_file_write (void *context, uint8_t const *data, size_t len)
+{
+    (void) context;
+
+    if (log_file)
+    {
+        (void) fwrite(data, 1, len, log_file);
+    }
+}
+
+/**
+ * Built-in sink, flush the log file if one is open.
+ */
+static void sink_file_flush (void *context)
+{
+    (void) context;
+
+    if (log_file)
+    {
+        (void) fflush(log_file);
+    }
+}
+
+/**
+ * Built-in sink, write log bytes to stdout and to the log file.
+ */
+static void sink_stdout_file_write (void *context, uint8_t const *data,
+    size_t len)
+{
+    sink_stdout_write(context, data, len);
+    sink_file_write(context, data, len);
+}
+
+/**
+ * Built-in sink, flush stdout and the log file.
+ */
+static void sink_stdout_file_flush (void *context)
+{
+    sink_stdout_flush(context);
+    sink_file_flush(context);
+}
+
+#endif // UNIT_TEST_LOG_NO_STDIO
+
+#endif // UNIT_TEST_LOG
+
+#if defined(UNIT_TEST_LOG) && !defined(UNIT_TEST_LOG_BINARY)
+
+/**
+ * Write the message formatted in the log_line buffer of the context.
+ *
+ *  @param[in] len  length returned by snprintf
+ */
+static void log_line_write (int len)
+{
+    if (len > 0)
+    {
+        // snprintf returns the length before truncation
+        if (len >= (int) sizeof(LOG_LINE))
+        {
+            len = (int) sizeof(LOG_LINE) - 1;
+        }
+
+        log_write((uint8_t const *) LOG_LINE, (size_t) len);
+    }
+}
+
+#endif
+
+#ifdef UNIT_TEST_RESULTS
+
+/**
+ * Start the suite count of a context and write the start of the suite.
+ *
+ *  @param[in] context  context running the suite
+ */
+static void results_suite_start (unit_test_context_t *context)
+{
+    char  *const line = context->results_line;
+    size_t       len;
+
+    context->results_cases  = 0;
+    context->results_failed = 0;
+
+    if (!results_enabled)
+    {
+        return;
+    }
+
+    if (UNIT_TEST_RESULTS_JUNIT == results_format)
+    {
+        len = results_text(line, 0, "  <testsuite id=\"");
+        len = results_u32(line, len, context->test_suite_num);
+        len = results_text(line, len, "\" name=\"");
+        len = results_name(line, len, context->suite_name);
+        len = results_text(line, len, "\">\n");
+    }
+    else
+    {
+        len = results_text(line, 0, "{\"record\":\"suite\",\"suite\":");
+        len = results_u32(line, len, context->test_suite_num);
+        len = results_text(line, len, ",\"name\":\"");
+        len = results_name(line, len, context->suite_name);
+        len = results_text(line, len, "\"}\n");
+    }
+
+    results_write(line, len);
+}
+
+/**
+ * Write the end of a suite with its counts.
+ *
+ *  @param[in] context  context running the suite
+ */
+static void results_suite_end (unit_test_context_t *context)
+{
+    char  *const line = context->results_line;
+    size_t       len;
+
+    // the report of a crashed worker has no names, the worker wrote them
+    if (!results_enabled || !context->suite_name)
+    {
+        return;
+    }
+
+    if (UNIT_TEST_RESULTS_JUNIT == results_format)
+    {
+        len = 0;
+
+        #ifdef UNIT_TEST_TIMESTAMPS
+        if (timestamp_source)
+        {
+            len = results_text(line, len,
+                "    <properties><property name=\"ticks\" value=\"");
+            len = results_u32(line, len, context->suite_ticks);
+            len = results_text(line, len, "\"/></properties>\n");
+        }
+        #endif
+
+        len = results_text(line, len, "  </testsuite>\n");
+    }
+    else
+    {
+        len = results_text(line, 0,
+            "{\"record\":\"suite_end\",\"suite\":");
+        len = results_u32(line, len, context->test_suite_num);
+        len = results_text(line, len, ",\"cases\":");
+        len = results_u32(line, len, context->results_cases);
+        len = results_text(line, len, ",\"failed\":");
+        len = results_u32(line, len, context->results_failed);
+
+        #ifdef UNIT_TEST_TIMESTAMPS
+        if (timestamp_source)
+        {
+            len = results_text(line, len, ",\"ticks\":");
+            len = results_u32(line, len, context->suite_ticks);
+        }
+        #endif
+
+        len = results_text(line, len, "}\n");
+    }
+
+    results_write(line, len);
+}
+
+/**
+ * Start the assert count of a case, JUnit XML opens the testcase element.
+ *
+ *  @param[in] context  context running the case
+ */
+static void results_case_start (unit_test_context_t *context)
+{
+    char  *const line = context->results_line;
+    size_t       len;
+
+    context->results_asserts = 0;
+
+    if (!results_enabled || (UNIT_TEST_RESULTS_JUNIT != results_format))
+    {
+        return;
+    }
+
+    len = results_text(line, 0, "    <testcase classname=\"");
+    len = results_name(line, len, context->suite_name);
+    len = results_text(line, len, "\" name=\"");
+    len = results_name(line, len, context->case_name);
+    len = results_text(line, len, "\">\n");
+
+    results_write(line, len);
+}
+
+/**
+ * Count a case that has ended and write its result.
+ *
+ *  @param[in] context  context running the case
+ */
+static void results_case_end (unit_test_context_t *context)
+{
+    char  *const line = context->results_line;
+    bool const   pass = context->current_test_case_pass;
+    size_t       len;
+
+    context->results_cases++;
+
+    if (!pass)
+    {
+        context->results_failed++;
+    }
+
+    // the report of a crashed worker has no names, the worker wrote them
+    if (!results_enabled || !context->suite_name)
+    {
+        return;
+    }
+
+    if (UNIT_TEST_RESULTS_JUNIT == results_format)
+    {
+        len = 0;
+
+        // a timed out case fails without a failed assert
+        if (!pass && !context->results_asserts)
+        {
+            len = results_text(line, len, "      <failure type=\"case\" "
+                "message=\"Test Case Failed\"/>\n");
+        }
+
+        #ifdef UNIT_TEST_TIMESTAMPS
+        if (timestamp_source)
+        {
+            len = results_text(line, len,
+                "      <properties><property name=\"ticks\" value=\"");
+            len = results_u32(line, len, context->case_ticks);
+            len = results_text(line, len, "\"/></properties>\n");
+        }
+        #endif
+
+        len = results_text(line, len, "    </testcase>\n");
+    }
+    else
+    {
+        len = results_text(line, 0, "{\"record\":\"case\",\"suite\":");
+        len = results_u32(line, len, context->test_suite_num);
+        len = results_text(line, len, ",\"name\":\"");
+        len = results_name(line, len, context->case_name);
+        len = results_text(line, len,
+            pass ? "\",\"passed\":true" : "\",\"passed\":false");
+        len = results_text(line, len, ",\"failed_asserts\":");
+        len = results_u32(line, len, context->results_asserts);
+
+        #ifdef UNIT_TEST_TIMESTAMPS
+        if (timestamp_source)
+        {
+            len = results_text(line, len, ",\"ticks\":");
+            len = results_u32(line, len, context->case_ticks);
+        }
+        #endif
+
+        len = results_text(line, len, "}\n");
+    }
+
+    results_write(line, len);
+}
+
+/**
+ * Count a failed assert of the current case and write it.
+ *
+ *  @param[in] file      source file of the assert
+ *  @param[in] line_num  line number of the assert
+ *  @param[in] msg       the assert message, with the expected and actual
+ *                       values
+ */
+static void results_assert (unit_test_file_t file, int line_num,
+    char const *msg)
+{
+    unit_test_context_t *const context = current_context;
+    char                *const line    = context->results_line;
+    size_t                     len;
+
+    context->results_asserts++;
+
+    if (!results_enabled)
+    {
+        return;
+    }
+
+    // the messages start with a space to follow the log text
+    while (' ' == *msg)
+    {
+        msg++;
+    }
+
+    if (UNIT_TEST_RESULTS_JUNIT == results_format)
+    {
+        len = results_text(line, 0,
+            "      <failure type=\"assert\" message=\"");
+        len = results_name(line, len, msg);
+        len = results_text(line, len, "\">");
+        #ifdef UNIT_TEST_FILE_IDS
+        len = results_text(line, len, "#");
+        len = results_u32(line, len, file);
+        #else
+        len = results_name(line, len, file);
+        #endif
+        len = results_text(line, len, ":");
+        len = results_u32(line, len, (uint32_t) line_num);
+        len = results_text(line, len, "</failure>\n");
+    }
+    else
+    {
+        len = results_text(line, 0, "{\"record\":\"assert\",\"suite\":");
+        len = results_u32(line, len, context->test_suite_num);
+        len = results_text(line, len, ",\"case\":\"");
+        len = results_name(line, len, context->case_name);
+        #ifdef UNIT_TEST_FILE_IDS
+        len = results_text(line, len, "\",\"file_id\":");
+        len = results_u32(line, len, file);
+        #else
+        len = results_text(line, len, "\",\"file\":\"");
+        len = results_name(line, len, file);
+        len = results_text(line, len, "\"");
+        #endif
+        len = results_text(line, len, ",\"line\":");
+        len = results_u32(line, len, (uint32_t) line_num);
+        len = results_text(line, len, ",\"message\":\"");
+        len = results_name(line, len, msg);
+        len = results_text(line, len, "\"}\n");
+    }
+
+    results_write(line, len);
+}
+
+/**
+ * Write a result record to the results file, or to the results sink.
+ *
+ *  @param[in] record  bytes of the record
+ *  @param[in] len     number of bytes
+ */
+static void results_write (char const *record, size_t len)
+{
+    unit_test_sink_t const *sink = results_sink;
+
+    #if defined(UNIT_TEST_LOG) && !defined(UNIT_TEST_LOG_NO_STDIO)
+    if (results_file)
+    {
+        sink = &results_file_sink;
+    }
+    #endif
+
+    // the log may not be built in, so the sink is written directly
+    if (sink && (len > 0))
+    {
+        sink->write(sink->context, (uint8_t const *) record, len);
+    }
+}
+
+/**
+ * Append text to a result record, as much as fits.
+ *
+ *  @param[out] line  the record
+ *  @param[in]  len   length of the record so far
+ *  @param[in]  text  text to append
+ *
+ *  @return the length of the record
+ */
+static size_t results_text (char *line, size_t len, char const *text)
+{
+    for (; *text && (len < RESULTS_LEN); text++)
+    {
+        line[len++] = *text;
+    }
+
+    return len;
+}
+
+/**
+ * Append a name or message to a result record, escaped for the format of
+ * the records. The string is cut to keep room for the rest of the record.
+ *
+ *  @param[out] line  the record
+ *  @param[in]  len   length of the record so far
+ *  @param[in]  str   the string, may be null
+ *
+ *  @return the length of the record
+ */
+static size_t results_name (char *line, size_t len, char const *str)
+{
+    bool const json = (UNIT_TEST_RESULTS_JUNIT != results_format);
+
+    for (; str && *str && (len < (RESULTS_LEN - RESULTS_TAIL)); str++)
+    {
+        unsigned char const c = (unsigned char) *str;
+        char                code[sizeof("\\u0000")] = { (char) c, 0 };
+        char const         *text = code;
+
+        if (json)
+        {
+            if (('"' == c) || ('\\' == c))
+            {
+                code[0] = '\\';
+                code[1] = (char) c;
+            }
+            else if (c < 0x20)
+            {
+                (void) snprintf(code, sizeof(code), "\\u%04x", c);
+            }
+        }
+        else if ('&' == c)
+        {
+            text = "&amp;";
+        }
+        else if ('<' == c)
+        {
+            text = "&lt;";
+        }
+        else if ('>' == c)
+        {
+            text = "&gt;";
+        }
+        else if ('"' == c)
+        {
+            text = "&quot;";
+        }
+        else if (c < 0x20)
+        {
+            // XML 1.0 cannot hold most control characters
+            code[0] = '?';
+        }
+
+        len = results_text(line, len, text);
+    }
+
+    return len;
+}
+
+/**
+ * Append a number to a result record.
+ *
+ *  @param[out] line  the record
+ *  @param[in]  len   length of the record so far
+ *  @param[in]  num   the number
+ *
+ *  @return the length of the record
+ */
+static size_t results_u32 (char *line, size_t len, uint32_t num)
+{
+    char text[sizeof("4294967295")];
+
+    (void) snprintf(text, sizeof(text), "%lu", (unsigned long) num);
+
+    return results_text(line, len, text);
+}
+
+#if defined(UNIT_TEST_LOG) && !defined(UNIT_TEST_LOG_NO_STDIO)
+
+/**
+ * Results file sink, write a record to the results file.
+ */
+static void results_file_write (void *context, uint8_t const *data,
+    size_t len)
+{
+    (void) context;
+    (void) fwrite(data, 1, len, results_file);
+}
+
+/**
+ * Results file sink, flush the results file.
+ */
+static void results_file_flush (void *context)
+{
+    (void) context;
+    (void) fflush(results_file);
+}
+
+#endif
+#endif // UNIT_TEST_RESULTS
+
+#ifdef UNIT_TEST_REPORT
+/**
+ * Fill in the header of the report block and copy the counts of a context
+ * to it.
+ *
+ *  @param[in] context  the context
+ */
+static void report_stats (unit_test_context_t *context)
+{
+    uint16_t const endian = 1;
+
+    stats_fold(context);
+
+    (void) memcpy(unit_test_report.magic, UNIT_TEST_REPORT_MAGIC,
+        sizeof(unit_test_report.magic));
+    unit_test_report.version       = UNIT_TEST_REPORT_VERSION;
+    unit_test_report.little_endian = *(uint8_t const *) &endian;
+    unit_test_report.max_failures  = UNIT_TEST_REPORT_MAX_FAILURES;
+    unit_test_report.stats         = context->stats;
+}
+
+/**
+ * Add a failed assert to the ring of the report block, with the values kept
+ * by the failure message macros.
+ *
+ *  @param[in] file      id of the source file
+ *  @param[in] line_num  line number
+ */
+static void report_failure (unit_test_file_t file, int line_num)
+{
+    unit_test_report_failure_t *const failure = &unit_test_report.recent[
+        unit_test_report.failures % UNIT_TEST_REPORT_MAX_FAILURES];
+
+    failure->file  = (uint16_t) file;
+    failure->line  = (uint16_t) line_num;
+    failure->suite = current_context->test_suite_num;
+    failure->type  = report_type;
+    failure->len   = report_len;
+    (void) memcpy(failure->values, report_data, sizeof(failure->values));
+
+    unit_test_report.failures++;
+    report_len = 0;
+
+    report_stats(current_context);
+}
+
+/**
+ * Keep the values of a failed assert for its failure record.
+ *
+ *  @param[in] type      type tag of the values
+ *  @param[in] expected  the expected value
+ *  @param[in] actual    the actual value, null for a "not equal" failure
+ *  @param[in] size      size of each value in bytes
+ */
+static void report_values (unit_test_type_t type, void const *expected,
+    void const *actual, size_t size)
+{
+    report_type = (uint8_t) type;
+    report_len  = (uint8_t) (actual ? 2 * size : size);
+    (void) memcpy(report_data, expected, size);
+
+    if (actual)
+    {
+        (void) memcpy(&report_data[size], actual, size);
+    }
+}
+
+#ifdef UNIT_TEST_COMPACT_ASSERTS
+/**
+ * Keep the values of a failed compact integer assert for its failure
+ * record. The widened values are kept with the width of their type, in
+ * target byte order.
+ *
+ *  @param[in] type      type tag of the values
+ *  @param[in] equal     true if the values should have been equal
+ *  @param[in] expected  the expected value, widened
+ *  @param[in] actual    the actual value, widened
+ */
+static void report_wide (unit_test_type_t type, bool equal,
+    unit_test_uint_t expected, unit_test_uint_t actual)
+{
+    uint16_t const endian = 1;
+    bool const     little = (1 == *(uint8_t const *) &endian);
+    uint8_t const  width  = type_descs[type].width;
+
+    report_type = (uint8_t) type;
+    report_len  = (uint8_t) (equal ? 2 * width : width);
+
+    for (uint8_t index = 0; index < width; index++)
+    {
+        uint8_t const pos = little ? index : (uint8_t) (width - 1 - index);
+
+        report_data[pos]         = (uint8_t) (expected >> (8 * index));
+        report_data[width + pos] = (uint8_t) (actual >> (8 * index));
+    }
+}
+#endif
+#endif
+
+#if defined(UNIT_TEST_LOG) && defined(UNIT_TEST_LOG_RING_SIZE)
+
+/**
+ * Append a message to the ring buffer. When the ring is full the oldest
+ * messages are dropped if UNIT_TEST_LOG_RING_DROP_OLDEST is defined, otherwise
+ * the ring is flushed to make room (the caller blocks on the output).
+ *
+ *  @param[in] data  bytes of the message
+ *  @param[in] len   number of bytes
+ */
+static void log_ring_put (uint8_t const *data, size_t len)
+{
+    size_t const  need = RING_PREFIX_LEN + len;
+    uint8_t const prefix[RING_PREFIX_LEN] =
+    {
+        (uint8_t) len, (uint8_t) (len >> 8)
+    };
+
+    if ((need > sizeof(log_ring)) || (len > UINT16_MAX))
+    {
+        // the message can never fit in the ring
+        #ifdef UNIT_TEST_LOG_RING_DROP_OLDEST
+        if (log_ring_dropped < UINT16_MAX)
+        {
+            log_ring_dropped++;
+        }
+        #else
+        log_ring_drain();
+        log_output(default_context.log_sink, data, len);
+        #endif
+        return;
+    }
+
+    while ((sizeof(log_ring) - log_ring_used) < need)
+    {
+        #ifdef UNIT_TEST_LOG_RING_DROP_OLDEST
+        uint8_t old[RING_PREFIX_LEN];
+        size_t  old_len;
+
+        log_ring_copy_out(old, sizeof(old));
+        old_len = (size_t) old[0] | ((size_t) old[1] << 8);
+
+        #ifdef LOG_FILE_NAMES
+        if ((uint8_t) UNIT_TEST_EVT_FILE == log_ring[log_ring_tail])
+        {
+            // the file name is lost, write it again the next time it is used
+            uint16_t const file_id = (uint16_t) (
+                log_ring[(log_ring_tail + 1) % sizeof(log_ring)]
+                | (log_ring[(log_ring_tail + 2) % sizeof(log_ring)] << 8));
+
+            default_context.log_file_names[file_id] = 0;
+        }
+        #endif
+
+        log_ring_tail = (log_ring_tail + old_len) % sizeof(log_ring);
+        log_ring_used -= old_len;
+
+        if (log_ring_dropped < UINT16_MAX)
+        {
+            log_ring_dropped++;
+        }
+        #else
+        log_ring_drain();
+        #endif
+    }
+
+    log_ring_copy_in(prefix, sizeof(prefix));
+    log_ring_copy_in(data, len);
+}
+
+/**
+ * Output every message in the ring buffer and empty it.
+ */
+static void log_ring_drain (void)
+{
+    while (log_ring_used)
+    {
+        uint8_t prefix[RING_PREFIX_LEN];
+        size_t  len;
+        size_t  first;
+
+        log_ring_copy_out(prefix, sizeof(prefix));
+        len = (size_t) prefix[0] | ((size_t) prefix[1] << 8);
+
+        // the message may wrap around the end of the ring
+        first = sizeof(log_ring) - log_ring_tail;
+        if (first > len)
+        {
+            first = len;
+        }
+
+        log_output(default_context.log_sink, &log_ring[log_ring_tail], first);
+        log_output(default_context.log_sink, log_ring, len - first);
+
+        log_ring_tail = (log_ring_tail + len) % sizeof(log_ring);
+        log_ring_used -= len;
+    }
+
+    log_ring_tail = 0;
+}
+
+/**
+ * Copy bytes to the head of the ring. The caller makes sure they fit.
+ *
+ *  @param[in] data  bytes to copy
+ *  @param[in] len   number of bytes
+ */
+static void log_ring_copy_in (uint8_t const *data, size_t len)
+{
+    size_t const head  = (log_ring_tail + log_ring_used) % sizeof(log_ring);
+    size_t       first = sizeof(log_ring) - head;
+
+    if (first > len)
+    {
+        first = len;
+    }
+
+    (void) memcpy(&log_ring[head], data, first);
+    (void) memcpy(log_ring, &data[first], len - first);
+    log_ring_used += len;
+}
+
+/**
+ * Remove bytes from the tail of the ring. The caller makes sure they are
+ * there.
+ *
+ *  @param[out] data  buffer for the bytes
+ *  @param[in]  len   number of bytes
+ */
+static void log_ring_copy_out (uint8_t *data, size_t len)
+{
+    size_t first = sizeof(log_ring) - log_ring_tail;
+
+    if (first > len)
+    {
+        first = len;
+    }
+
+    (void) memcpy(data, &log_ring[log_ring_tail], first);
+    (void) memcpy(&data[first], log_ring, len - first);
+    log_ring_tail = (log_ring_tail + len) % sizeof(log_ring);
+    log_ring_used -= len;
+}
+
+#endif // UNIT_TEST_LOG_RING_SIZE
+
+#if defined(UNIT_TEST_LOG) && defined(UNIT_TEST_LOG_ASYNC_SIZE)
+
+/**
+ * Copy a message into the buffer being filled. Each time the buffer is full
+ * it is handed to the drain, which may wait for the drain to send the other
+ * buffer. Without a drain the bytes are written to the sink.
+ *
+ *  @param[in] data  bytes of the message
+ *  @param[in] len   number of bytes
+ */
+static void log_async_put (uint8_t const *data, size_t len)
+{
+    if (!log_drain)
+    {
+        log_output(default_context.log_sink, data, len);
+        return;
+    }
+
+    while (len > 0)
+    {
+        size_t copy = sizeof(log_async[0]) - log_async_used;
+
+        if (copy > len)
+        {
+            copy = len;
+        }
+
+        (void) memcpy(&log_async[log_async_fill][log_async_used], data, copy);
+        log_async_used += copy;
+        data           += copy;
+        len            -= copy;
+
+        if (log_async_used == sizeof(log_async[0]))
+        {
+            log_async_send();
+        }
+    }
+}
+
+/**
+ * Hand the buffer being filled to the drain and go on with the other
+ * buffer, once the drain has sent it. Waiting for the drain here is what
+ * the statistics count.
+ */
+static void log_async_send (void)
+{
+    uint8_t const *data;
+    size_t         len;
+
+    if ((0 == log_async_used) || !log_drain)
+    {
+        return;
+    }
+
+    if (ASYNC_BUSY_GET())
+    {
+        #ifdef UNIT_TEST_TIMESTAMPS
+        uint32_t const start = timestamp_now();
+        #endif
+
+        log_async_counts.waits++;
+        log_async_wait();
+
+        #ifdef UNIT_TEST_TIMESTAMPS
+        log_async_counts.wait_ticks += timestamp_now() - start;
+        #endif
+    }
+
+    data = log_async[log_async_fill];
+    len  = log_async_used;
+
+    log_async_fill ^= 1u;
+    log_async_used  = 0;
+    log_async_counts.buffers++;
+    log_async_counts.bytes += (uint32_t) len;
+
+    ASYNC_BUSY_SET(true);
+    log_drain->start(log_drain->context, data, len);
+}
+
+/**
+ * Wait until the drain has sent the buffer handed to it.
+ */
+static void log_async_wait (void)
+{
+    while (ASYNC_BUSY_GET())
+    {
+        if (log_drain && log_drain->wait)
+        {
+            log_drain->wait(log_drain->context);
+        }
+    }
+}
+
+#ifdef UNIT_TEST_LOG_ASYNC_THREAD
+
+/**
+ * Built-in drain, hand a buffer to the drain thread, starting the thread if
+ * it is not running. If it cannot be started the buffer is written here.
+ */
+static void drain_thread_start (void *context, uint8_t const *data,
+    size_t len)
+{
+    (void) context;
+
+    (void) pthread_mutex_lock(&drain_lock);
+    drain_data = data;
+    drain_len  = len;
+    (void) pthread_cond_broadcast(&drain_cond);
+    (void) pthread_mutex_unlock(&drain_lock);
+
+    if (!drain_running)
+    {
+        drain_running = (0 == pthread_create(&drain_thread, 0,
+            drain_thread_main, 0));
+    }
+
+    if (!drain_running)
+    {
+        (void) pthread_mutex_lock(&drain_lock);
+        drain_data = 0;
+        (void) pthread_mutex_unlock(&drain_lock);
+
+        log_output(default_context.log_sink, data, len);
+        unit_test_log_drain_done();
+    }
+}
+
+/**
+ * Built-in drain, block until the drain thread has sent its buffer.
+ */
+static void drain_thread_wait (void *context)
+{
+    (void) context;
+
+    (void) pthread_mutex_lock(&drain_lock);
+    while (ASYNC_BUSY_GET())
+    {
+        (void) pthread_cond_wait(&drain_cond, &drain_lock);
+    }
+    (void) pthread_mutex_unlock(&drain_lock);
+}
+
+/**
+ * Built-in drain, end the drain thread. It is started again by the next
+ * buffer.
+ */
+static void drain_thread_stop (void *context)
+{
+    (void) context;
+
+    if (drain_running)
+    {
+        (void) pthread_mutex_lock(&drain_lock);
+        drain_stopping = true;
+        (void) pthread_cond_broadcast(&drain_cond);
+        (void) pthread_mutex_unlock(&drain_lock);
+
+        (void) pthread_join(drain_thread, 0);
+        drain_running  = false;
+        drain_stopping = false;
+    }
+}
+
+/**
+ * The drain thread, write each buffer handed to it to the sink of the
+ * default context. The test thread does not change the sink while a buffer
+ * is being sent.
+ *
+ * @param arg unused
+ *
+ * @return null
+ */
+static void *drain_thread_main (void *arg)
+{
+    (void) arg;
+
+    (void) pthread_mutex_lock(&drain_lock);
+    for (;;)
+    {
+        uint8_t const *data;
+        size_t         len;
+
+        while (!drain_data && !drain_stopping)
+        {
+            (void) pthread_cond_wait(&drain_cond, &drain_lock);
+        }
+
+        if (!drain_data)
+        {
+            break;
+        }
+
+        data = drain_data;
+        len  = drain_len;
+        (void) pthread_mutex_unlock(&drain_lock);
+
+        log_output(default_context.log_sink, data, len);
+
+        (void) pthread_mutex_lock(&drain_lock);
+        drain_data = 0;
+        unit_test_log_drain_done();
+        (void) pthread_cond_broadcast(&drain_cond);
+    }
+    (void) pthread_mutex_unlock(&drain_lock);
+
+    return 0;
+}
+
+#endif // UNIT_TEST_LOG_ASYNC_THREAD
+#endif // UNIT_TEST_LOG_ASYNC_SIZE
+
+#if defined(UNIT_TEST_LOG) && defined(UNIT_TEST_LOG_BINARY)
+
+/**
+ * Write the header that starts every binary log and forget the file names
+ * written to any previous log.
+ */
+static void log_bin_header (void)
+{
+    uint16_t const endian = 1;
+    uint8_t header[sizeof(UNIT_TEST_LOG_MAGIC) + 1];
+
+    (void) memcpy(header, UNIT_TEST_LOG_MAGIC, sizeof(UNIT_TEST_LOG_MAGIC) - 1);
+    header[sizeof(UNIT_TEST_LOG_MAGIC) - 1] = UNIT_TEST_LOG_VERSION;
+    header[sizeof(UNIT_TEST_LOG_MAGIC)]     = *(uint8_t const *) &endian;
+    log_write(header, sizeof(header));
+
+    #ifdef LOG_FILE_NAMES
+    for (uint16_t index = 0; index < LOG_MAX_FILES; index++)
+    {
+        current_context->log_file_names[index] = 0;
+    }
+
+    current_context->log_file_next = 0;
+    #endif
+}
+
+#ifdef LOG_FILE_NAMES
+
+/**
+ * Look up the id of a source file name. The first time a name is seen it is
+ * given an id and a UNIT_TEST_EVT_FILE record is written. When all ids are
+ * used the oldest one is given to the new name.
+ *
+ *  @param[in] file_name  source file name, usually from __FILE__
+ *
+ *  @return id of the file name in the binary log
+ */
+static uint16_t log_bin_file_id (char const *file_name)
+{
+    unit_test_context_t *const context = current_context;
+    uint8_t  record[4 + UINT8_MAX];
+    size_t   len;
+    uint16_t file_id;
+
+    for (file_id = 0; file_id < LOG_MAX_FILES; file_id++)
+    {
+        if (context->log_file_names[file_id] == file_name)
+        {
+            return file_id;
+        }
+    }
+
+    file_id = context->log_file_next;
+    context->log_file_next = (uint16_t) ((file_id + 1) % LOG_MAX_FILES);
+    context->log_file_names[file_id] = file_name;
+
+    len = strlen(file_name);
+    if (len > UINT8_MAX)
+    {
+        // keep the end of the path, it is the most useful part
+        file_name += len - UINT8_MAX;
+        len = UINT8_MAX;
+    }
+
+    record[0] = (uint8_t) UNIT_TEST_EVT_FILE;
+    record[1] = (uint8_t) file_id;
+    record[2] = (uint8_t) (file_id >> 8);
+    record[3] = (uint8_t) len;
+    (void) memcpy(&record[4], file_name, len);
+    log_write(record, 4 + len);
+
+    return file_id;
+}
+
+#endif // LOG_FILE_NAMES
+
+/**
+ * Create the raw failure record for an assert in binary mode, this replaces
+ * snprintf of the failure message.
+ *
+ *  @param[out] msg       buffer to hold the record
+ *  @param[in]  event     UNIT_TEST_EVT_ASSERT_EQ or UNIT_TEST_EVT_ASSERT_NOT_EQ
+ *  @param[in]  type      type tag of the values
+ *  @param[in]  expected  the expected value
+ *  @param[in]  actual    the actual value, null if not logged
+ *  @param[in]  size      size of each value in bytes
+ */
+static void log_bin_values (char *msg, unit_test_event_t event,
+    unit_test_type_t type, void const *expected, void const *actual,
+    size_t size)
+{
+    uint8_t *record = (uint8_t *) msg;
+
+    record[0] = (uint8_t) event;
+    record[1] = (uint8_t) type;
+    record[2] = (uint8_t) (actual ? 2 * size : size);
+    (void) memcpy(&record[3], expected, size);
+
+    if (actual)
+    {
+        (void) memcpy(&record[3 + size], actual, size);
+    }
+}
+
+#ifdef UNIT_TEST_COMPACT_ASSERTS
+
+/**
+ * Create the raw failure record of a compact integer assert in binary mode.
+ * The widened values are written back with the width of their type, in
+ * target byte order.
+ *
+ *  @param[out] msg       buffer to hold the record
+ *  @param[in]  type      type tag of the values
+ *  @param[in]  equal     true if the values should have been equal
+ *  @param[in]  expected  the expected value, widened
+ *  @param[in]  actual    the actual value, widened
+ */
+static void log_bin_wide (char *msg, unit_test_type_t type, bool equal,
+    unit_test_uint_t expected, unit_test_uint_t actual)
+{
+    uint16_t const endian = 1;
+    bool const     little = (1 == *(uint8_t const *) &endian);
+    uint8_t const  width  = type_descs[type].width;
+    uint8_t       *record = (uint8_t *) msg;
+
+    record[0] = (uint8_t) (equal ? UNIT_TEST_EVT_ASSERT_EQ
+        : UNIT_TEST_EVT_ASSERT_NOT_EQ);
+    record[1] = (uint8_t) type;
+    record[2] = (uint8_t) (equal ? 2 * width : width);
+
+    for (uint8_t index = 0; index < width; index++)
+    {
+        uint8_t const pos = little ? index : (uint8_t) (width - 1 - index);
+
+        record[3 + pos]         = (uint8_t) (expected >> (8 * index));
+        record[3 + width + pos] = (uint8_t) (actual >> (8 * index));
+    }
+}
+
+#endif
+
+#endif // UNIT_TEST_LOG_BINARY
+
+#ifdef UNIT_TEST_REGISTRY
+/**
+ * Get the registered test cases, from the table set by
+ * unit_test_registry_set or else from the linker section.
+ *
+ * @param[out] cases the registered test cases
+ *
+ * @return number of test cases
+ */
+static size_t registry_cases (unit_test_case_t const * const **cases)
+{
+    size_t count = registry_count;
+
+    *cases = registry_table;
+
+    #ifdef UNIT_TEST_REGISTRY_SECTION
+    if (!*cases && __start_unit_test_cases)
+    {
+        *cases = __start_unit_test_cases;
+        count  = (size_t) (__stop_unit_test_cases - __start_unit_test_cases);
+    }
+    #endif
+
+    return count;
+}
+
+/**
+ * Check if a test case is the first selected case of its suite, a suite is
+ * run at its first selected case only.
+ *
+ * @param cases  the registered test cases
+ * @param first  index of the case to check
+ * @param filter comma separated list of patterns, NULL or "" for all cases
+ *
+ * @return true if the case is selected and no earlier case of the suite is
+ */
+static bool suite_first (unit_test_case_t const * const *cases, size_t first,
+    char const *filter)
+{
+    unit_test_suite_t const *suite = cases[first]->suite;
+
+    if (!filter_match(filter, cases[first]))
+    {
+        return false;
+    }
+
+    for (size_t index = 0; index < first; index++)
+    {
+        if ((cases[index]->suite == suite)
+            && filter_match(filter, cases[index]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Run a suite with its selected test cases in registry order.
+ *
+ * @param cases     the registered test cases
+ * @param count     number of registered test cases
+ * @param first     index of the first selected case of the suite
+ * @param filter    comma separated list of patterns, NULL or "" for all cases
+ * @param case_hook called with the index of each case before (true) and
+ *                  after (false) it runs, may be null
+ *
+ * @return number of test cases run
+ */
+static uint32_t suite_run (unit_test_case_t const * const *cases,
+    size_t count, size_t first, char const *filter,
+    void (*case_hook)(size_t, bool))
+{
+    uint32_t run;
+
+    test_suite_start(cases[first]->suite->name);
+    run = suite_cases(cases, count, first, cases[first]->suite, filter,
+        case_hook);
+    test_suite_end();
+
+    return run;
+}
+
+/**
+ * Run the selected test cases of a suite that has been started, in registry
+ * order.
+ *
+ * @param cases     the registered test cases
+ * @param count     number of registered test cases
+ * @param from      index to select the cases of the suite from
+ * @param suite     the suite
+ * @param filter    comma separated list of patterns, NULL or "" for all cases
+ * @param case_hook called with the index of each case before (true) and
+ *                  after (false) it runs, may be null
+ *
+ * @return number of test cases run
+ */
+static uint32_t suite_cases (unit_test_case_t const * const *cases,
+    size_t count, size_t from, unit_test_suite_t const *suite,
+    char const *filter, void (*case_hook)(size_t, bool))
+{
+    uint32_t run = 0;
+    #ifdef UNIT_TEST_FIXTURES
+    unit_test_fixture_t const *const fixture = suite->fixture;
+    bool                             built   = false;
+    #endif
+
+    for (size_t index = from; index < count; index++)
+    {
+        if ((cases[index]->suite == suite)
+            && filter_match(filter, cases[index]))
+        {
+            #ifdef UNIT_TEST_FAIL_FAST
+            if (fail_fast_stopped())
+            {
+                break;
+            }
+            #endif
+
+            #ifdef UNIT_TEST_FIXTURES
+            if (fixture)
+            {
+                built = fixture_build(fixture, built);
+            }
+            #endif
+
+            if (case_hook)
+            {
+                case_hook(index, true);
+            }
+
+            case_run(cases[index]);
+            run++;
+
+            if (case_hook)
+            {
+                case_hook(index, false);
+            }
+        }
+    }
+
+    #ifdef UNIT_TEST_FIXTURES
+    if (built && fixture->suite_teardown)
+    {
+        fixture->suite_teardown();
+    }
+    #endif
+
+    return run;
+}
+
+#ifdef UNIT_TEST_FIXTURES
+/**
+ * Get the shared state of a suite ready for its next test case. The fixture
+ * is built for the first case and built again after a case marked it dirty.
+ *
+ * @param fixture the fixture of the suite
+ * @param built   true if the fixture has been built for an earlier case
+ *
+ * @return true, the fixture is built
+ */
+static bool fixture_build (unit_test_fixture_t const *fixture, bool built)
+{
+    unit_test_context_t *const context = current_context;
+
+    if (built && context->fixture_dirty && fixture->suite_teardown)
+    {
+        fixture->suite_teardown();
+    }
+
+    if ((!built || context->fixture_dirty) && fixture->suite_setup)
+    {
+        fixture->suite_setup();
+    }
+
+    context->fixture_dirty = false;
+
+    return true;
+}
+#endif
+
+/**
+ * Run a registered test case in the suite that has been started.
+ *
+ * @param test the test case
+ */
+static void case_run (unit_test_case_t const *test)
+{
+    #ifdef UNIT_TEST_FIXTURES
+    unit_test_fixture_t const *const fixture = test->suite->fixture;
+    #endif
+
+    #ifdef UNIT_TEST_TIMEOUT
+    if (test->timeout)
+    {
+        test_case_timeout(test->timeout);
+    }
+    #endif
+
+    test_case_start(test->name);
+
+    #ifdef UNIT_TEST_FAIL_FAST
+    // a failed assert ends the case here
+    if (TEST_CASE_CHECKPOINT())
+    #endif
+    {
+        #ifdef UNIT_TEST_FIXTURES
+        if (fixture && fixture->case_setup)
+        {
+            fixture->case_setup();
+        }
+        #endif
+
+        #ifdef UNIT_TEST_PARAMS
+        if (test->params)
+        {
+            param_cases(test);
+        }
+        else
+        #endif
+        {
+            test->function();
+        }
+    }
+
+    #ifdef UNIT_TEST_FIXTURES
+    if (fixture && fixture->case_teardown)
+    {
+        fixture->case_teardown();
+    }
+    #endif
+
+    test_case_end();
+}
+
+#ifdef UNIT_TEST_PARAMS
+/**
+ * Run the body of a parameterized test case over its table. The elements
+ * that failed are summed up at the end.
+ *
+ * @param test the test case
+ */
+static void param_cases (unit_test_case_t const *test)
+{
+    unit_test_context_t *const context = current_context;
+    uint32_t                   failed  = 0;
+    uint32_t                   first   = 0;
+
+    context->param_active = true;
+
+    for (uint32_t index = 0; index < test->param_count; index++)
+    {
+        if (!param_run(test, index) && (0 == failed++))
+        {
+            first = index;
+        }
+
+        #ifdef UNIT_TEST_TIMEOUT
+        // a timeout ends the whole case
+        if (timeout_timer && context->case_timeout && !context->timeout_armed)
+        {
+            break;
+        }
+        #endif
+    }
+
+    context->param_active = false;
+
+    if (failed)
+    {
+        log_msg_u32(UNIT_TEST_EVT_PARAM_FAILS, failed);
+        log_msg_u32(UNIT_TEST_EVT_PARAM_COUNT, test->param_count);
+        log_msg_u32(UNIT_TEST_EVT_PARAM_FIRST, first);
+    }
+}
+
+/**
+ * Run the body of a parameterized test case with one element of its table.
+ * With fail fast the element has its own checkpoint, so a failed assert
+ * ends only this element.
+ *
+ * @param test  the test case
+ * @param index index of the element
+ *
+ * @return true if the element passed
+ */
+static bool param_run (unit_test_case_t const *test, uint32_t index)
+{
+    unit_test_context_t *const context = current_context;
+    bool const                 passed  = context->current_test_case_pass;
+    bool                       failed;
+
+    context->param_index            = index;
+    context->param_logged           = false;
+    context->current_test_case_pass = true;
+
+    #ifdef UNIT_TEST_FAIL_FAST
+    if (TEST_CASE_CHECKPOINT())
+    #endif
+    {
+        test->param_function((uint8_t const *) test->params
+            + ((size_t) index * test->param_size));
+    }
+
+    #ifdef UNIT_TEST_FAIL_FAST
+    // the checkpoint is gone with this frame
+    context->checkpoint_set = false;
+    #endif
+
+    failed = !context->current_test_case_pass;
+    context->current_test_case_pass = passed && !failed;
+
+    return !failed;
+}
+#endif
+
+/**
+ * Check if a test case is selected by a filter, and by the pass of a rerun
+ * of failed cases.
+ *
+ * @param filter comma separated list of patterns, NULL or "" for all cases
+ * @param test   test case to check
+ *
+ * @return true if the test case is selected
+ */
+static bool filter_match (char const *filter, unit_test_case_t const *test)
+{
+    #ifdef UNIT_TEST_RERUN
+    if (!rerun_selected(test))
+    {
+        return false;
+    }
+    #endif
+
+    if (!filter || !*filter)
+    {
+        return true;
+    }
+
+    while (*filter)
+    {
+        size_t len   = 0;
+        size_t slash = 0;
+        bool   match;
+
+        while (filter[len] && (filter[len] != ','))
+        {
+            if ((filter[len] == '/') && !slash)
+            {
+                slash = len + 1;
+            }
+            len++;
+        }
+
+        if (slash)
+        {
+            // "suite/case", both names must match
+            match = pattern_match(filter, slash - 1, test->suite->name)
+                && pattern_match(&filter[slash], len - slash, test->name);
+        }
+        else
+        {
+            match = pattern_match(filter, len, test->suite->name)
+                || pattern_match(filter, len, test->name);
+        }
+
+        if (match)
+        {
+            return true;
+        }
+
+        filter += (filter[len] == ',') ? len + 1 : len;
+    }
+
+    return false;
+}
+
+/**
+ * Match a name against a pattern where '*' matches any characters and '?'
+ * matches one character.
+ *
+ * @param pattern pattern, not null terminated
+ * @param len     length of the pattern
+ * @param name    null terminated name
+ *
+ * @return true if the whole name matches the pattern
+ */
+static bool pattern_match (char const *pattern, size_t len, char const *name)
+{
+    size_t      index = 0;
+    size_t      star  = len;
+    char const *mark  = name;
+
+    while (*name)
+    {
+        if ((index < len) && ((pattern[index] == '?')
+            || (pattern[index] == *name)))
+        {
+            index++;
+            name++;
+        }
+        else if ((index < len) && (pattern[index] == '*'))
+        {
+            // remember the star, first try it matching nothing
+            star = index++;
+            mark = name;
+        }
+        else if (star < len)
+        {
+            // let the last star match one more character
+            index = star + 1;
+            name  = ++mark;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while ((index < len) && (pattern[index] == '*'))
+    {
+        index++;
+    }
+
+    return index == len;
+}
+#endif
+
+#ifdef UNIT_TEST_RERUN
+/**
+ * Start a run of the cases in the order of the record, unless the run mode
+ * is UNIT_TEST_RUN_ALL or a pass is already running. The ranks of the cases
+ * are taken from the record once for the run, so the passes do not change
+ * as the cases pass or fail.
+ *
+ * @return true if the runner is to run the passes
+ */
+static bool rerun_start (void)
+{
+    if ((UNIT_TEST_RUN_ALL == rerun_mode) || rerun_passing)
+    {
+        return false;
+    }
+
+    for (uint16_t index = 0; index < rerun_record->count; index++)
+    {
+        unit_test_rerun_entry_t *const entry = &rerun_record->entries[index];
+        uint32_t                       rate  = 0;
+
+        if (entry->runs)
+        {
+            // in percent, rounded up so a case that has failed is above 0
+            rate = (((uint32_t) entry->fails * 100u) + entry->runs - 1u)
+                / entry->runs;
+            rate = (rate > 100u) ? 100u : rate;
+        }
+
+        entry->rank = (uint8_t) (entry->failed ? (RERUN_RANK_FAILED + rate)
+            : rate);
+    }
+
+    return true;
+}
+
+/**
+ * Go on to the next pass of a run in the order of the record, the pass of
+ * the highest rank below the rank of the last pass. The cases that are not
+ * in the record have rank 0 and are run in the last pass.
+ *
+ * @return false when there are no more passes to run
+ */
+static bool rerun_next (void)
+{
+    uint16_t next  = 0;
+    bool     found = false;
+    bool     done;
+
+    for (uint16_t index = 0; index < rerun_record->count; index++)
+    {
+        uint16_t const rank = rerun_record->entries[index].rank;
+
+        if ((!rerun_passing || (rank < rerun_rank))
+            && (!found || (rank > next)))
+        {
+            next  = rank;
+            found = true;
+        }
+    }
+
+    if (UNIT_TEST_RUN_FAILED_ONLY == rerun_mode)
+    {
+        done = !found || (next < RERUN_RANK_FAILED);
+    }
+    else
+    {
+        done = rerun_passing && (0 == rerun_rank);
+    }
+
+    rerun_passing = !done;
+    rerun_rank    = next;
+
+    return !done;
+}
+
+/**
+ * @param test test case to check
+ *
+ * @return true if no pass is running or the case has the rank of the pass
+ */
+static bool rerun_selected (unit_test_case_t const *test)
+{
+    uint32_t                       hash;
+    unit_test_rerun_entry_t const *entry;
+    uint16_t                       rank;
+
+    if (!rerun_passing)
+    {
+        return true;
+    }
+
+    hash = rerun_hash(test->suite->name, test->name);
+
+    #ifdef UNIT_TEST_PARALLEL
+    (void) pthread_mutex_lock(&rerun_lock);
+    #endif
+
+    entry = rerun_find(hash);
+    rank  = entry ? entry->rank : 0;
+
+    #ifdef UNIT_TEST_PARALLEL
+    (void) pthread_mutex_unlock(&rerun_lock);
+    #endif
+
+    return rank == rerun_rank;
+}
+
+/**
+ * Count a run of a test case in the record. A case that is not in the
+ * record is only added when it fails.
+ *
+ * @param suite_name name of the suite of the case, may be null
+ * @param case_name  name of the case, may be null
+ * @param failed     true if the case failed
+ */
+static void rerun_update (char const *suite_name, char const *case_name,
+    bool failed)
+{
+    uint32_t                 hash;
+    unit_test_rerun_entry_t *entry;
+
+    if (!suite_name || !case_name)
+    {
+        return;
+    }
+
+    hash = rerun_hash(suite_name, case_name);
+
+    #ifdef UNIT_TEST_PARALLEL
+    (void) pthread_mutex_lock(&rerun_lock);
+    #endif
+
+    entry = rerun_find(hash);
+
+    if (!entry && failed)
+    {
+        if (rerun_record->count < UNIT_TEST_RERUN_MAX_CASES)
+        {
+            entry = &rerun_record->entries[rerun_record->count++];
+        }
+        else
+        {
+            // take the place of the case that passed with the fewest fails
+            for (uint16_t index = 0; index < rerun_record->count; index++)
+            {
+                unit_test_rerun_entry_t *const other =
+                    &rerun_record->entries[index];
+
+                if (!other->failed && (!entry || (other->fails < entry->fails)))
+                {
+                    entry = other;
+                }
+            }
+        }
+
+        if (entry)
+        {
+            (void) memset(entry, 0, sizeof(*entry));
+            entry->hash = hash;
+        }
+    }
+
+    if (entry)
+    {
+        if (UINT16_MAX == entry->runs)
+        {
+            // the older runs count for half
+            entry->runs  = (uint16_t) (entry->runs / 2u);
+            entry->fails = (uint16_t) (entry->fails / 2u);
+        }
+
+        entry->runs++;
+        entry->fails  = (uint16_t) (entry->fails + (failed ? 1u : 0u));
+        entry->failed = failed ? 1u : 0u;
+
+        rerun_record->check = rerun_check(rerun_record);
+        #if defined(UNIT_TEST_LOG) && !defined(UNIT_TEST_LOG_NO_STDIO)
+        rerun_changed = true;
+        #endif
+    }
+
+    #ifdef UNIT_TEST_PARALLEL
+    (void) pthread_mutex_unlock(&rerun_lock);
+    #endif
+}
+
+/**
+ * @param hash hash of the names of a test case
+ *
+ * @return the case in the record, null if it is not in the record
+ */
+static unit_test_rerun_entry_t *rerun_find (uint32_t hash)
+{
+    for (uint16_t index = 0; index < rerun_record->count; index++)
+    {
+        if (rerun_record->entries[index].hash == hash)
+        {
+            return &rerun_record->entries[index];
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @param suite_name name of the suite of a test case
+ * @param case_name  name of the case
+ *
+ * @return FNV-1a hash of "suite/case"
+ */
+static uint32_t rerun_hash (char const *suite_name, char const *case_name)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*suite_name)
+    {
+        hash = (hash ^ (uint8_t) *suite_name++) * 16777619u;
+    }
+
+    hash = (hash ^ (uint8_t) '/') * 16777619u;
+
+    while (*case_name)
+    {
+        hash = (hash ^ (uint8_t) *case_name++) * 16777619u;
+    }
+
+    return hash;
+}
+
+/**
+ * @param record record of the failed test cases, count must be valid
+ *
+ * @return check value of the cases of the record, 0 for no cases
+ */
+static uint32_t rerun_check (unit_test_rerun_record_t const *record)
+{
+    uint32_t check = record->count;
+
+    for (uint16_t index = 0; index < record->count; index++)
+    {
+        unit_test_rerun_entry_t const *const entry = &record->entries[index];
+
+        check = (check ^ entry->hash) * 16777619u;
+        check = (check ^ (((uint32_t) entry->runs << 16) | entry->fails))
+            * 16777619u;
+        check = (check ^ entry->failed) * 16777619u;
+    }
+
+    return check;
+}
+
+#if defined(UNIT_TEST_LOG) && !defined(UNIT_TEST_LOG_NO_STDIO)
+/**
+ * Load the record of the failed test cases kept next to a log file. If there
+ * is no rerun file, the record is not changed.
+ *
+ * @param log_file_name name of the log file
+ */
+static void rerun_load (char const *log_file_name)
+{
+    static char const suffix[] = ".rerun";
+    size_t const      len      = strlen(log_file_name);
+    char              line[64];
+    FILE             *file;
+
+    // write out the record of an earlier log file
+    rerun_save();
+
+    rerun_file_name = malloc(len + sizeof(suffix));
+    if (!rerun_file_name)
+    {
+        return;
+    }
+
+    (void) memcpy(rerun_file_name, log_file_name, len);
+    (void) memcpy(&rerun_file_name[len], suffix, sizeof(suffix));
+
+    file = fopen(rerun_file_name, "r");
+    if (!file)
+    {
+        return;
+    }
+
+    (void) memset(rerun_record, 0, sizeof(*rerun_record));
+    rerun_record->magic = RERUN_MAGIC;
+
+    while ((rerun_record->count < UNIT_TEST_RERUN_MAX_CASES)
+        && fgets(line, sizeof(line), file))
+    {
+        unsigned long hash;
+        unsigned long runs;
+        unsigned long fails;
+        unsigned long failed;
+
+        if ((4 == sscanf(line, "%lx %lu %lu %lu", &hash, &runs, &fails,
+            &failed)) && (runs <= UINT16_MAX) && (fails <= runs))
+        {
+            unit_test_rerun_entry_t *const entry =
+                &rerun_record->entries[rerun_record->count++];
+
+            entry->hash   = (uint32_t) hash;
+            entry->runs   = (uint16_t) runs;
+            entry->fails  = (uint16_t) fails;
+            entry->failed = failed ? 1u : 0u;
+        }
+    }
+
+    (void) fclose(file);
+    rerun_record->check = rerun_check(rerun_record);
+    rerun_changed       = false;
+}
+
+/**
+ * Write the rerun file if the record has changed since it was loaded.
+ */
+static void rerun_save (void)
+{
+    if (rerun_file_name && rerun_changed)
+    {
+        FILE *const file = fopen(rerun_file_name, "w");
+
+        if (file)
+        {
+            for (uint16_t index = 0; index < rerun_record->count; index++)
+            {
+                unit_test_rerun_entry_t const *const entry =
+                    &rerun_record->entries[index];
+
+                (void) fprintf(file, "%08lx %u %u %u\n",
+                    (unsigned long) entry->hash, (unsigned) entry->runs,
+                    (unsigned) entry->fails, (unsigned) entry->failed);
+            }
+
+            (void) fclose(file);
+        }
+    }
+
+    free(rerun_file_name);
+    rerun_file_name = 0;
+    rerun_changed   = false;
+}
+#endif
+#endif
+
+#if defined(UNIT_TEST_PARALLEL) || defined(UNIT_TEST_FORK)
+/**
+ * Collect the suites selected by a filter and the shard, in registry order.
+ *
+ * @param[out] suites the selected suites
+ * @param[in]  cases  the registered test cases
+ * @param[in]  count  number of registered test cases
+ * @param[in]  filter comma separated list of patterns, NULL or "" for all
+ * @param[in]  number number of the last test suite logged by the caller
+ *
+ * @return number of suites selected
+ */
+static size_t run_suites_collect (run_suite_t *suites,
+    unit_test_case_t const * const *cases, size_t count, char const *filter,
+    uint16_t number)
+{
+    size_t selected = 0;
+    size_t shard    = 0;
+
+    for (size_t first = 0; first < count; first++)
+    {
+        if (suite_first(cases, first, filter)
+            && (shard_index == (shard++ % shard_count)))
+        {
+            suites[selected].first  = first;
+            suites[selected].number = (uint16_t) (number + selected + 1);
+            selected++;
+        }
+    }
+
+    return selected;
+}
+
+/**
+ * @param workers number of workers asked for, 0 for the default
+ *
+ * @return number of workers to use, one per online processor by default
+ */
+static unsigned run_workers (unsigned workers)
+{
+    if (0 == workers)
+    {
+        long const online = sysconf(_SC_NPROCESSORS_ONLN);
+
+        workers = (online > 0) ? (unsigned) online : 1u;
+    }
+
+    return workers;
+}
+
+/**
+ * Append log output to the buffer of a suite.
+ *
+ * @param suite the suite
+ * @param data  bytes to append
+ * @param len   number of bytes
+ *
+ * @return false if there is no memory for the bytes
+ */
+static bool run_suite_append (run_suite_t *suite, uint8_t const *data,
+    size_t len)
+{
+    if ((suite->output_size - suite->output_len) < len)
+    {
+        size_t   size = suite->output_size ? suite->output_size : 1024;
+        uint8_t *output;
+
+        #ifdef UNIT_TEST_ALLOC
+        bool const paused = current_context->alloc_paused;
+        #endif
+
+        while ((size - suite->output_len) < len)
+        {
+            size *= 2;
+        }
+
+        #ifdef UNIT_TEST_ALLOC
+        // the output buffer is not counted against the test case
+        current_context->alloc_paused = true;
+        #endif
+
+        output = realloc(suite->output, size);
+
+        #ifdef UNIT_TEST_ALLOC
+        current_context->alloc_paused = paused;
+        #endif
+
+        if (!output)
+        {
+            return false;
+        }
+
+        suite->output      = output;
+        suite->output_size = size;
+    }
+
+    (void) memcpy(&suite->output[suite->output_len], data, len);
+    suite->output_len += len;
+
+    return true;
+}
+#endif
+
+#ifdef UNIT_TEST_PARALLEL
+/**
+ * Worker thread of the parallel runner, runs suites until there are none
+ * left in any queue. The suites are run in the context of the worker.
+ *
+ * @param arg the worker
+ *
+ * @return null
+ */
+static void *parallel_worker (void *arg)
+{
+    parallel_worker_t *const   worker   = arg;
+    parallel_run_t *const      run      = worker->run;
+    unit_test_context_t *const previous = unit_test_context_set(
+        &worker->context);
+    size_t index;
+
+    while (parallel_next(worker, &index))
+    {
+        run_suite_t *const suite = &run->suites[index];
+
+        worker->suite = suite;
+
+        // test_suite_start logs the next number
+        worker->context.test_suite_num = (uint16_t) (suite->number - 1);
+
+        #ifdef LOG_FILE_NAMES
+        // the output of each suite names the files it refers to
+        for (uint16_t name = 0; name < LOG_MAX_FILES; name++)
+        {
+            worker->context.log_file_names[name] = 0;
+        }
+        #endif
+
+        worker->cases += suite_run(run->cases, run->count, suite->first,
+            run->filter, 0);
+        parallel_output(run, suite);
+    }
+
+    (void) unit_test_context_set(previous);
+
+    return 0;
+}
+
+/**
+ * Get the next suite for a worker, from its own queue or else stolen from
+ * the queue of another worker.
+ *
+ * @param[in]  worker the worker
+ * @param[out] index  index of the suite
+ *
+ * @return false if there are no suites left
+ */
+static bool parallel_next (parallel_worker_t *worker, size_t *index)
+{
+    parallel_run_t *const run = worker->run;
+
+    if (parallel_take(&worker->queue, true, index))
+    {
+        return true;
+    }
+
+    for (size_t offset = 1; offset < run->worker_count; offset++)
+    {
+        parallel_worker_t *const victim =
+            &run->workers[(worker->index + offset) % run->worker_count];
+
+        if (parallel_take(&victim->queue, false, index))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Take a suite from a queue.
+ *
+ * @param[in]  queue the queue
+ * @param[in]  own   true to take from the head, false to steal from the tail
+ * @param[out] index index of the suite
+ *
+ * @return true if a suite was taken
+ */
+static bool parallel_take (parallel_queue_t *queue, bool own, size_t *index)
+{
+    bool taken = false;
+
+    (void) pthread_mutex_lock(&queue->lock);
+
+    if (queue->head < queue->tail)
+    {
+        *index = own ? queue->slots[queue->head++]
+                     : queue->slots[--queue->tail];
+        taken  = true;
+    }
+
+    (void) pthread_mutex_unlock(&queue->lock);
+
+    return taken;
+}
+
+/**
+ * Mark a suite as done and write the output of the done suites to the sink
+ * of the caller, in registry order.
+ *
+ * @param run   the parallel run
+ * @param suite the suite that is done
+ */
+static void parallel_output (parallel_run_t *run, run_suite_t *suite)
+{
+    (void) pthread_mutex_lock(&run->output_lock);
+
+    suite->done = true;
+
+    while ((run->next_output < run->suite_count)
+        && run->suites[run->next_output].done)
+    {
+        run_suite_t *const next = &run->suites[run->next_output++];
+
+        if (run->sink && (next->output_len > 0))
+        {
+            run->sink->write(run->sink->context, next->output,
+                next->output_len);
+        }
+
+        free(next->output);
+        next->output = 0;
+    }
+
+    (void) pthread_mutex_unlock(&run->output_lock);
+}
+
+/**
+ * Sink of a worker, appends the log output to the buffer of the suite being
+ * run.
+ */
+static void parallel_sink_write (void *context, uint8_t const *data,
+    size_t len)
+{
+    parallel_worker_t *const worker = context;
+    run_suite_t *const  suite  = worker->suite;
+
+    if (!run_suite_append(suite, data, len))
+    {
+        // out of memory, write the output through rather than lose it
+        (void) pthread_mutex_lock(&worker->run->output_lock);
+        if (worker->run->sink)
+        {
+            worker->run->sink->write(worker->run->sink->context, data, len);
+        }
+        (void) pthread_mutex_unlock(&worker->run->output_lock);
+    }
+}
+#endif
+
+#ifdef UNIT_TEST_FORK
+/**
+ * Fork a worker process to run the suites of a worker, starting with the
+ * suite at worker->next.
+ *
+ * @param run    the forked run
+ * @param worker the worker
+ *
+ * @return false if the worker process could not be started
+ */
+static bool fork_start (fork_run_t *run, fork_worker_t *worker)
+{
+    int fds[2];
+
+    worker->fd           = -1;
+    worker->suite_active = false;
+    worker->case_active  = false;
+    worker->input_len    = 0;
+
+    if (pipe(fds) < 0)
+    {
+        return false;
+    }
+
+    // anything buffered would be written again by the worker
+    (void) fflush(0);
+
+    worker->pid = fork();
+    if (worker->pid < 0)
+    {
+        (void) close(fds[0]);
+        (void) close(fds[1]);
+
+        return false;
+    }
+
+    if (0 == worker->pid)
+    {
+        (void) close(fds[0]);
+        fork_pipe = fds[1];
+        fork_child(run, worker);
+    }
+
+    (void) close(fds[1]);
+    worker->fd = fds[0];
+
+    return true;
+}
+
+/**
+ * Run the suites of a worker in the worker process and exit. The log output
+ * and the progress of the cases are sent to the parent as frames.
+ *
+ * @param run    the forked run, as copied into the worker process
+ * @param worker the worker, its next suite is the first to run
+ */
+static void fork_child (fork_run_t *run, fork_worker_t const *worker)
+{
+    unit_test_sink_t const sink = { fork_sink_write, 0, 0 };
+    unit_test_context_t    context;
+    size_t                 position = worker->next;
+    size_t                 resume   = worker->resume;
+
+    unit_test_context_init(&context, &sink);
+    (void) unit_test_context_set(&context);
+
+    for (; position < run->suite_count; position += run->worker_count)
+    {
+        run_suite_t const *const suite = &run->suites[position];
+
+        fork_frame(FORK_FRAME_SUITE, (uint32_t) position, 0, 0);
+
+        // test_suite_start logs the next number
+        context.test_suite_num = (uint16_t) (suite->number - 1);
+
+        #ifdef LOG_FILE_NAMES
+        // the output of each suite names the files it refers to
+        for (uint16_t name = 0; name < LOG_MAX_FILES; name++)
+        {
+            context.log_file_names[name] = 0;
+        }
+        #endif
+
+        if (resume)
+        {
+            // the suite was started by the worker that crashed
+            context.test_suite_active = true;
+            #ifdef UNIT_TEST_TIMESTAMPS
+            context.suite_start       = worker->suite_start;
+            #endif
+            context.suite_name        = run->cases[suite->first]->suite->name;
+            context.suite_logged      = LOG_LEVEL(UNIT_TEST_VERBOSITY_SUITES);
+            (void) suite_cases(run->cases, run->count, resume,
+                run->cases[suite->first]->suite, run->filter, fork_case_hook);
+            test_suite_end();
+            resume = 0;
+        }
+        else
+        {
+            (void) suite_run(run->cases, run->count, suite->first,
+                run->filter, fork_case_hook);
+        }
+
+        fork_stats();
+        fork_frame(FORK_FRAME_SUITE_END, context.failed_assert, 0, 0);
+    }
+
+    // write out anything the test cases have printed
+    (void) fflush(0);
+    _exit(0);
+}
+
+/**
+ * Run the suites of a worker in the calling process, this is used when a
+ * worker process cannot be started. The suites are not isolated.
+ *
+ * @param run    the forked run
+ * @param worker the worker
+ */
+static void fork_inline (fork_run_t *run, fork_worker_t *worker)
+{
+    unit_test_sink_t const     sink = { fork_suite_write, 0, run };
+    unit_test_context_t        context;
+    unit_test_context_t *const previous = current_context;
+
+    unit_test_context_init(&context, &sink);
+    (void) unit_test_context_set(&context);
+
+    for (; worker->next < run->suite_count;
+        worker->next += run->worker_count)
+    {
+        run_suite_t *const suite = &run->suites[worker->next];
+
+        run->current = suite;
+        context.test_suite_num = (uint16_t) (suite->number - 1);
+
+        #ifdef LOG_FILE_NAMES
+        for (uint16_t name = 0; name < LOG_MAX_FILES; name++)
+        {
+            context.log_file_names[name] = 0;
+        }
+        #endif
+
+        run->cases_run += suite_run(run->cases, run->count, suite->first,
+            run->filter, 0);
+        fork_done(run, worker->next);
+    }
+
+    (void) unit_test_context_set(previous);
+    stats_add(&run->stats, &context.stats);
+
+    if (context.failed_assert)
+    {
+        run->failed = true;
+    }
+}
+
+/**
+ * Read the frames a worker process has sent. At the end of the pipe the
+ * worker has exited.
+ *
+ * @param run    the forked run
+ * @param worker the worker
+ */
+static void fork_read (fork_run_t *run, fork_worker_t *worker)
+{
+    size_t  size = worker->input_size;
+    ssize_t got;
+
+    if ((size - worker->input_len) < 4096)
+    {
+        uint8_t *const input = realloc(worker->input, size + 4096);
+
+        if (input)
+        {
+            worker->input      = input;
+            worker->input_size = size + 4096;
+        }
+    }
+
+    if (worker->input_size == worker->input_len)
+    {
+        // out of memory, the frames cannot be read
+        fork_exited(run, worker);
+        return;
+    }
+
+    got = read(worker->fd, &worker->input[worker->input_len],
+        worker->input_size - worker->input_len);
+
+    if (got > 0)
+    {
+        worker->input_len += (size_t) got;
+        fork_frames(run, worker);
+    }
+    else if ((0 == got) || (EINTR != errno))
+    {
+        fork_exited(run, worker);
+    }
+}
+
+/**
+ * Handle the whole frames read from a worker process.
+ *
+ * @param run    the forked run
+ * @param worker the worker
+ */
+static void fork_frames (fork_run_t *run, fork_worker_t *worker)
+{
+    size_t pos = 0;
+
+    while ((worker->input_len - pos) >= FORK_FRAME_LEN)
+    {
+        uint8_t const *const frame = &worker->input[pos];
+        uint32_t             value;
+
+        (void) memcpy(&value, &frame[1], sizeof(value));
+
+        if ((FORK_FRAME_LOG == frame[0]) || (FORK_FRAME_STATS == frame[0]))
+        {
+            if ((worker->input_len - pos - FORK_FRAME_LEN) < value)
+            {
+                // the rest of the frame has not been read yet
+                break;
+            }
+
+            if (FORK_FRAME_LOG == frame[0])
+            {
+                fork_append(run, &run->suites[worker->suite],
+                    &frame[FORK_FRAME_LEN], value);
+            }
+            else if (sizeof(unit_test_stats_t) == value)
+            {
+                unit_test_stats_t stats;
+
+                (void) memcpy(&stats, &frame[FORK_FRAME_LEN], sizeof(stats));
+                stats_add(&run->stats, &stats);
+            }
+
+            pos += FORK_FRAME_LEN + value;
+            continue;
+        }
+
+        switch (frame[0])
+        {
+            case FORK_FRAME_SUITE:
+                worker->suite        = value;
+                worker->suite_active = true;
+                worker->next         = value + run->worker_count;
+                worker->resume       = 0;
+                #ifdef UNIT_TEST_TIMESTAMPS
+                worker->suite_start  = timestamp_now();
+                #endif
+                break;
+            case FORK_FRAME_CASE:
+                worker->test_case   = value;
+                worker->case_active = true;
+                run->cases_run++;
+                #ifdef UNIT_TEST_TIMESTAMPS
+                worker->case_start  = timestamp_now();
+                #endif
+                break;
+            case FORK_FRAME_CASE_END:
+                worker->case_active = false;
+                #ifdef UNIT_TEST_RERUN
+                // the record of the worker process is lost when it exits
+                rerun_update(run->cases[worker->test_case]->suite->name,
+                    run->cases[worker->test_case]->name, value);
+                #endif
+                break;
+            case FORK_FRAME_SUITE_END:
+                worker->suite_active = false;
+                run->failed = run->failed || value;
+                fork_done(run, worker->suite);
+                break;
+            default:
+                break;
+        }
+
+        pos += FORK_FRAME_LEN;
+    }
+
+    worker->input_len -= pos;
+    (void) memmove(worker->input, &worker->input[pos], worker->input_len);
+}
+
+/**
+ * A worker process has exited. If it was running a suite, the exit is logged
+ * as a failure and a new worker process is started for the rest of the
+ * suites of the worker. If the worker was running a test case, the new
+ * worker resumes the suite at the next case, otherwise the suite is ended.
+ *
+ * @param run    the forked run
+ * @param worker the worker
+ */
+static void fork_exited (fork_run_t *run, fork_worker_t *worker)
+{
+    int status = 0;
+
+    (void) close(worker->fd);
+    worker->fd = -1;
+
+    while ((waitpid(worker->pid, &status, 0) < 0) && (EINTR == errno))
+    {
+        // interrupted, wait again
+    }
+
+    free(worker->input);
+    worker->input      = 0;
+    worker->input_len  = 0;
+    worker->input_size = 0;
+
+    if (worker->suite_active)
+    {
+        run->current = &run->suites[worker->suite];
+        fork_report(run, status, worker);
+
+        if (worker->case_active)
+        {
+            worker->next   = worker->suite;
+            worker->resume = worker->test_case + 1;
+        }
+        else
+        {
+            fork_done(run, worker->suite);
+        }
+    }
+
+    if (worker->next < run->suite_count)
+    {
+        if (!fork_start(run, worker))
+        {
+            fork_inline(run, worker);
+        }
     }
 }
 
 /**
- *  Call this to indicate a test suite has completed. The framework checks to
- *  see if a test suite is active and logs the appropriate message.
+ * Log the exit of a worker process that was running run->current. In a test
+ * case the case is ended as failed, the suite is resumed by the next worker.
+ * Otherwise the suite is ended.
+ *
+ * @param run    the forked run
+ * @param status wait status of the worker
+ * @param worker the worker
  */
-void test_suite_end (void)
+static void fork_report (fork_run_t *run, int status,
+    fork_worker_t const *worker)
 {
-    if (test_suite_active)
+    unit_test_sink_t const     sink = { fork_suite_write, 0, run };
+    unit_test_context_t        report;
+    unit_test_context_t *const previous = current_context;
+    bool const                 in_case  = worker->case_active;
+
+    unit_test_context_init(&report, &sink);
+    (void) unit_test_context_set(&report);
+
+    // the worker had started the suite, and maybe a test case
+    report.test_suite_active      = true;
+    report.test_case_active       = in_case;
+    report.current_test_case_pass = false;
+    report.failed_assert          = true;
+    #ifdef UNIT_TEST_TIMESTAMPS
+    report.suite_start            = worker->suite_start;
+    report.case_start             = worker->case_start;
+    #endif
+
+    // the worker logged the names the log level did not hold back
+    report.test_suite_num = run->suites[worker->suite].number;
+    report.suite_name     = run->cases[run->suites[worker->suite].first]
+        ->suite->name;
+    report.case_name      = in_case ? run->cases[worker->test_case]->name : 0;
+    report.suite_logged   = LOG_LEVEL(UNIT_TEST_VERBOSITY_SUITES);
+    report.case_logged    = LOG_LEVEL(UNIT_TEST_VERBOSITY_CASES);
+    log_held_back(&report);
+
+    if (WIFSIGNALED(status))
     {
-        log_msg("\n\nTest Suite Complete\n");
-        test_suite_active = false;
+        log_msg_num(UNIT_TEST_EVT_CASE_SIGNAL, (uint16_t) WTERMSIG(status));
     }
     else
     {
-        // A test suite is not active: Bad use of API!
-        log_msg("\n\nERROR: A test suite is not active.");
-        log_msg("\nCall 'test_suite_start' first.\n");
+        log_msg_num(UNIT_TEST_EVT_CASE_EXIT, (uint16_t) WEXITSTATUS(status));
     }
-}
 
-/**
- *  Call this to indicate the start of a new test case. If any of the asserts
- *  fail for a test case, then the entire test case fails.
- *
- *  @attention - Remember to call test_case_end when you are done with a
- *  test case.
- *
- *  @param test_case_name - string containing the name of the test case.
- *  In most cases this would contain the name of the function being tested.
- */
-void test_case_start (char const *test_case_name)
-{
-    if (!test_case_active)
+    if (in_case)
     {
-        log_msg_str("\n\nTest Case: %s", test_case_name);
-
-        // reset the flag indicating the test case result
-        current_test_case_pass = true;
-
-        // set the flag indicating that a test case is active
-        test_case_active = true;
+        test_case_end();
     }
     else
     {
-        // A test case is already active: Bad use of API!
-        log_msg("\n\nERROR: A test case is already active.");
-        log_msg_str("\nCannot execute \"%s\"", test_case_name);
-        log_msg("\nOnly one test case can be executed at a time.\n");
+        test_suite_end();
     }
+
+    (void) unit_test_context_set(previous);
+    stats_add(&run->stats, &report.stats);
+    run->failed = true;
 }
 
 /**
- *  Call this to indicate a test case has completed. The framework checks that
- *  a test case passed all assertions and logs the appropriate message.
+ * Mark a suite as done and write the output of the done suites to the sink
+ * of the caller, in registry order.
+ *
+ * @param run      the forked run
+ * @param position position of the suite that is done
  */
-void test_case_end (void)
+static void fork_done (fork_run_t *run, size_t position)
 {
-    if (test_case_active)
+    run->suites[position].done = true;
+
+    while ((run->next_output < run->suite_count)
+        && run->suites[run->next_output].done)
     {
-        if (current_test_case_pass)
-        {
-            log_msg("\nTest Case Passed");
-        }
-        else
+        run_suite_t *const next = &run->suites[run->next_output++];
+
+        if (run->sink && (next->output_len > 0))
         {
-            log_msg("\nTest Case Failed");
+            run->sink->write(run->sink->context, next->output,
+                next->output_len);
         }
 
-        test_case_active = false;
-    }
-    else
-    {
-        // A test case is not active: Bad use of API!
-        log_msg("\n\nERROR: A test case is not active.");
-        log_msg("\nCall the 'test_case_start' function first.\n");
+        free(next->output);
+        next->output = 0;
     }
 }
 
 /**
- * @return true if all tests have passed in a run, false otherwise.
+ * Append log output to the buffer of a suite, or write it through to the
+ * sink of the caller if there is no memory for it.
  */
-bool unit_test_all_success (void)
+static void fork_append (fork_run_t *run, run_suite_t *suite,
+    uint8_t const *data, size_t len)
 {
-    return !failed_assert;
+    if (!run_suite_append(suite, data, len) && run->sink)
+    {
+        run->sink->write(run->sink->context, data, len);
+    }
 }
 
 /**
- *  Asserts if the bool values ARE NOT equal.
- *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
+ * Sink used in the calling process, appends the log output to the buffer of
+ * run->current.
  */
-void assert_bool_eq (bool expected, bool actual,
-        char const *file, int line_num)
+static void fork_suite_write (void *context, uint8_t const *data,
+    size_t len)
 {
-    if (expected != actual)
-    {
-        // create an error message with details
-        EQ_ERR_MSG_CREATE(error_msg, " expected: %u, got: %u",
-            expected, actual);
+    fork_run_t *const run = context;
 
-        assert_failed(file, line_num, error_msg);
-    }
+    fork_append(run, run->current, data, len);
 }
 
 /**
- *  Asserts if the bool values ARE equal.
- *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
+ * Case hook of the worker process, tells the parent when a test case starts
+ * and ends, and if it failed.
  */
-void assert_bool_not_eq (bool expected, bool actual,
-        char const *file, int line_num)
+static void fork_case_hook (size_t index, bool start)
 {
-   if (expected == actual)
+    if (!start)
     {
-        // create an error message with details
-        NOT_EQ_ERR_MSG_CREATE(error_msg, " should not be: %u", expected);
+        // what the case counted reaches the parent before a later crash
+        fork_stats();
+    }
 
-        assert_failed(file, line_num, error_msg);
+    if (start)
+    {
+        fork_frame(FORK_FRAME_CASE, (uint32_t) index, 0, 0);
+    }
+    else
+    {
+        fork_frame(FORK_FRAME_CASE_END,
+            !current_context->current_test_case_pass, 0, 0);
     }
 }
 
 /**
- *  Asserts if the int8_t ARE NOT equal.
- *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
- *
+ * Send the stats counted in the worker process since the last time to the
+ * parent.
  */
-void assert_int8_eq (int8_t expected, int8_t actual,
-        char const *file, int line_num)
+static void fork_stats (void)
 {
-    if (expected != actual)
-    {
-        // create an error message with details
-        EQ_ERR_MSG_CREATE(error_msg, " expected: %d, got: %d",
-            expected, actual);
+    unit_test_context_t *const context = current_context;
 
-        assert_failed(file, line_num, error_msg);
-    }
+    stats_fold(context);
+    fork_frame(FORK_FRAME_STATS, (uint32_t) sizeof(context->stats),
+        (uint8_t const *) &context->stats, sizeof(context->stats));
+    (void) memset(&context->stats, 0, sizeof(context->stats));
 }
 
 /**
- *  Asserts if the int8_t ARE equal.
+ * Send a frame to the parent process.
  *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
+ * @param type  type of the frame
+ * @param value value of the frame
+ * @param data  log output of a FORK_FRAME_LOG frame, null otherwise
+ * @param len   number of bytes of log output
  */
-void assert_int8_not_eq (int8_t expected, int8_t actual,
-        char const *file, int line_num)
+static void fork_frame (fork_frame_t type, uint32_t value,
+    uint8_t const *data, size_t len)
 {
-    if (expected == actual)
-    {
-        // create an error message with details
-        NOT_EQ_ERR_MSG_CREATE(error_msg, " should not be: %d", expected);
+    uint8_t frame[FORK_FRAME_LEN];
 
-        assert_failed(file, line_num, error_msg);
-    }
+    frame[0] = (uint8_t) type;
+    (void) memcpy(&frame[1], &value, sizeof(value));
+    fork_pipe_write(frame, sizeof(frame));
+    fork_pipe_write(data, len);
 }
 
 /**
- *  Asserts if the uint8_t ARE NOT equal.
- *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
+ * Write bytes to the pipe of the worker process. The log output is written
+ * through, so what was logged before a crash reaches the parent.
  */
-void assert_uint8_eq (uint8_t expected, uint8_t actual,
-        char const *file, int line_num)
+static void fork_pipe_write (uint8_t const *data, size_t len)
 {
-    if (expected != actual)
+    while (len > 0)
     {
-        // create an error message with details
-        EQ_ERR_MSG_CREATE(error_msg, " expected: %u, got: %u",
-                expected, actual);
+        ssize_t const written = write(fork_pipe, data, len);
 
-        assert_failed(file, line_num, error_msg);
+        if (written > 0)
+        {
+            data += written;
+            len  -= (size_t) written;
+        }
+        else if ((written < 0) && (EINTR != errno))
+        {
+            // the parent has gone, there is no one to report to
+            _exit(1);
+        }
     }
 }
 
 /**
- *  Asserts if the uint8_t ARE equal.
- *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
+ * Sink of the worker process, sends the log output to the parent.
  */
-void assert_uint8_not_eq (uint8_t expected, uint8_t actual,
-        char const *file, int line_num)
+static void fork_sink_write (void *context, uint8_t const *data, size_t len)
 {
-    if (expected == actual)
+    (void) context;
+
+    while (len > 0)
     {
-        // create an error message with details
-        NOT_EQ_ERR_MSG_CREATE(error_msg, " should not be: %u", expected);
+        uint32_t const chunk = (len > UINT32_MAX) ? UINT32_MAX
+            : (uint32_t) len;
 
-        assert_failed(file, line_num, error_msg);
+        fork_frame(FORK_FRAME_LOG, chunk, data, chunk);
+        data += chunk;
+        len  -= chunk;
     }
 }
+#endif
 
+#ifdef UNIT_TEST_BENCH
 /**
- *  Asserts if the int16_t ARE NOT equal.
+ * Add the ticks of a timed run to the statistics of a benchmark.
  *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
+ * @param bench the benchmark
+ * @param ticks elapsed ticks of the run
  */
-void assert_int16_eq (int16_t expected, int16_t actual,
-        char const *file, int line_num)
+static void bench_sample (unit_test_bench_t *bench, uint32_t ticks)
 {
-    if (expected != actual)
+    if (ticks < bench->min)
     {
-        // create an error message with details
-        EQ_ERR_MSG_CREATE(error_msg, " expected: %d, got: %d",
-                expected, actual);
+        bench->min = ticks;
+    }
+
+    if (ticks > bench->max)
+    {
+        bench->max = ticks;
+    }
+
+    bench->sum += ticks;
 
-        assert_failed(file, line_num, error_msg);
+    if (bench->samples_len < UNIT_TEST_BENCH_MAX_SAMPLES)
+    {
+        bench->samples[bench->samples_len++] = ticks;
     }
 }
 
 /**
- *  Asserts if the int16_t ARE equal.
+ * Work out the median and mean of a benchmark that has finished and log the
+ * statistics.
  *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
+ * @param bench the benchmark
  */
-void assert_int16_not_eq (int16_t expected, int16_t actual,
-        char const *file, int line_num)
+static void bench_end (unit_test_bench_t *bench)
 {
-    if (expected == actual)
+    uint16_t const len = bench->samples_len;
+
+    if (0 == len)
     {
-        // create an error message with details
-        NOT_EQ_ERR_MSG_CREATE(error_msg, " should not be: %d", expected);
+        // nothing was timed
+        bench->min = 0;
+        return;
+    }
+
+    // insertion sort, there are only a few samples
+    for (uint16_t index = 1; index < len; index++)
+    {
+        uint32_t const ticks = bench->samples[index];
+        uint16_t       hole  = index;
+
+        while ((hole > 0) && (bench->samples[hole - 1] > ticks))
+        {
+            bench->samples[hole] = bench->samples[hole - 1];
+            hole--;
+        }
 
-        assert_failed(file, line_num, error_msg);
+        bench->samples[hole] = ticks;
     }
-}
 
-/**
- *  Asserts if the uint16_t ARE NOT equal.
- *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
- */
-void assert_uint16_eq (uint16_t expected, uint16_t actual,
-        char const *file, int line_num)
-{
-    if (expected != actual)
+    if (len & 1u)
     {
-        // create an error message with details
-        EQ_ERR_MSG_CREATE(error_msg, " expected: %u, got: %u",
-                expected, actual);
+        bench->median = bench->samples[len / 2];
+    }
+    else
+    {
+        uint32_t const low  = bench->samples[(len / 2) - 1];
+        uint32_t const high = bench->samples[len / 2];
+
+        bench->median = low + ((high - low) / 2);
+    }
 
-        assert_failed(file, line_num, error_msg);
+    bench->mean = (uint32_t) (bench->sum / bench->iterations);
+
+    if (timestamp_source && current_context->case_logged)
+    {
+        log_msg_u32(UNIT_TEST_EVT_BENCH_ITERATIONS, bench->iterations);
+        log_msg_u32(UNIT_TEST_EVT_BENCH_MIN,        bench->min);
+        log_msg_u32(UNIT_TEST_EVT_BENCH_MEDIAN,     bench->median);
+        log_msg_u32(UNIT_TEST_EVT_BENCH_MAX,        bench->max);
+        log_msg_u32(UNIT_TEST_EVT_BENCH_MEAN,       bench->mean);
     }
 }
+#endif
 
+#ifdef UNIT_TEST_BASELINE
 /**
- *  Asserts if the uint16_t ARE equal.
+ * Load the baseline kept next to a log file. A missing baseline file is an
+ * empty baseline.
  *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
+ * @param log_file_name name of the log file
  */
-void assert_uint16_not_eq (uint16_t expected, uint16_t actual,
-        char const *file, int line_num)
+static void baseline_load (char const *log_file_name)
 {
-    if (expected == actual)
+    static char const suffix[] = ".baseline";
+    size_t const      len      = strlen(log_file_name);
+    char              line[UNIT_TEST_MAX_LOG_LEN + 1];
+    FILE             *file;
+
+    // write out the baseline of an earlier log file
+    baseline_save();
+
+    baseline_file_name = malloc(len + sizeof(suffix));
+    if (!baseline_file_name)
     {
-        // create an error message with details
-        NOT_EQ_ERR_MSG_CREATE(error_msg, " should not be: %u", expected);
+        return;
+    }
 
-        assert_failed(file, line_num, error_msg);
+    (void) memcpy(baseline_file_name, log_file_name, len);
+    (void) memcpy(&baseline_file_name[len], suffix, sizeof(suffix));
+
+    file = fopen(baseline_file_name, "r");
+    if (!file)
+    {
+        return;
     }
-}
 
-/**
- *  Asserts if the int32_t ARE NOT equal.
- *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
- *
- */
-void assert_int32_eq (int32_t expected, int32_t actual,
-        char const *file, int line_num)
-{
-    if (expected != actual)
+    while (fgets(line, sizeof(line), file))
     {
-        // create error message with details
-        EQ_ERR_MSG_CREATE(error_msg, " expected: %d, got: %d",
-                expected, actual);
+        char               *key;
+        unsigned long const ticks = strtoul(line, &key, 10);
+        size_t              key_len;
+
+        while (' ' == *key)
+        {
+            key++;
+        }
 
-        assert_failed(file, line_num, error_msg);
+        key_len = strcspn(key, "\r\n");
+        if ((key != line) && (key_len > 0) && !baseline_find(key))
+        {
+            (void) baseline_add(key, key_len, (uint32_t) ticks);
+        }
     }
+
+    (void) fclose(file);
+    baseline_changed = false;
 }
 
 /**
- *  Asserts if the int32_t ARE equal.
- *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
- *
+ * Write the baseline file if cases have been added to the baseline, then
+ * free the baseline.
  */
-void assert_int32_not_eq (int32_t expected, int32_t actual,
-        char const *file, int line_num)
+static void baseline_save (void)
 {
-    if (expected == actual)
+    if (baseline_file_name && baseline_changed)
     {
-        // create an error message with details
-        NOT_EQ_ERR_MSG_CREATE(error_msg, " should not be: %d", expected);
+        FILE *const file = fopen(baseline_file_name, "w");
+
+        if (file)
+        {
+            for (size_t index = 0; index < baseline_count; index++)
+            {
+                (void) fprintf(file, "%lu %s\n",
+                    (unsigned long) baseline_entries[index].ticks,
+                    baseline_entries[index].key);
+            }
 
-        assert_failed(file, line_num, error_msg);
+            (void) fclose(file);
+        }
+    }
+
+    for (size_t index = 0; index < baseline_count; index++)
+    {
+        free(baseline_entries[index].key);
     }
+
+    free(baseline_entries);
+    free(baseline_file_name);
+    baseline_entries   = 0;
+    baseline_count     = 0;
+    baseline_size      = 0;
+    baseline_file_name = 0;
+    baseline_changed   = false;
 }
 
 /**
- *  Asserts if the uint32_t ARE NOT equal.
+ * Compare the ticks of the test case that is ending with its baseline, or
+ * add the case to the baseline.
  *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
+ * @param context context of the test case
+ * @param ticks   ticks of the test case
  */
-void assert_uint32_eq (uint32_t expected, uint32_t actual,
-        char const *file, int line_num)
+static void baseline_check (unit_test_context_t *context, uint32_t ticks)
 {
-    if (expected != actual)
+    char                    key[UNIT_TEST_MAX_LOG_LEN + 1];
+    baseline_entry_t const *entry;
+    uint32_t                baseline = 0;
+    bool                    slower   = false;
+    int                     len;
+
+    if (!baseline_file_name)
     {
-        // create error message with details
-        EQ_ERR_MSG_CREATE(error_msg, " expected: %u, got: %u",
-                expected, actual);
+        return;
+    }
+
+    len = snprintf(key, sizeof(key), "%s/%s",
+        context->suite_name ? context->suite_name : "", context->case_name);
+    if (len < 0)
+    {
+        return;
+    }
+
+    #ifdef UNIT_TEST_PARALLEL
+    (void) pthread_mutex_lock(&baseline_lock);
+    #endif
+
+    entry = baseline_find(key);
+    if (entry)
+    {
+        uint64_t const limit = (uint64_t) entry->ticks
+            * (100u + baseline_threshold) / 100u;
+
+        baseline = entry->ticks;
+        slower   = ticks > limit;
+    }
+    else if ((size_t) len < sizeof(key))
+    {
+        #ifdef UNIT_TEST_ALLOC
+        // the baseline entry is not counted against the test case
+        context->alloc_paused = true;
+        #endif
+
+        // a truncated name could match another case, it is not added
+        baseline_changed = baseline_add(key, (size_t) len, ticks)
+            || baseline_changed;
+
+        #ifdef UNIT_TEST_ALLOC
+        context->alloc_paused = false;
+        #endif
+    }
 
-        assert_failed(file, line_num, error_msg);
+    #ifdef UNIT_TEST_PARALLEL
+    (void) pthread_mutex_unlock(&baseline_lock);
+    #endif
+
+    if (slower && baseline_fail)
+    {
+        log_held_back(context);
+        log_msg_u32(UNIT_TEST_EVT_BASELINE_FAILED, baseline);
+        context->current_test_case_pass = false;
+        context->failed_assert          = true;
+    }
+    else if (slower && context->case_logged)
+    {
+        log_msg_u32(UNIT_TEST_EVT_BASELINE_WARNING, baseline);
     }
 }
 
 /**
- *  Asserts if the uint32_t ARE equal.
- *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
+ * @return the baseline of a case, or null if the case is not in the
+ *         baseline
  */
-void assert_uint32_not_eq (uint32_t expected, uint32_t actual,
-        char const *file, int line_num)
+static baseline_entry_t *baseline_find (char const *key)
 {
-    if (expected == actual)
+    for (size_t index = 0; index < baseline_count; index++)
     {
-        // create an error message with details
-        NOT_EQ_ERR_MSG_CREATE(error_msg, " should not be: %u", expected);
-
-        assert_failed(file, line_num, error_msg);
+        if (0 == strcmp(baseline_entries[index].key, key))
+        {
+            return &baseline_entries[index];
+        }
     }
-}
 
-#ifdef UNIT_TEST_INT64
+    return 0;
+}
 
 /**
- *  Asserts if the int64_t ARE NOT equal.
+ * Add a case to the baseline.
  *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
+ * @param key   "suite/case" name of the case, not terminated
+ * @param len   length of the name
+ * @param ticks ticks of the case
+ *
+ * @return false if there is no memory for the case
  */
-void assert_int64_eq (int64_t expected, int64_t actual,
-        char const *file, int line_num)
+static bool baseline_add (char const *key, size_t len, uint32_t ticks)
 {
-    if (expected != actual)
+    char *copy;
+
+    if (baseline_count == baseline_size)
     {
-        // create error message with details
-        EQ_ERR_MSG_CREATE(error_msg, " expected: %lld, got: %lld",
-                expected, actual);
+        size_t const            size    = baseline_size ? 2 * baseline_size
+            : 64;
+        baseline_entry_t *const entries = realloc(baseline_entries,
+            size * sizeof(*entries));
+
+        if (!entries)
+        {
+            return false;
+        }
+
+        baseline_entries = entries;
+        baseline_size    = size;
+    }
 
-        assert_failed(file, line_num, error_msg);
+    copy = malloc(len + 1);
+    if (!copy)
+    {
+        return false;
     }
+
+    (void) memcpy(copy, key, len);
+    copy[len] = 0;
+
+    baseline_entries[baseline_count].key   = copy;
+    baseline_entries[baseline_count].ticks = ticks;
+    baseline_count++;
+
+    return true;
 }
+#endif
 
+#ifdef UNIT_TEST_STACK
 /**
- *  Asserts if the int64_t ARE equal.
+ * Fill the unused stack of a context, from its limit to the margin below
+ * the frame of this function, with the stack pattern. The filling is done
+ * here, without calling other functions, so that no live frame is below it.
  *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
+ * @param context the context
  */
-void assert_int64_not_eq (int64_t expected, int64_t actual,
-        char const *file, int line_num)
+static void stack_paint (unit_test_context_t *context)
 {
-    if (expected == actual)
+    uint8_t         marker = 0;
+    uintptr_t const top    = (uintptr_t) &marker - UNIT_TEST_STACK_MARGIN;
+
+    context->stack_top = 0;
+
+    if (!context->stack_limit || (top <= (uintptr_t) context->stack_limit))
     {
-        // create an error message with details
-        NOT_EQ_ERR_MSG_CREATE(error_msg, " should not be: %lld", expected);
+        return;
+    }
 
-        assert_failed(file, line_num, error_msg);
+    for (volatile uint8_t *byte = (volatile uint8_t *) context->stack_limit;
+        (uintptr_t) byte < top; byte++)
+    {
+        *byte = UNIT_TEST_STACK_PATTERN;
     }
+
+    context->stack_top = top;
 }
 
 /**
- *  Asserts if the uint64_t ARE NOT equal.
+ * Find how much of the stack painted by stack_paint has been used.
  *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
+ * @param context the context
+ *
+ * @return bytes used below the frame of stack_paint, 0 if the stack has not
+ *         been used past the margin or is not painted
  */
-void assert_uint64_eq (uint64_t expected, uint64_t actual,
-        char const *file, int line_num)
+static uint32_t stack_scan (unit_test_context_t const *context)
 {
-    if (expected != actual)
+    volatile uint8_t const *byte =
+        (volatile uint8_t const *) context->stack_limit;
+
+    if (!context->stack_top)
     {
-        // create error message with details
-        EQ_ERR_MSG_CREATE(error_msg, " expected: %llu, got: %llu",
-                expected, actual);
+        return 0;
+    }
 
-        assert_failed(file, line_num, error_msg);
+    while (((uintptr_t) byte < context->stack_top)
+        && (UNIT_TEST_STACK_PATTERN == *byte))
+    {
+        byte++;
+    }
+
+    if ((uintptr_t) byte == context->stack_top)
+    {
+        return 0;
     }
+
+    return (uint32_t) (context->stack_top - (uintptr_t) byte)
+        + UNIT_TEST_STACK_MARGIN;
 }
+#endif
 
+#ifdef UNIT_TEST_ALLOC
 /**
- *  Asserts if the uint64_t ARE equal.
+ * Fail the ending test case of a context if it did not free all of the
+ * memory it allocated.
  *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
+ * @param context the context
  */
-void assert_uint64_not_eq (uint64_t expected, uint64_t actual,
-        char const *file, int line_num)
+static void alloc_check (unit_test_context_t *context)
 {
-    if (expected == actual)
+    if (context->alloc_live)
     {
-        // create an error message with details
-        NOT_EQ_ERR_MSG_CREATE(error_msg, " should not be: %llu", expected);
-
-        assert_failed(file, line_num, error_msg);
+        log_held_back(context);
+        log_msg_u32(UNIT_TEST_EVT_ALLOC_LEAKED, context->alloc_live);
+        context->current_test_case_pass = false;
+        context->failed_assert          = true;
     }
 }
-
 #endif
 
-#ifdef UNIT_TEST_FLOATING_POINT
-
+#ifdef UNIT_TEST_ALLOC_WRAP
 /**
- *  Asserts if the float32_t ARE NOT equal.
+ * Fill in the header of a block allocated through the wrappers, and record
+ * the allocation if it is counted in the current test case.
  *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
+ * @param header the header
+ * @param size   size of the block in bytes
  */
-void assert_float32_eq (float32_t expected, float32_t actual,
-        char const *file, int line_num)
+static void alloc_header_set (alloc_header_t *header, size_t size)
 {
-    assert_float64_eq((float64_t) expected, (float64_t) actual,
-            file, line_num);
+    unit_test_context_t const *const context = current_context;
+
+    header->block.size       = size;
+    header->block.owner      = 0;
+    header->block.alloc_case = 0;
+
+    if (context->test_case_active && !context->alloc_paused)
+    {
+        header->block.owner      = context;
+        header->block.alloc_case = context->alloc_case;
+        unit_test_alloc_record(size);
+    }
 }
 
 /**
- *  Asserts if the float32_t ARE equal.
+ * Record the release of a block allocated through the wrappers, only if it
+ * was counted in the test case that is still running.
  *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
+ * @param owner      context the block was counted in, or null
+ * @param alloc_case id of the case the block was counted in
+ * @param size       size of the block in bytes
  */
-void assert_float32_not_eq (float32_t expected, float32_t actual,
-        char const *file, int line_num)
+static void alloc_release (unit_test_context_t const *owner,
+    uint32_t alloc_case, size_t size)
 {
-    assert_float64_not_eq((float64_t) expected, (float64_t) actual,
-            file, line_num);
+    unit_test_context_t const *const context = current_context;
+
+    if (owner == context && alloc_case == context->alloc_case
+        && context->test_case_active)
+    {
+        unit_test_free_record(size);
+    }
 }
+#endif
 
 /**
- *  Asserts if the float64_t ARE NOT equal.
+ * Compare two arrays and fail the current test case if they differ. The
+ * failure gives the index of the first difference and the number of
+ * differences, the bytes of both arrays around the first difference are
+ * logged after it.
  *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
+ *  @param expected   the expected elements
+ *  @param actual     the elements to compare to
+ *  @param count      number of elements
+ *  @param width      size of an element in bytes, 1, 2 or 4
  *  @param file       the source file name
  *  @param line_num   the source code line number
  */
-void assert_float64_eq (float64_t expected, float64_t actual,
-        char const *file, int line_num)
+static void mem_assert (void const *expected, void const *actual,
+    size_t count, size_t width, unit_test_file_t file, int line_num)
 {
-    bool equal = float64_eq(expected, actual);
+    uint8_t const *const e_bytes = expected;
+    uint8_t const *const a_bytes = actual;
+    size_t const         size    = count * width;
+    uint32_t             index;
+    uint32_t const       number  = mem_diff(e_bytes, a_bytes, size, width,
+        &index);
 
-    if (!equal)
+    ASSERT_COUNT();
+
+    if (number)
     {
-        // create an error message with details
-        EQ_ERR_MSG_CREATE(error_msg, " expected: %e, got: %e",
-                expected, actual);
+        // the window starts on the 8 byte boundary below the difference
+        size_t const offset = ((size_t) index * width) & ~(size_t) 7;
+        size_t const len    = (size - offset < UNIT_TEST_MEM_WINDOW)
+            ? size - offset : UNIT_TEST_MEM_WINDOW;
+
+        // create error message with details
+        EQ_ERR_MSG_CREATE(ERROR_MSG, UNIT_TEST_TYPE_MEM,
+                " first difference at index %u, differences: %u",
+                index, number);
 
-        assert_failed(file, line_num, error_msg);
+        assert_record(file, line_num, ERROR_MSG);
+
+        log_msg_u32(UNIT_TEST_EVT_MEM_OFFSET, (uint32_t) offset);
+        log_msg_hex(UNIT_TEST_EVT_MEM_EXPECTED, &e_bytes[offset], len);
+        log_msg_hex(UNIT_TEST_EVT_MEM_ACTUAL,   &a_bytes[offset], len);
+
+        #ifdef UNIT_TEST_FAIL_FAST
+        fail_fast_jump();
+        #endif
     }
 }
 
 /**
- *  Asserts if the float64_t ARE equal.
+ * Count the elements that differ between two arrays. Runs of equal bytes
+ * are skipped MEM_CHUNK bytes at a time, only a chunk that differs is
+ * compared element by element.
  *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- *  @param file       the source file name
- *  @param line_num   the source code line number
+ *  @param[in]  expected  the expected bytes
+ *  @param[in]  actual    the bytes to compare to
+ *  @param[in]  len       number of bytes, a multiple of width
+ *  @param[in]  width     size of an element in bytes, 1, 2 or 4
+ *  @param[out] first     index of the first element that differs
+ *
+ *  @return the number of elements that differ
  */
-void assert_float64_not_eq (float64_t expected, float64_t actual,
-        char const *file, int line_num)
+static uint32_t mem_diff (uint8_t const *expected, uint8_t const *actual,
+    size_t len, size_t width, uint32_t *first)
 {
-    bool equal = float64_eq(expected, actual);
+    uint32_t diffs = 0;
+    size_t   pos   = 0;
 
-    if (equal)
+    *first = 0;
+
+    while (pos < len)
     {
-        // create an error message with details
-        NOT_EQ_ERR_MSG_CREATE(error_msg, " should not be: %e", expected);
+        size_t end;
+
+        pos += mem_skip(&expected[pos], &actual[pos], len - pos);
+        end  = (len - pos < MEM_CHUNK) ? len : pos + MEM_CHUNK;
 
-        assert_failed(file, line_num, error_msg);
+        // the chunk is a multiple of the width, pos stays on an element
+        for ( ; pos < end; pos += width)
+        {
+            if (memcmp(&expected[pos], &actual[pos], width))
+            {
+                if (!diffs)
+                {
+                    *first = (uint32_t) (pos / width);
+                }
+                diffs++;
+            }
+        }
     }
+
+    return diffs;
 }
 
 /**
- *  Compare 2 floating point numbers for equality.
+ * Find the number of leading bytes of two buffers that are equal, counted in
+ * whole chunks of MEM_CHUNK bytes.
  *
- *  @param expected   the expected value
- *  @param actual     the value to compare to
- * 
- *  @return true if the values are equal, false otherwise
+ *  @param expected  the expected bytes
+ *  @param actual    the bytes to compare to
+ *  @param len       number of bytes
+ *
+ *  @return the number of bytes in the leading chunks that are equal
  */
-//lint -e{777} allow explicit comparison to 0
-static bool float64_eq (float64_t expected, float64_t actual)
+static size_t mem_skip (uint8_t const *expected, uint8_t const *actual,
+    size_t len)
 {
-    float64_t relative_error;
-    bool equal = false;
+    size_t pos = 0;
 
-    // do explicit checks for zero to avoid any divide-by-zero issues
-    if ((float64_t) 0.0 == expected)
-    {
-        equal = (fabs(actual) < MAX_FLOAT_ABSOLUTE_ERROR)
-                ? true : false;
-    }
-    else if ((float64_t) 0.0 == actual)
-    {
-        equal = (fabs(expected) < MAX_FLOAT_ABSOLUTE_ERROR)
-                ? true : false;
-    }
-    else if (fabs(expected - actual) < MAX_FLOAT_ABSOLUTE_ERROR)
-    {
-        // see if they are close enough in absolute terms
-        equal = true;
-    }
-    else
+    while ((len - pos) >= MEM_CHUNK)
     {
-        // see if they are close enough in relative terms,
-        if (fabs(expected) > fabs(actual))
+        #if defined(__SSE2__)
+        __m128i const e_vec = _mm_loadu_si128((__m128i const *)
+            &expected[pos]);
+        __m128i const a_vec = _mm_loadu_si128((__m128i const *)
+            &actual[pos]);
+
+        if (0xFFFF != _mm_movemask_epi8(_mm_cmpeq_epi8(e_vec, a_vec)))
         {
-            relative_error = fabs((expected - actual) / expected);
+            break;
         }
-        else
+        #elif defined(__ARM_NEON) && defined(__aarch64__)
+        uint8x16_t const equal = vceqq_u8(vld1q_u8(&expected[pos]),
+            vld1q_u8(&actual[pos]));
+
+        if (0xFF != vminvq_u8(equal))
         {
-            relative_error = fabs((actual - expected) / actual);
+            break;
         }
+        #else
+        size_t e_words[MEM_CHUNK / sizeof(size_t)];
+        size_t a_words[MEM_CHUNK / sizeof(size_t)];
+        size_t bits = 0;
 
-        if (relative_error < MAX_FLOAT_RELATIVE_ERROR)
+        // copied to words, the buffers need not be aligned
+        (void) memcpy(e_words, &expected[pos], MEM_CHUNK);
+        (void) memcpy(a_words, &actual[pos],   MEM_CHUNK);
+
+        for (size_t index = 0; index < (MEM_CHUNK / sizeof(size_t)); index++)
         {
-            equal = true;
+            bits |= e_words[index] ^ a_words[index];
+        }
+
+        if (bits)
+        {
+            break;
         }
+        #endif
+
+        pos += MEM_CHUNK;
     }
 
-    return equal;
+    return pos;
 }
 
-#endif // UNIT_TEST_FLOATING_POINT
-
+#ifdef UNIT_TEST_FAIL_FAST
 /**
- *  Open the unit test log file. This function should be called prior to
- *  any test suites being called.
- *
- *  @param  file_name name of the file to open or null if no file is desired
+ * End the current test case after a failed assert by jumping back to its
+ * checkpoint, if it has one and fail fast is on. test_case_end is then
+ * called as usual after the checkpoint.
  */
-void unit_test_log_on (char const *file_name)
+static void fail_fast_jump (void)
 {
-    #ifdef UNIT_TEST_LOG
-    if (file_name)
+    unit_test_context_t *const context = current_context;
+
+    #ifdef UNIT_TEST_PROPERTY
+    // a run of a property check ends, not the test case
+    if (fail_fast_enabled && context->property_armed)
     {
-        log_file = fopen(file_name, "w");
-        
-        // track whether there are any failed asserts during the run
-        failed_assert = false;
+        context->property_armed = false;
+        longjmp(context->property_checkpoint, 1);
     }
     #endif
+
+    if (fail_fast_enabled && context->test_case_active
+        && context->checkpoint_set)
+    {
+        context->checkpoint_set = false;
+        longjmp(context->checkpoint, 1);
+    }
 }
 
+#ifdef UNIT_TEST_REGISTRY
 /**
- *  Close the unit test log file. This should be called only after all the test
- *  suites have been executed.
+ * @return true if the current context has reached the limit of failed test
+ *         cases, the registry runners then stop running cases
  */
-void unit_test_log_off (void)
+static bool fail_fast_stopped (void)
 {
-    #ifdef UNIT_TEST_LOG
-    if (log_file)
-    {
-        (void) fclose(log_file);
-        log_file = 0;
-    }
-    #endif
+    return fail_fast_limit
+        && (current_context->failed_cases >= fail_fast_limit);
 }
+#endif
+#endif
 
+#ifdef UNIT_TEST_TIMER_MS
 /**
- *  This function is called when an assertion fails. An error message is
- *  logged and test case failure is noted.
+ * Handler of SIGALRM for unit_test_timer_ms.
  *
- *  @param file     the source file name
- *  @param line_num the source code line number
- *  @param msg      the message to be displayed
+ * @param signal the signal
  */
-static void assert_failed (char const *file, int line_num, char const *msg)
+static void timer_ms_expired (int signal)
 {
-    log_assert_fail("\n    Assert Failed in File: %s, Line %d: %s",
-            file, line_num, msg);
-
-    // the current test case has failed
-    current_test_case_pass = false;
-    
-    // if any unit test case fails during a run, this is set to true
-    failed_assert = true;
+    (void) signal;
+    unit_test_timeout_expired();
 }
+#endif
 
+#ifdef UNIT_TEST_PROPERTY
 /**
- * If logging is turned on, log a message to stdout and to the log file.
+ * Run a property once in the current mode of the check. With fail fast the
+ * run ends at its first failed assert.
  *
- * @param[in] msg_str string to print
+ * @param property the property
+ *
+ * @return true if an assert of the property failed
  */
-//lint -e{592} non-literal format specifier
-static void log_msg (char const *msg_str)
+static bool property_run (void (*property)(void))
 {
-    #ifdef UNIT_TEST_LOG
-    if (log_file)
+    unit_test_context_t *const context = current_context;
+
+    context->property_next   = 0;
+    context->property_failed = false;
+
+    #ifdef UNIT_TEST_FAIL_FAST
+    context->property_armed = true;
+    if (0 == setjmp(context->property_checkpoint))
+    #endif
     {
-         // print to standard output and write to file
-        (void) printf(msg_str);
-        (void) fprintf(log_file, msg_str);
+        property();
     }
+
+    #ifdef UNIT_TEST_FAIL_FAST
+    context->property_armed = false;
     #endif
+
+    return context->property_failed;
 }
 
 /**
- * If logging is turned on, log a message and single number to stdout and to
- * the log file. It is assumed that the message string contains a single
- * format specifier for a integer.
+ * Make the recorded values of a failing run smaller, one at a time, as long
+ * as the property still fails with them. Each value is first set to 0, then
+ * less and less is taken off it.
+ *
+ * @param property the property
  *
- *  @param[in] format_str  format string
- *  @param[in] num         number to print
+ * @return number of runs made
  */
-static void log_msg_num (char const *format_str, uint16_t const num)
+static uint32_t property_shrink (void (*property)(void))
 {
-    #ifdef UNIT_TEST_LOG
-    if(log_file)
+    unit_test_context_t *const context = current_context;
+    uint32_t                   steps   = 0;
+    bool                       smaller = true;
+
+    while (smaller && (steps < PROPERTY_MAX_SHRINKS))
     {
-        // print to standard output and write to file
-        (void) printf(format_str, num);
-        (void) fprintf(log_file, format_str, num);
+        smaller = false;
+
+        for (uint16_t index = 0; index < context->property_len; index++)
+        {
+            uint32_t *const draw = &context->property_draws[index];
+
+            for (uint32_t delta = *draw; delta > 0; delta >>= 1)
+            {
+                while ((delta <= *draw) && (steps < PROPERTY_MAX_SHRINKS))
+                {
+                    *draw -= delta;
+                    steps++;
+
+                    if (!property_run(property))
+                    {
+                        // the property passes, this is too small
+                        *draw += delta;
+                        break;
+                    }
+
+                    smaller = true;
+                }
+            }
+        }
     }
-    #endif
+
+    return steps;
 }
 
 /**
- * If logging is turned on, log a message and single number to stdout and to
- * the log file. It is assumed that the message string contains a single
- * format specifier for a string.
+ * Generate a value, or replay a recorded one while shrinking. The values a
+ * run generates are recorded in order.
  *
- *  @param[in] format_str  format string
- *  @param[in] str         string to print
+ * @param max highest value
+ *
+ * @return value from 0 to max
  */
-static void log_msg_str (char const *format_str, char const *str)
+static uint32_t property_draw (uint32_t max)
 {
-    #ifdef UNIT_TEST_LOG
-    if(log_file)
+    unit_test_context_t *const context = current_context;
+    uint16_t const             next    = context->property_next;
+    uint32_t                   value;
+
+    if (context->property_replay)
     {
-        // print to standard output and write to file
-        (void) printf(format_str, str);
-        (void) fprintf(log_file, format_str, str);
+        // a run that takes more values than were recorded gets 0
+        value = (next < context->property_len)
+            ? context->property_draws[next] : 0u;
     }
-    #endif
+    else
+    {
+        value = property_xorshift(&context->property_rng);
+    }
+
+    if (max < UINT32_MAX)
+    {
+        value %= max + 1u;
+    }
+
+    if (!context->property_replay && (next < PROPERTY_MAX_DRAWS))
+    {
+        context->property_draws[next] = value;
+    }
+
+    if (next < UINT16_MAX)
+    {
+        context->property_next = (uint16_t) (next + 1u);
+    }
+
+    return value;
 }
 
 /**
- * If logging is turned on, log a message, file name and line number to stdout
- * and the log file.
+ * Step a xorshift32 generator.
  *
- *  @param[in] format_str  format string
- *  @param[in] file_name   name of file
- *  @param[in] line_num    line number
- *  @param[in] msg_str     message to print
+ * @param state state of the generator, not 0
+ *
+ * @return the next value of the generator
  */
-static void log_assert_fail (char const *format_str,
-    char const *file_name, int const line_num, char const *msg_str)
+static uint32_t property_xorshift (uint32_t *state)
 {
-    #ifdef UNIT_TEST_LOG
-    if(log_file)
-    {
-        // print to standard output and write to file
-        (void) printf(format_str, file_name, line_num, msg_str);
-        (void) fprintf(log_file, format_str, file_name, line_num, msg_str);
-    }
-    #endif
-}
+    uint32_t value = *state;
+
+    value ^= value << 13;
+    value ^= value >> 17;
+    value ^= value << 5;
+    *state = value;
 
+    return value;
+}
 
+/**
+ * Map a value to a signed value, so that the small values map to the
+ * values near 0: 0, -1, 1, -2, 2, ...
+ *
+ * @param value the value
+ *
+ * @return the signed value
+ */
+static int32_t property_zigzag (uint32_t value)
+{
+    return (int32_t) (value >> 1) ^ -(int32_t) (value & 1u);
+}
+#endif
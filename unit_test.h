@@ -119,7 +119,8 @@
  *
  *    ### Assumptions
  *
- *    - Unit testing is performed in a single thread.
+ *    - Unit testing is performed in a single thread, or with UNIT_TEST_THREADS
+ *      each thread uses its own test context.
  *    - Only one test suite is executed at a time.
  *    - Only one test case is executed at a time.
  *
@@ -162,87 +163,1479 @@
 #ifndef _UNIT_TEST_H_
 #define _UNIT_TEST_H_
 
+#include <stddef.h>        // to provide size_t
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-//RSM_IGNORE_BEGIN allow line to exceed 80 characters for easy viewing of macros
+//RSM_IGNORE_BEGIN allow line to exceed 80 characters for easy viewing of macros
+
+/**
+ * Using conditional compilation, the unit test framework can be configured to 
+ * exclude support for logging, 64-bit integer and floating point numbers.
+ * Define the following constants in your code or environment to include/exclude
+ * support for these.
+ * 
+ * By default, support for logging is on and support for 64-bit integer and
+ * floating point is configured off.
+ * 
+ * - UNIT_TEST_LOG
+ * - UNIT_TEST_LOG_BINARY
+ * - UNIT_TEST_LOG_RING_SIZE
+ * - UNIT_TEST_LOG_RING_DROP_OLDEST
+ * - UNIT_TEST_LOG_ASYNC_SIZE
+ * - UNIT_TEST_LOG_ASYNC_THREAD
+ * - UNIT_TEST_LOG_NO_STDIO
+ * - UNIT_TEST_VERBOSITY
+ * - UNIT_TEST_INLINE_ASSERTS
+ * - UNIT_TEST_COMPACT_ASSERTS
+ * - UNIT_TEST_FILE_IDS
+ * - UNIT_TEST_REGISTRY
+ * - UNIT_TEST_FIXTURES
+ * - UNIT_TEST_PARAMS
+ * - UNIT_TEST_PROPERTY
+ * - UNIT_TEST_THREADS
+ * - UNIT_TEST_PARALLEL
+ * - UNIT_TEST_FORK
+ * - UNIT_TEST_RERUN
+ * - UNIT_TEST_TIMESTAMPS
+ * - UNIT_TEST_BENCH
+ * - UNIT_TEST_BASELINE
+ * - UNIT_TEST_STACK
+ * - UNIT_TEST_ALLOC
+ * - UNIT_TEST_ALLOC_WRAP
+ * - UNIT_TEST_FAIL_FAST
+ * - UNIT_TEST_TIMEOUT
+ * - UNIT_TEST_RESULTS
+ * - UNIT_TEST_REPORT
+ * - UNIT_TEST_INT64
+ * - UNIT_TEST_FLOATING_POINT
+ *
+ * UNIT_TEST_LOG_BINARY changes the log from text to compact binary records
+ * (see "Binary log records" below). No formatting is done on the target and
+ * printf/snprintf are not used, the log file is turned back into the usual
+ * text by the host program in unit_test_decode.c. Binary records are only
+ * written to the log file, not to stdout.
+ *
+ * Define UNIT_TEST_LOG_RING_SIZE as a number of bytes to hold log messages in
+ * a static ring buffer instead of writing them as they are logged. The ring is
+ * written out by unit_test_log_flush, which test_suite_end and
+ * unit_test_log_off call and which can be called when the application is
+ * idle. When the ring is full, the logging call flushes it (blocks on the
+ * output) unless UNIT_TEST_LOG_RING_DROP_OLDEST is defined, in which case the
+ * oldest messages are dropped and the next flush logs the number dropped
+ * ahead of the messages that were kept.
+ *
+ * Define UNIT_TEST_LOG_ASYNC_SIZE as a number of bytes to log through two
+ * buffers of that size instead, one is filled while the other is sent by a
+ * log drain, see "Asynchronous log" below. UNIT_TEST_LOG_ASYNC_THREAD adds a
+ * drain that writes the buffers to the sink on a POSIX thread of a hosted
+ * build, it turns on UNIT_TEST_LOG_ASYNC_SIZE (1024 bytes unless defined).
+ *
+ * Log output is written to a sink, see unit_test_log_set_sink. Define
+ * UNIT_TEST_LOG_NO_STDIO to leave out the built-in stdout/file sinks and the
+ * log file, a sink must then be set before logging is turned on.
+ *
+ * UNIT_TEST_VERBOSITY is the most detailed log level built in, lower levels
+ * leave out the logging of passing cases, see "Verbosity" below.
+ *
+ * UNIT_TEST_INLINE_ASSERTS makes the ASSERT_ macros compare the values inline,
+ * a passing assert costs a compare and a branch. Only a failing assert calls
+ * into the framework, through the out-of-line assert_value_failed. The
+ * assert functions are still provided and can be called directly.
+ *
+ * UNIT_TEST_COMPACT_ASSERTS routes all integer and bool asserts through one
+ * function that takes a type tag and the values widened, the typed assert
+ * functions become thin wrappers. This saves code space on small targets.
+ *
+ * UNIT_TEST_FILE_IDS makes the asserts identify the source file by a 16-bit
+ * id instead of the __FILE__ string, see "Source file ids" below.
+ *
+ * UNIT_TEST_REGISTRY adds the test registry and unit_test_run, see "Test
+ * registry" below.
+ *
+ * UNIT_TEST_FIXTURES adds setup and teardown hooks to the suites of the
+ * registry, see "Fixtures" below. It turns on UNIT_TEST_REGISTRY.
+ *
+ * UNIT_TEST_PARAMS adds TEST_CASE_PARAM, a registered test case that runs
+ * its body over a table of parameters, see "Parameterized test cases"
+ * below. It turns on UNIT_TEST_REGISTRY.
+ *
+ * UNIT_TEST_PROPERTY adds property tests, which check an assertion over
+ * many generated values and shrink a failing input to a small one, see
+ * "Property tests" below.
+ *
+ * UNIT_TEST_THREADS makes the current test context thread-local so that
+ * suites can run on several threads of a hosted build, see "Test contexts"
+ * below.
+ *
+ * UNIT_TEST_PARALLEL adds unit_test_run_parallel, which runs the registered
+ * suites on a pool of POSIX threads. It turns on UNIT_TEST_REGISTRY and
+ * UNIT_TEST_THREADS and is only for hosted builds.
+ *
+ * UNIT_TEST_FORK adds unit_test_run_forked, which runs the registered suites
+ * in child processes so a test that crashes is reported as a failed test
+ * case instead of ending the run. It turns on UNIT_TEST_REGISTRY and is only
+ * for hosted POSIX builds.
+ *
+ * UNIT_TEST_RERUN keeps a record of the failed test cases of each run, so
+ * the runners can run the failed cases first or only those, see "Rerun of
+ * failed cases" below. It turns on UNIT_TEST_REGISTRY.
+ *
+ * UNIT_TEST_TIMESTAMPS times each test case and suite with a timestamp
+ * source set by the application, see "Timestamps" below.
+ *
+ * UNIT_TEST_BENCH adds BENCH_CASE, a test case that runs its body many times
+ * and logs statistics of the elapsed ticks, see "Benchmarks" below. It turns
+ * on UNIT_TEST_TIMESTAMPS.
+ *
+ * UNIT_TEST_BASELINE compares the ticks of each test case and benchmark with
+ * a baseline file kept next to the log file, see "Baselines" below. It turns
+ * on UNIT_TEST_TIMESTAMPS and needs UNIT_TEST_LOG with the stdio sinks.
+ *
+ * UNIT_TEST_STACK measures the stack used by each test case, see "Stack
+ * use" below.
+ *
+ * UNIT_TEST_ALLOC counts the heap allocations of each test case, see "Heap
+ * use" below. UNIT_TEST_ALLOC_WRAP adds malloc/free wrappers for hosted
+ * builds linked with --wrap, it turns on UNIT_TEST_ALLOC.
+ *
+ * UNIT_TEST_FAIL_FAST ends a test case at its first failed assert, see "Fail
+ * fast" below.
+ *
+ * UNIT_TEST_TIMEOUT ends a test case that runs longer than its timeout, see
+ * "Timeouts" below. It turns on UNIT_TEST_FAIL_FAST.
+ *
+ * UNIT_TEST_RESULTS writes a record of each test case and failed assert in
+ * JSON Lines or JUnit XML next to the log, see "Results" below. It needs text
+ * log messages.
+ *
+ * UNIT_TEST_REPORT keeps the counts of the run and the last failed asserts
+ * in a fixed block of memory that a debugger can read after the run, see
+ * "Report block" below. It turns on UNIT_TEST_FILE_IDS and needs a single
+ * thread.
+ */
+#define UNIT_TEST_LOG  1
+
+#ifdef UNIT_TEST_PARALLEL
+#ifndef UNIT_TEST_REGISTRY
+#define UNIT_TEST_REGISTRY 1
+#endif
+#ifndef UNIT_TEST_THREADS
+#define UNIT_TEST_THREADS 1
+#endif
+#endif
+
+#if (defined(UNIT_TEST_FORK) || defined(UNIT_TEST_RERUN) \
+        || defined(UNIT_TEST_FIXTURES) || defined(UNIT_TEST_PARAMS)) \
+    && !defined(UNIT_TEST_REGISTRY)
+#define UNIT_TEST_REGISTRY 1
+#endif
+
+#if (defined(UNIT_TEST_BENCH) || defined(UNIT_TEST_BASELINE)) \
+    && !defined(UNIT_TEST_TIMESTAMPS)
+#define UNIT_TEST_TIMESTAMPS 1
+#endif
+
+#if defined(UNIT_TEST_ALLOC_WRAP) && !defined(UNIT_TEST_ALLOC)
+#define UNIT_TEST_ALLOC 1
+#endif
+
+#if defined(UNIT_TEST_LOG_ASYNC_THREAD) && !defined(UNIT_TEST_LOG_ASYNC_SIZE)
+#define UNIT_TEST_LOG_ASYNC_SIZE 1024
+#endif
+
+#if defined(UNIT_TEST_REPORT) && !defined(UNIT_TEST_FILE_IDS)
+#define UNIT_TEST_FILE_IDS 1
+#endif
+
+#if defined(UNIT_TEST_TIMEOUT) && !defined(UNIT_TEST_FAIL_FAST)
+#define UNIT_TEST_FAIL_FAST 1
+#endif
+
+#ifdef UNIT_TEST_FAIL_FAST
+#include <setjmp.h>        // to provide the checkpoint of a test case
+#endif
+
+#if defined(UNIT_TEST_BASELINE) && defined(UNIT_TEST_LOG_NO_STDIO)
+#error "UNIT_TEST_BASELINE needs the baseline file, it cannot be used with UNIT_TEST_LOG_NO_STDIO"
+#endif
+
+#if defined(UNIT_TEST_BASELINE) && !defined(UNIT_TEST_LOG)
+#error "UNIT_TEST_BASELINE needs the baseline file, it needs UNIT_TEST_LOG"
+#endif
+
+//! Log levels, see "Verbosity" below
+#define UNIT_TEST_VERBOSITY_QUIET  0
+#define UNIT_TEST_VERBOSITY_SUITES 1
+#define UNIT_TEST_VERBOSITY_CASES  2
+
+#ifndef UNIT_TEST_VERBOSITY
+#define UNIT_TEST_VERBOSITY UNIT_TEST_VERBOSITY_CASES
+#endif
+
+//! Thread-local storage, used with UNIT_TEST_THREADS
+#if !defined(UNIT_TEST_THREADS)
+#define UNIT_TEST_THREAD_LOCAL
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+#define UNIT_TEST_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#define UNIT_TEST_THREAD_LOCAL __thread
+#else
+#error "UNIT_TEST_THREADS needs C11 or GCC thread-local storage"
+#endif
+
+#if defined(UNIT_TEST_LOG_ASYNC_SIZE) && defined(UNIT_TEST_LOG_RING_SIZE)
+#error "UNIT_TEST_LOG_ASYNC_SIZE and UNIT_TEST_LOG_RING_SIZE are two ways to buffer the log, define one of them"
+#endif
+
+#if defined(UNIT_TEST_RESULTS) && defined(UNIT_TEST_LOG_BINARY)
+#error "UNIT_TEST_RESULTS needs text assert messages, it cannot be used with UNIT_TEST_LOG_BINARY"
+#endif
+
+#if defined(UNIT_TEST_REPORT) && defined(UNIT_TEST_THREADS)
+#error "UNIT_TEST_REPORT keeps the report of one test context, it cannot be used with UNIT_TEST_THREADS"
+#endif
+
+/**
+ * Source file ids. By default the asserts pass __FILE__ to identify the
+ * source file. With UNIT_TEST_FILE_IDS they pass a 16-bit id instead, so the
+ * path strings are not kept in the target and are not sent with each failure.
+ * The log shows the id as "#id", unit_test_decode expands it using a map file
+ * (see unit_test_decode.c).
+ *
+ * Give each test file its id by defining UNIT_TEST_FILE_ID before including
+ * this file:
+ *
+ *     #define UNIT_TEST_FILE_ID 3
+ *     #include "unit_test.h"
+ *
+ * If UNIT_TEST_FILE_ID is not defined, the id is a hash of the last 32
+ * characters of __FILE__. The compiler folds the hash to a constant when
+ * optimizing, without optimization the path string is still kept. Run
+ * "unit_test_decode -h <path>" to get the hash of a path. If 2 files hash to
+ * the same id, give one of them an explicit id.
+ */
+#ifdef UNIT_TEST_FILE_IDS
+
+typedef uint16_t unit_test_file_t;
+
+//! FNV-1a hash of the last 32 characters of a string literal
+#define UNIT_TEST_HASH_CHAR(s, i) \
+    ((sizeof(s) > (i) + 1u) \
+        ? (uint32_t) (uint8_t) (s)[(sizeof(s) > (i) + 1u) ? sizeof(s) - 2u - (i) : 0u] \
+        : 0u)
+#define UNIT_TEST_HASH_STEP(h, s, i) \
+    ((uint32_t) (((h) ^ UNIT_TEST_HASH_CHAR(s, i)) * 16777619u))
+#define UNIT_TEST_HASH_8(h, s, i) \
+    UNIT_TEST_HASH_STEP(UNIT_TEST_HASH_STEP(UNIT_TEST_HASH_STEP(UNIT_TEST_HASH_STEP( \
+    UNIT_TEST_HASH_STEP(UNIT_TEST_HASH_STEP(UNIT_TEST_HASH_STEP(UNIT_TEST_HASH_STEP( \
+        h, s, (i)), s, (i) + 1u), s, (i) + 2u), s, (i) + 3u), s, (i) + 4u), \
+        s, (i) + 5u), s, (i) + 6u), s, (i) + 7u)
+#define UNIT_TEST_HASH_32(s) \
+    UNIT_TEST_HASH_8(UNIT_TEST_HASH_8(UNIT_TEST_HASH_8(UNIT_TEST_HASH_8( \
+        2166136261u, s, 0u), s, 8u), s, 16u), s, 24u)
+#define UNIT_TEST_FILE_HASH(s) \
+    ((unit_test_file_t) (UNIT_TEST_HASH_32(s) ^ (UNIT_TEST_HASH_32(s) >> 16)))
+
+#ifndef UNIT_TEST_FILE_ID
+#define UNIT_TEST_FILE_ID UNIT_TEST_FILE_HASH(__FILE__)
+#endif
+
+#define UNIT_TEST_FILE ((unit_test_file_t) (UNIT_TEST_FILE_ID))
+
+#else
+
+typedef char const *unit_test_file_t;
+
+#define UNIT_TEST_FILE __FILE__
+
+#endif // UNIT_TEST_FILE_IDS
+
+/**
+ * A log sink receives the log output as bytes, this allows the output to be
+ * sent to SWO/ITM, an RTT buffer, a DMA driven UART or anything else. The
+ * write function is called with the bytes of one or more log messages. The
+ * flush function, which can be null, is called when the log is flushed.
+ * context is passed to both functions.
+ */
+typedef struct
+{
+    void (*write)(void *context, uint8_t const *data, size_t len);
+    void (*flush)(void *context);
+    void  *context;
+} unit_test_sink_t;
+
+#ifndef UNIT_TEST_LOG_NO_STDIO
+extern unit_test_sink_t const unit_test_sink_stdout;
+extern unit_test_sink_t const unit_test_sink_file;
+extern unit_test_sink_t const unit_test_sink_stdout_file;
+#endif
+
+#ifdef UNIT_TEST_LOG_ASYNC_SIZE
+/**
+ * Asynchronous log. With UNIT_TEST_LOG_ASYNC_SIZE the log messages of the
+ * default context are copied into one of two buffers. When the buffer is
+ * full, or at the end of a suite, it is handed to a log drain and the next
+ * messages go to the other buffer, so the tests keep running while the log
+ * is sent. Only when both buffers are in use does the logging call wait.
+ *
+ * The start function of the drain begins sending len bytes at data, for
+ * example by starting a DMA transfer to a UART, and returns. The bytes stay
+ * in place until unit_test_log_drain_done is called, typically from the
+ * transfer complete interrupt. Only one buffer is sent at a time. While the
+ * logging call waits for the drain it calls wait, which can be null, over
+ * and over (a drain can sleep there, __WFI on a Cortex-M). stop, which can
+ * be null, is called by unit_test_log_off once everything has been sent.
+ *
+ *     static void uart_drain_start (void *context, uint8_t const *data,
+ *         size_t len)
+ *     {
+ *         (void) context;
+ *         uart_dma_send(data, len);    // completion ISR calls
+ *     }                                // unit_test_log_drain_done()
+ *
+ *     static unit_test_log_drain_t const uart_drain =
+ *     {
+ *         uart_drain_start, 0, 0, 0
+ *     };
+ *
+ *     unit_test_log_set_drain(&uart_drain);
+ *
+ * Without a drain the buffers are written to the sink of the default context
+ * as they fill. UNIT_TEST_LOG_ASYNC_THREAD adds unit_test_log_drain_thread,
+ * which writes them to that sink on a background thread, and uses it as the
+ * default drain.
+ *
+ * unit_test_log_flush hands over the buffer being filled and waits until it
+ * has been sent. unit_test_log_async_stats tells how the producer kept up:
+ * the buffers and bytes handed to the drain, and the number of times (and
+ * with UNIT_TEST_TIMESTAMPS, the ticks) the logging call had to wait for
+ * the drain.
+ */
+typedef struct
+{
+    void (*start)(void *context, uint8_t const *data, size_t len);
+    void (*wait)(void *context);
+    void (*stop)(void *context);
+    void  *context;
+} unit_test_log_drain_t;
+
+typedef struct
+{
+    uint32_t buffers;
+    uint32_t bytes;
+    uint32_t waits;
+    #ifdef UNIT_TEST_TIMESTAMPS
+    uint32_t wait_ticks;
+    #endif
+} unit_test_log_async_stats_t;
+
+#ifdef UNIT_TEST_LOG_ASYNC_THREAD
+extern unit_test_log_drain_t const unit_test_log_drain_thread;
+#endif
+
+extern void                        unit_test_log_set_drain  (unit_test_log_drain_t const *);
+extern void                        unit_test_log_drain_done (void);
+extern unit_test_log_async_stats_t unit_test_log_async_stats(void);
+#endif // UNIT_TEST_LOG_ASYNC_SIZE
+
+/**
+ * Test contexts. All the state of a test run (the active suite and case,
+ * their results, the buffers used to create messages and the log sink) is
+ * held in a unit_test_context_t. The framework functions and the asserts
+ * use the current context, which is a default context unless another one is
+ * set with unit_test_context_set.
+ *
+ * Without UNIT_TEST_THREADS there is one current context, it can be switched
+ * explicitly, for example by an RTOS task switch hook. With UNIT_TEST_THREADS
+ * each thread has its own current context, a thread that has not set one
+ * uses the default context. Give each worker thread its own context and sink:
+ *
+ *     static unit_test_context_t worker_context;
+ *
+ *     unit_test_context_init(&worker_context, &worker_sink);
+ *     (void) unit_test_context_set(&worker_context);
+ *
+ * unit_test_log_on/unit_test_log_off and the log file are shared by all the
+ * contexts and are called from one thread. The log ring buffer
+ * (UNIT_TEST_LOG_RING_SIZE) and the asynchronous log buffers
+ * (UNIT_TEST_LOG_ASYNC_SIZE) are used by the default context only, the other
+ * contexts write straight to their sink.
+ */
+
+//! Maximum length of an assertion failure message
+#define UNIT_TEST_MAX_MSG_LEN 100
+
+//! Maximum length of a formatted log message
+#define UNIT_TEST_MAX_LOG_LEN 300
+
+//! Number of source file names remembered by a binary log without file ids
+#define UNIT_TEST_LOG_MAX_FILES 16
+
+#ifdef UNIT_TEST_RESULTS
+//! Maximum length of a result record, longer names and messages are cut
+#ifndef UNIT_TEST_RESULTS_MAX_LEN
+#define UNIT_TEST_RESULTS_MAX_LEN 400
+#endif
+
+#if UNIT_TEST_RESULTS_MAX_LEN < 200
+#error "UNIT_TEST_RESULTS_MAX_LEN must be at least 200 bytes"
+#endif
+#endif
+
+#ifdef UNIT_TEST_PROPERTY
+//! Number of generated values of one run of a property that can be shrunk
+#ifndef UNIT_TEST_PROPERTY_MAX_DRAWS
+#define UNIT_TEST_PROPERTY_MAX_DRAWS 32
+#endif
+
+//! Number of runs of a property spent shrinking a failing input
+#ifndef UNIT_TEST_PROPERTY_MAX_SHRINKS
+#define UNIT_TEST_PROPERTY_MAX_SHRINKS 1000
+#endif
+
+//! Seed of the first property a context checks
+#ifndef UNIT_TEST_PROPERTY_SEED
+#define UNIT_TEST_PROPERTY_SEED 0x2545f491u
+#endif
+
+#if (UNIT_TEST_PROPERTY_MAX_DRAWS < 1) || (UNIT_TEST_PROPERTY_MAX_DRAWS > 255)
+#error "UNIT_TEST_PROPERTY_MAX_DRAWS must be 1 to 255"
+#endif
+#endif
+
+#ifdef UNIT_TEST_BENCH
+
+//! Number of iterations of a benchmark that are kept to find the median
+#ifndef UNIT_TEST_BENCH_MAX_SAMPLES
+#define UNIT_TEST_BENCH_MAX_SAMPLES 64
+#endif
+
+//! Number of untimed iterations a benchmark runs first
+#ifndef UNIT_TEST_BENCH_WARMUP
+#define UNIT_TEST_BENCH_WARMUP 2
+#endif
+
+//! State and results of the benchmark of a context, see "Benchmarks" below
+typedef struct
+{
+    uint32_t         iterations;
+    uint32_t         run;
+    uint32_t         start;
+    uint32_t         min;
+    uint32_t         median;
+    uint32_t         max;
+    uint32_t         mean;
+    #ifdef UNIT_TEST_INT64
+    uint64_t         sum;
+    #else
+    uint32_t         sum;
+    #endif
+    uint16_t         samples_len;
+    uint32_t         samples[UNIT_TEST_BENCH_MAX_SAMPLES];
+    bool             active;
+} unit_test_bench_t;
+
+#endif
+
+//! Counts of a test run, see "Verbosity" below
+typedef struct
+{
+    uint32_t suites;
+    uint32_t cases;
+    uint32_t cases_failed;
+    uint32_t asserts;
+    uint32_t asserts_failed;
+} unit_test_stats_t;
+
+typedef struct unit_test_context
+{
+    bool                    test_suite_active;
+    bool                    test_case_active;
+    bool                    current_test_case_pass;
+    bool                    failed_assert;
+    uint16_t                test_suite_num;
+    char                    error_msg[UNIT_TEST_MAX_MSG_LEN + 1];
+    char const             *suite_name;
+    char const             *case_name;
+    bool                    suite_logged;
+    bool                    case_logged;
+    unit_test_stats_t       stats;
+    #ifdef UNIT_TEST_TIMESTAMPS
+    uint32_t                suite_start;
+    uint32_t                suite_ticks;
+    uint32_t                case_start;
+    uint32_t                case_ticks;
+    uint32_t                perf_start;
+    #endif
+    #ifdef UNIT_TEST_BENCH
+    unit_test_bench_t       bench;
+    #endif
+    #ifdef UNIT_TEST_STACK
+    void const             *stack_limit;
+    uintptr_t               stack_top;
+    uint32_t                stack_used;
+    #endif
+    #ifdef UNIT_TEST_ALLOC
+    bool                    alloc_paused;
+    uint32_t                alloc_case;
+    uint32_t                alloc_count;
+    uint32_t                alloc_bytes;
+    uint32_t                alloc_live;
+    uint32_t                alloc_peak;
+    uint32_t                alloc_region_count;
+    uint32_t                alloc_region_bytes;
+    #endif
+    #ifdef UNIT_TEST_FIXTURES
+    bool                    fixture_dirty;
+    #endif
+    #ifdef UNIT_TEST_PARAMS
+    bool                    param_active;
+    bool                    param_logged;
+    uint32_t                param_index;
+    #endif
+    #ifdef UNIT_TEST_PROPERTY
+    uint32_t                property_seed;
+    uint32_t                property_rng;
+    uint32_t                property_draws[UNIT_TEST_PROPERTY_MAX_DRAWS];
+    uint16_t                property_len;
+    uint16_t                property_next;
+    bool                    property_replay;
+    bool                    property_quiet;
+    bool                    property_failed;
+    #ifdef UNIT_TEST_FAIL_FAST
+    jmp_buf                 property_checkpoint;
+    bool                    property_armed;
+    #endif
+    #endif
+    #ifdef UNIT_TEST_FAIL_FAST
+    jmp_buf                 checkpoint;
+    bool                    checkpoint_set;
+    uint32_t                failed_cases;
+    #endif
+    #ifdef UNIT_TEST_TIMEOUT
+    uint32_t                timeout;
+    uint32_t                timeout_next;
+    uint32_t                case_timeout;
+    volatile bool           timeout_armed;
+    #endif
+    #ifdef UNIT_TEST_RESULTS
+    uint32_t                results_cases;
+    uint32_t                results_failed;
+    uint32_t                results_asserts;
+    char                    results_line[UNIT_TEST_RESULTS_MAX_LEN + 1];
+    #endif
+    #ifdef UNIT_TEST_LOG
+    unit_test_sink_t const *log_sink;
+    #ifndef UNIT_TEST_LOG_BINARY
+    char                    log_line[UNIT_TEST_MAX_LOG_LEN + 1];
+    #elif !defined(UNIT_TEST_FILE_IDS)
+    char const             *log_file_names[UNIT_TEST_LOG_MAX_FILES];
+    uint16_t                log_file_next;
+    #endif
+    #endif
+} unit_test_context_t;
+
+extern void                 unit_test_context_init(unit_test_context_t *, unit_test_sink_t const *);
+extern unit_test_context_t *unit_test_context_set (unit_test_context_t *);
+extern unit_test_context_t *unit_test_context_get (void);
+
+/**
+ * Declarations for unit test framework functions.
+ */
+extern void unit_test_log_on      (char const *);
+extern void unit_test_log_off     (void);
+extern void unit_test_log_flush   (void);
+extern void unit_test_log_set_sink(unit_test_sink_t const *);
+extern bool unit_test_all_success (void);
+extern void test_suite_start      (char const *);
+extern void test_suite_end        (void);
+extern void test_case_start       (char const *);
+extern void test_case_end         (void);
+
+/**
+ * Verbosity. By default every suite and case is logged. At a lower level the
+ * passing cases are left out of the log, so a run of many cases spends its
+ * time running them instead of printing:
+ *
+ * - UNIT_TEST_VERBOSITY_CASES: each suite and case, the default
+ * - UNIT_TEST_VERBOSITY_SUITES: each suite, and the cases that fail
+ * - UNIT_TEST_VERBOSITY_QUIET: only the cases that fail
+ *
+ * The names of a suite and case that were left out are logged when the case
+ * fails, before the failure. unit_test_verbosity_set changes the level at
+ * run time, UNIT_TEST_VERBOSITY is the most detailed level built in and the
+ * logging of the levels above it is compiled out. unit_test_log_off logs a
+ * summary of the run at every level.
+ *
+ * unit_test_get_stats returns the counts of the current context: the suites
+ * and cases that have ended, the cases that failed, and the asserts checked
+ * and failed. The parallel and forked runners add the counts of their
+ * workers to the context of the caller.
+ */
+extern void              unit_test_verbosity_set(uint8_t);
+extern unit_test_stats_t unit_test_get_stats    (void);
+
+/**
+ * Timestamps (UNIT_TEST_TIMESTAMPS). Set a function that returns a free
+ * running 32-bit count, for example the DWT cycle counter of a Cortex-M, a
+ * SysTick based tick count or, on a hosted build, unit_test_clock_us. The
+ * elapsed ticks of each test case are logged on its "Test Case Passed" or
+ * "Test Case Failed" line and the elapsed ticks of each suite are logged
+ * before "Test Suite Complete":
+ *
+ *     static uint32_t cycles_get (void)
+ *     {
+ *         return DWT->CYCCNT;
+ *     }
+ *
+ *     unit_test_timestamp_set(cycles_get);
+ *
+ * The elapsed ticks are the difference of 2 counts, so a counter that wraps
+ * is handled as long as a suite takes less than 2^32 ticks. The last elapsed
+ * ticks are also kept in suite_ticks and case_ticks of the current context.
+ * Without a timestamp source nothing is timed. With the parallel runner the
+ * function is called from all the worker threads.
+ */
+#ifdef UNIT_TEST_TIMESTAMPS
+
+typedef uint32_t (*unit_test_timestamp_t)(void);
+
+extern void unit_test_timestamp_set(unit_test_timestamp_t);
+
+#if defined(__unix__) || defined(__APPLE__)
+#define UNIT_TEST_CLOCK_US 1
+extern uint32_t unit_test_clock_us (void);
+#endif
+
+/**
+ * Performance budgets. ASSERT_MAX_CYCLES fails when more than the given
+ * number of ticks have gone by since PERF_REGION_BEGIN, or since the start
+ * of the test case when there is no PERF_REGION_BEGIN. The failure is logged
+ * like a failed value assert, with the budget and the elapsed ticks:
+ *
+ *     PERF_REGION_BEGIN();
+ *     control_loop_step(&state);
+ *     ASSERT_MAX_CYCLES(1200);
+ *
+ * ASSERT_MAX_US takes the budget in microseconds, the ticks are converted
+ * with UNIT_TEST_TICKS_PER_US. Define it for your timestamp source, for
+ * example 168 for the cycle counter of a 168 MHz processor. It is 1 by
+ * default, for unit_test_clock_us. Several asserts can follow one
+ * PERF_REGION_BEGIN, each checks the time from the beginning of the region.
+ * Without a timestamp source no time goes by and the asserts pass.
+ */
+#ifndef UNIT_TEST_TICKS_PER_US
+#define UNIT_TEST_TICKS_PER_US 1
+#endif
+
+#define PERF_REGION_BEGIN()  (perf_region_begin())
+#define ASSERT_MAX_CYCLES(b) (assert_max_cycles(b, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_MAX_US(b)     (assert_max_us(b, UNIT_TEST_TICKS_PER_US, UNIT_TEST_FILE, __LINE__))
+extern void perf_region_begin(void);
+extern void assert_max_cycles(uint32_t, unit_test_file_t, int);
+extern void assert_max_us    (uint32_t, uint32_t, unit_test_file_t, int);
+
+#endif // UNIT_TEST_TIMESTAMPS
+
+/**
+ * Benchmarks (UNIT_TEST_BENCH). BENCH_CASE is a test case that runs its body
+ * UNIT_TEST_BENCH_WARMUP times untimed and then the given number of times,
+ * timing each run with the timestamp source. The minimum, median, maximum
+ * and mean ticks of the timed runs are logged before the "Test Case Passed"
+ * line. Asserts can be used in the body as in any test case:
+ *
+ *     test_suite_start("FIR filter benchmarks");
+ *
+ *     BENCH_CASE("64 tap FIR, 256 samples", 100)
+ *     {
+ *         fir_run(&filter, input, output, 256);
+ *         bench_do_not_optimize(output);
+ *     }
+ *
+ *     test_suite_end();
+ *
+ * The results are kept in the bench member of the current context. The
+ * median is taken over the first UNIT_TEST_BENCH_MAX_SAMPLES timed runs, the
+ * other statistics over all the timed runs. The mean is the sum of the ticks
+ * divided by the number of runs, without UNIT_TEST_INT64 the sum must fit in
+ * 32 bits. The ticks include the overhead of the loop, which can be seen by
+ * timing an empty body.
+ *
+ * bench_do_not_optimize makes the compiler assume the object pointed to is
+ * read and written, so work whose result is not otherwise used is not
+ * removed.
+ */
+#ifdef UNIT_TEST_BENCH
+
+#define BENCH_CASE(name, iterations) \
+    for (bench_case_start(name, iterations); bench_case_next(); )
+
+extern void bench_case_start(char const *, uint32_t);
+extern bool bench_case_next (void);
+
+#if defined(__GNUC__)
+static inline void bench_do_not_optimize (void const *object)
+{
+    __asm__ __volatile__ ("" : : "g" (object) : "memory");
+}
+#else
+extern void bench_do_not_optimize(void const *);
+#endif
+
+#endif // UNIT_TEST_BENCH
+
+/**
+ * Baselines (UNIT_TEST_BASELINE). When logging is turned on with a file name,
+ * the baseline file <file name>.baseline is loaded if it exists. Each line
+ * of the file holds the ticks of a test case and its suite and case names:
+ *
+ *     1250 Packet Builder Test Suite/Verify config frame correctly built
+ *
+ * When a timed test case ends, its ticks, or the median ticks of a
+ * benchmark, are compared with the baseline. If they are more than the
+ * threshold percentage above it, the case is logged as slower than the
+ * baseline, as a warning or, if set with unit_test_baseline_set, as a
+ * failure of the test case. Cases that are not in the baseline are added to
+ * it and unit_test_log_off writes the file back. A baseline value is not
+ * changed by later runs, delete the line or the file to take a new one.
+ *
+ * The default threshold is UNIT_TEST_BASELINE_THRESHOLD percent, with
+ * warnings. Cases that run in the worker processes of unit_test_run_forked
+ * are checked but are not added to the baseline.
+ */
+#ifdef UNIT_TEST_BASELINE
+
+#ifndef UNIT_TEST_BASELINE_THRESHOLD
+#define UNIT_TEST_BASELINE_THRESHOLD 10
+#endif
+
+extern void unit_test_baseline_set(uint16_t, bool);
+
+#endif // UNIT_TEST_BASELINE
+
+/**
+ * Stack use (UNIT_TEST_STACK). Give the lowest address the stack of the
+ * current context can grow down to, for example the start of a task stack
+ * or a linker symbol at the end of the main stack:
+ *
+ *     extern uint8_t _stack_limit[];
+ *
+ *     unit_test_stack_set(_stack_limit);
+ *
+ * test_case_start then fills the unused stack, from the limit up to
+ * UNIT_TEST_STACK_MARGIN bytes below its own frame, with
+ * UNIT_TEST_STACK_PATTERN. test_case_end finds the lowest byte that was
+ * changed and logs the bytes of stack used below test_case_start as
+ * ", <n> stack bytes" on the "Test Case Passed/Failed" line, the value is
+ * also kept in stack_used of the context. The depth is measured from the
+ * frame of test_case_start, so the frame of the function calling it is not
+ * counted, and a case that stays within the margin shows 0. ASSERT_MAX_STACK
+ * fails if the case has used more than the given bytes so far.
+ *
+ * The stack is assumed to grow down. Interrupts that run on the same stack
+ * are counted as used by the case. Filling the stack takes time, so set a
+ * limit close to the stack the cases can use.
+ */
+#ifdef UNIT_TEST_STACK
+
+//! Bytes below the frame of test_case_start that are not filled
+#ifndef UNIT_TEST_STACK_MARGIN
+#define UNIT_TEST_STACK_MARGIN 128
+#endif
+
+//! Value the unused stack is filled with
+#ifndef UNIT_TEST_STACK_PATTERN
+#define UNIT_TEST_STACK_PATTERN 0xA5
+#endif
+
+#define ASSERT_MAX_STACK(b) (assert_max_stack(b, UNIT_TEST_FILE, __LINE__))
+extern void unit_test_stack_set(void const *);
+extern void assert_max_stack   (uint32_t, unit_test_file_t, int);
+
+#endif // UNIT_TEST_STACK
+
+/**
+ * Heap use (UNIT_TEST_ALLOC). The allocations made while a test case is
+ * active are counted in the current context: alloc_count allocations of
+ * alloc_bytes bytes in all, with at most alloc_peak bytes in use at once.
+ * A test case that ends with memory still allocated fails with a "Memory
+ * Leaked" message. The number of allocations and the peak bytes of a case
+ * that allocates are logged on its "Test Case Passed/Failed" line.
+ *
+ * On a target, call unit_test_alloc_record and unit_test_free_record from
+ * the hooks of the allocator (for example the malloc/free hooks of the RTOS
+ * heap) with the size of each block. On a hosted build, define
+ * UNIT_TEST_ALLOC_WRAP and link with
+ *
+ *     -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free
+ *
+ * The wrappers keep the size of each block in a header in front of it. Only
+ * a block allocated in a test case counts when it is freed, so memory
+ * allocated before the case and freed in it does not hide a leak.
+ *
+ * ASSERT_NO_ALLOC fails if an allocation has been made since
+ * ALLOC_REGION_BEGIN, or since the start of the test case when there is no
+ * ALLOC_REGION_BEGIN. ASSERT_MAX_ALLOC_BYTES fails if more bytes than given
+ * have been allocated since then:
+ *
+ *     frame_pool_init(&pool);
+ *     ALLOC_REGION_BEGIN();
+ *     frame_receive(&pool, data, sizeof(data));
+ *     ASSERT_NO_ALLOC();
+ */
+#ifdef UNIT_TEST_ALLOC
+
+#define ALLOC_REGION_BEGIN()      (alloc_region_begin())
+#define ASSERT_NO_ALLOC()         (assert_max_alloc_count(0, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_MAX_ALLOC_BYTES(b) (assert_max_alloc_bytes(b, UNIT_TEST_FILE, __LINE__))
+extern void unit_test_alloc_record(size_t);
+extern void unit_test_free_record (size_t);
+extern void alloc_region_begin    (void);
+extern void assert_max_alloc_count(uint32_t, unit_test_file_t, int);
+extern void assert_max_alloc_bytes(uint32_t, unit_test_file_t, int);
+
+#endif // UNIT_TEST_ALLOC
+
+/**
+ * Fail fast (UNIT_TEST_FAIL_FAST). A failed assert ends the test case at
+ * once by jumping back to the checkpoint of the case, so the asserts after
+ * it do not run on a broken state. The registry runners set a checkpoint
+ * around each case. A case run by hand sets it after test_case_start, in
+ * the function that calls test_case_end:
+ *
+ *     test_case_start("Test frame decode");
+ *     if (TEST_CASE_CHECKPOINT())
+ *     {
+ *         frame_decode(&frame, data, sizeof(data));
+ *         ASSERT_UINT8_EQ(FRAME_CONFIG, frame.type);
+ *         ...
+ *     }
+ *     test_case_end();
+ *
+ * Without a checkpoint a failed assert carries on as usual. Memory that the
+ * case allocated is not freed when the case is ended early.
+ *
+ * unit_test_fail_fast_set turns the ending of cases on (the default) or off,
+ * and sets the number of failed cases from then on after which the registry
+ * runners stop running cases, 0 (the default) for no limit. The failed cases
+ * are counted per context, so each worker of the parallel and forked runners
+ * stops after that many of its own cases have failed.
+ */
+#ifdef UNIT_TEST_FAIL_FAST
+
+#define TEST_CASE_CHECKPOINT() (0 == setjmp(*unit_test_checkpoint()))
+extern jmp_buf *unit_test_checkpoint  (void);
+extern void     unit_test_fail_fast_set(bool, uint32_t);
+
+#endif // UNIT_TEST_FAIL_FAST
+
+/**
+ * Timeouts (UNIT_TEST_TIMEOUT). A test case that hangs is ended when its
+ * timeout expires: "Test Case Timed Out" is logged, the case fails and the
+ * run goes on at its checkpoint (see "Fail fast" above), so the cases after
+ * it still run. Set a timer function that starts a one-shot timer of the
+ * given length, or stops the timer when called with 0, and call
+ * unit_test_timeout_expired when the timer expires:
+ *
+ *     static void watchdog_timer (uint32_t ms)
+ *     {
+ *         timer_one_shot(TEST_TIMER, ms);   // stops the timer when 0
+ *     }
+ *
+ *     unit_test_timer_set(watchdog_timer);
+ *     unit_test_timeout_set(500);
+ *
+ * unit_test_timeout_expired jumps back to the checkpoint of the case, so it
+ * must be called from a handler that can be left with longjmp. A case
+ * without a checkpoint is only marked failed. On a hosted build,
+ * unit_test_timer_ms is a timer in milliseconds using SIGALRM. There is one
+ * such timer for the process, so it times the cases of one thread, it cannot
+ * be used with the parallel runner. Each worker of the forked runner has
+ * its own.
+ *
+ * The timeout, in the units of the timer, is given with:
+ * - unit_test_timeout_set: the timeout of each case of the current context,
+ *   0 for none
+ * - test_case_timeout: the timeout of the next case started only, before
+ *   test_case_start
+ * - TEST_CASE_TIMEOUT: the timeout of a registered case, in place of
+ *   TEST_CASE. Without UNIT_TEST_TIMEOUT the timeout is left out.
+ */
+#ifdef UNIT_TEST_TIMEOUT
+
+typedef void (*unit_test_timer_t)(uint32_t);
+
+extern void unit_test_timer_set      (unit_test_timer_t);
+extern void unit_test_timeout_set    (uint32_t);
+extern void test_case_timeout        (uint32_t);
+extern void unit_test_timeout_expired(void);
+
+#if defined(__unix__) || defined(__APPLE__)
+#define UNIT_TEST_TIMER_MS 1
+extern void unit_test_timer_ms(uint32_t);
+#endif
+
+#endif // UNIT_TEST_TIMEOUT
+
+/**
+ * Results (UNIT_TEST_RESULTS). Next to the log, a record of each test case
+ * and each failed assert can be written in a format CI reads directly, so the
+ * log text does not have to be parsed. Each record is written as soon as it
+ * is known, nothing is kept for a report at the end of the run. Turn the
+ * records on with a file name, or with a null name to write them to the sink
+ * set with unit_test_results_set_sink, and turn them off when the run is
+ * done:
+ *
+ *     unit_test_results_on("results.jsonl", UNIT_TEST_RESULTS_JSON_LINES);
+ *     ...
+ *     unit_test_results_off();
+ *
+ * UNIT_TEST_RESULTS_JSON_LINES writes one JSON object per line. "suite" and
+ * "suite_end" records start and end a suite, with the suite number of the log
+ * in each record. A "case" record, written when the case ends, has the
+ * suite, the case name, "passed" and the number of failed asserts. An
+ * "assert" record has the file (or "file_id" with UNIT_TEST_FILE_IDS), the
+ * line and the assert message, which holds the expected and actual values:
+ *
+ *     {"record":"assert","suite":3,"case":"Test x","file":"x_test.c",
+ *      "line":42,"message":"expected: 1, got: 2"}
+ *
+ * With timestamps, the case and suite records also have "ticks".
+ *
+ * UNIT_TEST_RESULTS_JUNIT writes JUnit XML: a testsuite element per suite, a
+ * testcase element per case with a failure element per failed assert, and
+ * the ticks as a "ticks" property. The elements are opened as the run goes,
+ * so the counts of a suite are not given as attributes.
+ *
+ * Names and messages longer than a record of UNIT_TEST_RESULTS_MAX_LEN bytes
+ * are cut. Each record is one write to the sink, so the JSON Lines records
+ * of the parallel and forked runners stay whole when the sink is shared, but
+ * the records of suites run at the same time are mixed. In these runs, use
+ * the suite number to group the records; JUnit XML needs the suites to run
+ * one at a time. The record of a case that crashes a worker of the forked
+ * runner is written by the parent.
+ *
+ * The results file needs the stdio log. Without UNIT_TEST_LOG, or with
+ * UNIT_TEST_LOG_NO_STDIO, the file name is ignored and the records are
+ * written to the sink. Without UNIT_TEST_LOG there are no assert messages,
+ * so the "message" of an assert record is empty.
+ */
+#ifdef UNIT_TEST_RESULTS
+
+typedef enum
+{
+    UNIT_TEST_RESULTS_JSON_LINES,
+    UNIT_TEST_RESULTS_JUNIT
+} unit_test_results_format_t;
+
+extern void unit_test_results_on      (char const *, unit_test_results_format_t);
+extern void unit_test_results_off     (void);
+extern void unit_test_results_set_sink(unit_test_sink_t const *);
+
+#endif // UNIT_TEST_RESULTS
+
+/**
+ * Report block (UNIT_TEST_REPORT). The counts of the run and the last
+ * UNIT_TEST_REPORT_MAX_FAILURES failed asserts are kept in unit_test_report,
+ * so a board without a log output can be checked with one memory dump over
+ * SWD/JTAG at the end of the run. Nothing is written out while the tests run,
+ * the counts are updated as each case and suite ends and a failure record is
+ * added for each failed assert.
+ *
+ * With GCC/Clang on ELF targets the block is placed in the section
+ * UNIT_TEST_REPORT_SECTION, which the linker script can put at a fixed
+ * address. The block has an initial value, so the section must be loaded
+ * like .data. unit_test_all_success sets the complete flag, a suite that
+ * starts clears it.
+ *
+ * The layout does not depend on the compiler, all the fields are at their
+ * natural alignment. The values of a failure record are the expected then
+ * the actual value in target byte order, the widths come from the type tag,
+ * a "not equal" failure has one value. The ring holds the failure number n
+ * at recent[n % UNIT_TEST_REPORT_MAX_FAILURES]. On the host,
+ * "unit_test_decode -r [-m <map file>] <dump file>" prints the report from
+ * a dump of the block, for example from GDB:
+ *
+ *     dump binary memory report.bin &unit_test_report (&unit_test_report)+1
+ */
+#define UNIT_TEST_REPORT_MAGIC   "SCRB"
+#define UNIT_TEST_REPORT_VERSION ((uint8_t) 1)
+
+#ifdef UNIT_TEST_REPORT
+
+#ifndef UNIT_TEST_REPORT_MAX_FAILURES
+#define UNIT_TEST_REPORT_MAX_FAILURES 16
+#endif
+
+#ifndef UNIT_TEST_REPORT_SECTION
+#define UNIT_TEST_REPORT_SECTION ".unit_test_report"
+#endif
+
+#if (UNIT_TEST_REPORT_MAX_FAILURES < 1) || (UNIT_TEST_REPORT_MAX_FAILURES > 255)
+#error "UNIT_TEST_REPORT_MAX_FAILURES must be 1 to 255"
+#endif
+
+//! A failed assert in the report block
+typedef struct
+{
+    uint16_t file;               //!< file id
+    uint16_t line;
+    uint16_t suite;              //!< number of the test suite
+    uint8_t  type;               //!< type tag of the values
+    uint8_t  len;                //!< number of bytes of values
+    uint8_t  values[16];
+} unit_test_report_failure_t;
+
+//! The report block, see "Report block" above
+typedef struct
+{
+    uint8_t                    magic[4];
+    uint8_t                    version;
+    uint8_t                    little_endian;
+    uint8_t                    max_failures;
+    uint8_t                    complete;
+    unit_test_stats_t          stats;
+    uint32_t                   failures;
+    unit_test_report_failure_t recent[UNIT_TEST_REPORT_MAX_FAILURES];
+} unit_test_report_t;
+
+extern unit_test_report_t unit_test_report;
+
+#endif // UNIT_TEST_REPORT
+
+/**
+ * Test registry. Instead of calling test_suite_start/test_case_start by hand,
+ * test cases can be registered with TEST_SUITE and TEST_CASE and run with
+ * unit_test_run. The filter passed to unit_test_run selects the cases to run,
+ * it can come from a debugger-writable variable or a command received over a
+ * UART, so a subset of the tests can be run without rebuilding or reflashing.
+ *
+ *     TEST_SUITE(packet_suite, "Packet Builder Test Suite");
+ *
+ *     TEST_CASE(packet_suite, test_config_frame_build,
+ *         "Verify config frame correctly built")
+ *     {
+ *         config_frame_build();
+ *         ASSERT_BOOL_EQ(true, config_frame.config_valid);
+ *     }
+ *
+ *     (void) unit_test_run("Packet*");
+ *
+ * With GCC/Clang on ELF targets, TEST_CASE places a pointer to the case in
+ * the unit_test_cases linker section and unit_test_run finds the cases
+ * through the __start_/__stop_ symbols the linker provides for it. A custom
+ * linker script must keep the section (KEEP(*(unit_test_cases))) and define
+ * these symbols. With other toolchains, list the cases, named
+ * <function>_case, in a table and pass it to unit_test_registry_set:
+ *
+ *     static unit_test_case_t const * const cases[] =
+ *     {
+ *         &test_config_frame_build_case,
+ *     };
+ *
+ *     unit_test_registry_set(cases, sizeof(cases) / sizeof(cases[0]));
+ *
+ * Each suite is run once, with its cases in registry order. The order of the
+ * linker section is the link order, which is not necessarily source order,
+ * GCC reorders the cases of a file unless built with -fno-toplevel-reorder.
+ *
+ * The filter is a comma separated list of patterns, NULL or "" runs all the
+ * cases. A pattern "suite/case" selects by both names, any other pattern
+ * selects the cases where either the suite or the case name matches. In a
+ * pattern, '*' matches any characters and '?' matches one character.
+ *
+ * To split a run over several processes or machines, unit_test_shard_set
+ * takes a shard "i/n" (0 <= i < n), for example from a --shard option. The
+ * runners then only run every n-th selected suite, starting with suite i.
+ */
+#ifdef UNIT_TEST_REGISTRY
+
+/**
+ * Fixtures (UNIT_TEST_FIXTURES). A suite declared with TEST_SUITE_FIXTURE
+ * has a fixture, a set of hooks that the registry runners call around its
+ * cases. Any of the hooks can be null.
+ *
+ * suite_setup builds the state shared by the cases of the suite, such as a
+ * loaded table or a simulated peripheral. It is called once, before the
+ * first case of the suite that runs, and suite_teardown is called after the
+ * last one. A case that changes the shared state calls
+ * unit_test_fixture_dirty, the fixture is then torn down and built again
+ * before the next case of the suite.
+ *
+ * case_setup and case_teardown are called around each case, after
+ * test_case_start and before test_case_end, so their asserts count for the
+ * case. With UNIT_TEST_FAIL_FAST case_teardown is also called when the case
+ * ends early, which may be during case_setup.
+ *
+ *     static calibration_t table;
+ *
+ *     static void table_load (void)
+ *     {
+ *         calibration_load(&table, "calibration.bin");
+ *     }
+ *
+ *     static unit_test_fixture_t const table_fixture =
+ *     {
+ *         table_load, 0, 0, 0
+ *     };
+ *
+ *     TEST_SUITE_FIXTURE(gain_suite, "Gain Test Suite", table_fixture);
+ *
+ * The asserts of suite_setup and suite_teardown are made outside a case,
+ * they are logged and fail the run but no case. The suites of the parallel
+ * runner build their fixtures on their own worker, and each worker process
+ * of the forked runner builds the fixtures of the suites it runs.
+ */
+#ifdef UNIT_TEST_FIXTURES
+typedef struct
+{
+    void (*suite_setup)(void);
+    void (*suite_teardown)(void);
+    void (*case_setup)(void);
+    void (*case_teardown)(void);
+} unit_test_fixture_t;
+#endif
+
+typedef struct
+{
+    char const                *name;
+    #ifdef UNIT_TEST_FIXTURES
+    unit_test_fixture_t const *fixture;
+    #endif
+} unit_test_suite_t;
+
+typedef struct
+{
+    unit_test_suite_t const *suite;
+    char const              *name;
+    void                   (*function)(void);
+    #ifdef UNIT_TEST_TIMEOUT
+    uint32_t                 timeout;
+    #endif
+    #ifdef UNIT_TEST_PARAMS
+    void                   (*param_function)(void const *);
+    void const              *params;
+    uint32_t                 param_count;
+    uint32_t                 param_size;
+    #endif
+} unit_test_case_t;
+
+#if defined(__GNUC__) && defined(__ELF__)
+#define UNIT_TEST_REGISTRY_SECTION 1
+#define UNIT_TEST_REGISTER(test) \
+    static unit_test_case_t const * const test##_entry \
+        __attribute__((used, section("unit_test_cases"))) = &test;
+#else
+#define UNIT_TEST_REGISTER(test)
+#endif
+
+#ifdef UNIT_TEST_FIXTURES
+#define TEST_SUITE(suite, suite_name) \
+    unit_test_suite_t const suite = { suite_name, 0 }
+
+#define TEST_SUITE_FIXTURE(suite, suite_name, fixture) \
+    unit_test_suite_t const suite = { suite_name, &fixture }
+#else
+#define TEST_SUITE(suite, suite_name) \
+    unit_test_suite_t const suite = { suite_name }
+#endif
+
+#ifdef UNIT_TEST_TIMEOUT
+#define UNIT_TEST_TIMEOUT_FIELD(timeout) , timeout
+#else
+#define UNIT_TEST_TIMEOUT_FIELD(timeout)
+#endif
+
+#ifdef UNIT_TEST_PARAMS
+#define UNIT_TEST_PARAM_FIELDS(function, table, count, size) \
+    , function, table, count, size
+#else
+#define UNIT_TEST_PARAM_FIELDS(function, table, count, size)
+#endif
+
+#define UNIT_TEST_CASE_ENTRY(suite, function, case_name, timeout) \
+    { &suite, case_name, function UNIT_TEST_TIMEOUT_FIELD(timeout) UNIT_TEST_PARAM_FIELDS(0, 0, 0, 0) }
+
+#define TEST_CASE(suite, function, case_name) \
+    TEST_CASE_TIMEOUT(suite, function, case_name, 0)
+
+#define TEST_CASE_TIMEOUT(suite, function, case_name, timeout) \
+    static void function(void); \
+    unit_test_case_t const function##_case = UNIT_TEST_CASE_ENTRY(suite, function, case_name, timeout); \
+    UNIT_TEST_REGISTER(function##_case) \
+    static void function(void)
+
+/**
+ * Parameterized test cases (UNIT_TEST_PARAMS). TEST_CASE_PARAM registers a
+ * test case that runs its body once for each element of a const table, such
+ * as the vectors of a codec, which stays in flash on most targets. The body
+ * gets the element as TEST_PARAM(type) and its index from
+ * unit_test_param_index:
+ *
+ *     typedef struct
+ *     {
+ *         uint8_t  input[4];
+ *         uint16_t crc;
+ *     } crc_vector_t;
+ *
+ *     static crc_vector_t const crc_vectors[] =
+ *     {
+ *         { { 0x01, 0x02, 0x03, 0x04 }, 0x89c3 },
+ *         ...
+ *     };
+ *
+ *     TEST_CASE_PARAM(crc_suite, test_crc_vectors, "CRC of the vectors",
+ *         crc_vectors, sizeof(crc_vectors) / sizeof(crc_vectors[0]))
+ *     {
+ *         crc_vector_t const *const vector = TEST_PARAM(crc_vector_t);
+ *
+ *         ASSERT_UINT16_EQ(vector->crc, crc16(vector->input, 4));
+ *     }
+ *
+ * The whole table is one test case: it is started, timed and logged once
+ * and passes if every element passes. The first failed assert of an element
+ * is logged after the index of the element, and a case that failed ends
+ * with the number of elements that failed and the first of them. With
+ * UNIT_TEST_FAIL_FAST a failed assert ends the element, the next element
+ * still runs. A timeout ends the whole case.
+ */
+#ifdef UNIT_TEST_PARAMS
+#define UNIT_TEST_PARAM_ENTRY(suite, function, case_name, table, count) \
+    { &suite, case_name, 0 UNIT_TEST_TIMEOUT_FIELD(0) UNIT_TEST_PARAM_FIELDS(function, table, count, sizeof((table)[0])) }
+
+#define TEST_CASE_PARAM(suite, function, case_name, table, count) \
+    static void function(void const *); \
+    unit_test_case_t const function##_case = UNIT_TEST_PARAM_ENTRY(suite, function, case_name, table, (uint32_t) (count)); \
+    UNIT_TEST_REGISTER(function##_case) \
+    static void function(void const *unit_test_param)
+
+#define TEST_PARAM(type) ((type const *) unit_test_param)
+
+extern uint32_t unit_test_param_index(void);
+#endif
+
+extern void     unit_test_registry_set(unit_test_case_t const * const *, size_t);
+extern bool     unit_test_shard_set   (char const *);
+extern uint32_t unit_test_run         (char const *);
+
+#ifdef UNIT_TEST_FIXTURES
+extern void     unit_test_fixture_dirty(void);
+#endif
 
 /**
- * Using conditional compilation, the unit test framework can be configured to 
- * exclude support for logging, 64-bit integer and floating point numbers.
- * Define the following constants in your code or environment to include/exclude
- * support for these.
- * 
- * By default, support for logging is on and support for 64-bit integer and
- * floating point is configured off.
- * 
- * - UNIT_TEST_LOG
- * - UNIT_TEST_INT64
- * - UNIT_TEST_FLOATING_POINT
+ * Parallel runner (UNIT_TEST_PARALLEL). unit_test_run_parallel selects the
+ * cases like unit_test_run and runs the suites on a pool of worker threads,
+ * 0 workers uses one per online processor. Each worker takes the suites
+ * queued for it and then steals suites queued for the other workers, so a
+ * slow suite does not leave the other processors idle. The cases of a suite
+ * run on one worker, one after the other.
+ *
+ * The log output of each suite is buffered and written to the sink of the
+ * calling thread in registry order, with the same suite numbers, so the log
+ * is the same as the log of unit_test_run. A failed assert in any worker is
+ * reported by unit_test_all_success of the calling thread. The test cases
+ * of different suites must not share unprotected state.
  */
-#define UNIT_TEST_LOG  1
+#ifdef UNIT_TEST_PARALLEL
+extern uint32_t unit_test_run_parallel(char const *, unsigned);
+#endif
 
 /**
- * Declarations for unit test framework functions.
+ * Process isolated runner (UNIT_TEST_FORK). unit_test_run_forked selects the
+ * suites like unit_test_run and forks worker processes, 0 workers uses one
+ * per online processor. Worker k runs the suites k, k + workers, ... and
+ * sends its log output and the progress of its cases back over a pipe. The
+ * log of each suite is written to the sink of the caller in registry order,
+ * the same as the log of unit_test_run.
+ *
+ * A worker that is killed by a signal, or exits, while running a test case
+ * is logged as a failed test case with the signal number or exit status. A
+ * new worker is forked for the rest of the suites of the worker. A test case
+ * that hangs is not detected, the run then waits for it.
+ */
+#ifdef UNIT_TEST_FORK
+extern uint32_t unit_test_run_forked  (char const *, unsigned);
+#endif
+
+/**
+ * Rerun of failed cases (UNIT_TEST_RERUN). The outcome of the test cases is
+ * kept in a record of up to UNIT_TEST_RERUN_MAX_CASES cases, found by a hash
+ * of the suite and case names. A case is added to the record when it first
+ * fails, from then on its runs and failures are counted and the record holds
+ * whether it failed the last time it ran. When the record is full, a case
+ * that passed the last time gives its place to a new failure.
+ *
+ * When logging is turned on with a file name, the record is loaded from the
+ * file <file name>.rerun if it exists and unit_test_log_off writes it back.
+ * Each line of the file holds the hash in hex, the runs, the failures and 1
+ * if the case failed the last time:
+ *
+ *     8f3a12bc 12 3 1
+ *
+ * On a target, the record can be kept in RAM that is not cleared at reset,
+ * or read from flash and written back after the run by the application, and
+ * given to unit_test_rerun_record_set. A record without the magic or with a
+ * bad check value, such as the first time after power up, is cleared.
+ *
+ *     static unit_test_rerun_record_t rerun_record
+ *         __attribute__((section(".noinit")));
+ *
+ *     unit_test_rerun_record_set(&rerun_record);
+ *     unit_test_run_mode_set(UNIT_TEST_RUN_FAILED_FIRST);
+ *
+ * unit_test_run_mode_set chooses how the runners use the record, the filter
+ * and shard still select the cases:
+ *
+ * - UNIT_TEST_RUN_ALL runs the selected cases in registry order (default).
+ * - UNIT_TEST_RUN_FAILED_FIRST runs the cases that failed the last time
+ *   first, then the cases that failed in earlier runs, then the rest.
+ * - UNIT_TEST_RUN_FAILED_ONLY runs only the cases that failed the last time,
+ *   nothing if there are none.
+ *
+ * Failed cases are run in order of their failure rate, the failures in
+ * percent of the runs counted, highest first. The cases of the same rate are
+ * run as a pass of the runner, in registry order, so a suite with cases of
+ * several rates is started once for each of them.
+ */
+#ifdef UNIT_TEST_RERUN
+
+#ifndef UNIT_TEST_RERUN_MAX_CASES
+#define UNIT_TEST_RERUN_MAX_CASES 64
+#endif
+
+typedef enum
+{
+    UNIT_TEST_RUN_ALL,
+    UNIT_TEST_RUN_FAILED_FIRST,
+    UNIT_TEST_RUN_FAILED_ONLY
+} unit_test_run_mode_t;
+
+//! A test case that has failed, see "Rerun of failed cases" above
+typedef struct
+{
+    uint32_t hash;
+    uint16_t runs;
+    uint16_t fails;
+    uint8_t  failed;
+    uint8_t  rank;
+} unit_test_rerun_entry_t;
+
+//! The record of the failed test cases, see "Rerun of failed cases" above
+typedef struct
+{
+    uint32_t                magic;
+    uint32_t                check;
+    uint16_t                count;
+    unit_test_rerun_entry_t entries[UNIT_TEST_RERUN_MAX_CASES];
+} unit_test_rerun_record_t;
+
+extern void unit_test_run_mode_set    (unit_test_run_mode_t);
+extern void unit_test_rerun_record_set(unit_test_rerun_record_t *);
+
+#endif // UNIT_TEST_RERUN
+
+#endif // UNIT_TEST_REGISTRY
+
+/**
+ * Compiler hints for the inline asserts, the failure path is kept out of line
+ * and marked as unlikely.
  */
-extern void unit_test_log_on     (char const *);
-extern void unit_test_log_off    (void);
-extern bool unit_test_all_success(void);
-extern void test_suite_start     (char const *);
-extern void test_suite_end       (void);
-extern void test_case_start      (char const *);
-extern void test_case_end        (void);
+#if defined(__GNUC__)
+#define UNIT_TEST_COLD        __attribute__((cold, noinline))
+#define UNIT_TEST_UNLIKELY(x) (__builtin_expect(!!(x), 0))
+#else
+#define UNIT_TEST_COLD
+#define UNIT_TEST_UNLIKELY(x) (x)
+#endif
+
+#ifdef UNIT_TEST_INLINE_ASSERTS
+#define UNIT_TEST_ASSERT_FN(fn) fn##_inline
+#else
+#define UNIT_TEST_ASSERT_FN(fn) fn
+#endif
 
 /**
  * Use these asserts to verify test results. Call the assert functions directly
  * or use the provided macros.
  */
-#define ASSERT_BOOL_EQ(e,a)     (assert_bool_eq    (e, a, __FILE__, __LINE__))
-#define ASSERT_BOOL_NOT_EQ(e,a) (assert_bool_not_eq(e, a, __FILE__, __LINE__))
-extern void assert_bool_eq    (bool, bool, char const *, int);
-extern void assert_bool_not_eq(bool, bool, char const *, int);
-
-#define ASSERT_INT8_EQ(e,a)      (assert_int8_eq     (e, a, __FILE__, __LINE__))
-#define ASSERT_INT8_NOT_EQ(e,a)  (assert_int8_not_eq (e, a, __FILE__, __LINE__))
-#define ASSERT_UINT8_EQ(e,a)     (assert_uint8_eq    (e, a, __FILE__, __LINE__))
-#define ASSERT_UINT8_NOT_EQ(e,a) (assert_uint8_not_eq(e, a, __FILE__, __LINE__))
-extern void assert_int8_eq     (int8_t,  int8_t,  char const *, int);
-extern void assert_int8_not_eq (int8_t,  int8_t,  char const *, int);
-extern void assert_uint8_eq    (uint8_t, uint8_t, char const *, int);
-extern void assert_uint8_not_eq(uint8_t, uint8_t, char const *, int);
-
-#define ASSERT_INT16_EQ(e,a)      (assert_int16_eq     (e, a, __FILE__, __LINE__))
-#define ASSERT_INT16_NOT_EQ(e,a)  (assert_int16_not_eq (e, a, __FILE__, __LINE__))
-#define ASSERT_UINT16_EQ(e,a)     (assert_uint16_eq    (e, a, __FILE__, __LINE__))
-#define ASSERT_UINT16_NOT_EQ(e,a) (assert_uint16_not_eq(e, a, __FILE__, __LINE__))
-extern void assert_int16_eq     (int16_t,  int16_t,  char const *, int);
-extern void assert_int16_not_eq (int16_t,  int16_t,  char const *, int);
-extern void assert_uint16_eq    (uint16_t, uint16_t, char const *, int);
-extern void assert_uint16_not_eq(uint16_t, uint16_t, char const *, int);
-
-#define ASSERT_INT32_EQ(e,a)      (assert_int32_eq     (e, a, __FILE__, __LINE__))
-#define ASSERT_INT32_NOT_EQ(e,a)  (assert_int32_not_eq (e, a, __FILE__, __LINE__))
-#define ASSERT_UINT32_EQ(e,a)     (assert_uint32_eq    (e, a, __FILE__, __LINE__))
-#define ASSERT_UINT32_NOT_EQ(e,a) (assert_uint32_not_eq(e, a, __FILE__, __LINE__))
-extern void assert_int32_eq     (int32_t,  int32_t,  char const *, int);
-extern void assert_int32_not_eq (int32_t,  int32_t,  char const *, int);
-extern void assert_uint32_eq    (uint32_t, uint32_t, char const *, int);
-extern void assert_uint32_not_eq(uint32_t, uint32_t, char const *, int);
+#define ASSERT_BOOL_EQ(e,a)     (UNIT_TEST_ASSERT_FN(assert_bool_eq)    (e, a, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_BOOL_NOT_EQ(e,a) (UNIT_TEST_ASSERT_FN(assert_bool_not_eq)(e, a, UNIT_TEST_FILE, __LINE__))
+extern void assert_bool_eq    (bool, bool, unit_test_file_t, int);
+extern void assert_bool_not_eq(bool, bool, unit_test_file_t, int);
+
+#define ASSERT_INT8_EQ(e,a)      (UNIT_TEST_ASSERT_FN(assert_int8_eq)     (e, a, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_INT8_NOT_EQ(e,a)  (UNIT_TEST_ASSERT_FN(assert_int8_not_eq) (e, a, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_UINT8_EQ(e,a)     (UNIT_TEST_ASSERT_FN(assert_uint8_eq)    (e, a, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_UINT8_NOT_EQ(e,a) (UNIT_TEST_ASSERT_FN(assert_uint8_not_eq)(e, a, UNIT_TEST_FILE, __LINE__))
+extern void assert_int8_eq     (int8_t,  int8_t,  unit_test_file_t, int);
+extern void assert_int8_not_eq (int8_t,  int8_t,  unit_test_file_t, int);
+extern void assert_uint8_eq    (uint8_t, uint8_t, unit_test_file_t, int);
+extern void assert_uint8_not_eq(uint8_t, uint8_t, unit_test_file_t, int);
+
+#define ASSERT_INT16_EQ(e,a)      (UNIT_TEST_ASSERT_FN(assert_int16_eq)     (e, a, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_INT16_NOT_EQ(e,a)  (UNIT_TEST_ASSERT_FN(assert_int16_not_eq) (e, a, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_UINT16_EQ(e,a)     (UNIT_TEST_ASSERT_FN(assert_uint16_eq)    (e, a, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_UINT16_NOT_EQ(e,a) (UNIT_TEST_ASSERT_FN(assert_uint16_not_eq)(e, a, UNIT_TEST_FILE, __LINE__))
+extern void assert_int16_eq     (int16_t,  int16_t,  unit_test_file_t, int);
+extern void assert_int16_not_eq (int16_t,  int16_t,  unit_test_file_t, int);
+extern void assert_uint16_eq    (uint16_t, uint16_t, unit_test_file_t, int);
+extern void assert_uint16_not_eq(uint16_t, uint16_t, unit_test_file_t, int);
+
+#define ASSERT_INT32_EQ(e,a)      (UNIT_TEST_ASSERT_FN(assert_int32_eq)     (e, a, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_INT32_NOT_EQ(e,a)  (UNIT_TEST_ASSERT_FN(assert_int32_not_eq) (e, a, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_UINT32_EQ(e,a)     (UNIT_TEST_ASSERT_FN(assert_uint32_eq)    (e, a, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_UINT32_NOT_EQ(e,a) (UNIT_TEST_ASSERT_FN(assert_uint32_not_eq)(e, a, UNIT_TEST_FILE, __LINE__))
+extern void assert_int32_eq     (int32_t,  int32_t,  unit_test_file_t, int);
+extern void assert_int32_not_eq (int32_t,  int32_t,  unit_test_file_t, int);
+extern void assert_uint32_eq    (uint32_t, uint32_t, unit_test_file_t, int);
+extern void assert_uint32_not_eq(uint32_t, uint32_t, unit_test_file_t, int);
+
+/**
+ * Buffer and array asserts. The buffers are compared a word at a time, or
+ * 16 bytes at a time with SSE2 or NEON, so large frames are cheap to check.
+ * A mismatch is logged as one failure with the index of the first difference
+ * and the number of differences, followed by UNIT_TEST_MEM_WINDOW bytes of
+ * both buffers around the first difference:
+ *
+ *     Assert Failed in File: frame_test.c, Line 42:  first difference at index 1029, differences: 3
+ *     Bytes from Offset 1024:
+ *         Expected: 00 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f
+ *         Got:      00 01 02 03 04 ff 06 07 08 09 0a 0b 0c 0d 0e 0f
+ *
+ * The index and the number of differences of the array asserts count
+ * elements, the offset of the bytes counts bytes.
+ */
+#ifndef UNIT_TEST_MEM_WINDOW
+#define UNIT_TEST_MEM_WINDOW 16
+#endif
+
+#if (UNIT_TEST_MEM_WINDOW < 8) || (UNIT_TEST_MEM_WINDOW > 64)
+#error "UNIT_TEST_MEM_WINDOW must be 8 to 64 bytes"
+#endif
+
+#define ASSERT_MEM_EQ(e,a,n)          (assert_mem_eq         (e, a, n, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_UINT16_ARRAY_EQ(e,a,n) (assert_uint16_array_eq(e, a, n, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_UINT32_ARRAY_EQ(e,a,n) (assert_uint32_array_eq(e, a, n, UNIT_TEST_FILE, __LINE__))
+extern void assert_mem_eq         (void const *,     void const *,     size_t, unit_test_file_t, int);
+extern void assert_uint16_array_eq(uint16_t const *, uint16_t const *, size_t, unit_test_file_t, int);
+extern void assert_uint32_array_eq(uint32_t const *, uint32_t const *, size_t, unit_test_file_t, int);
 
 /**
  *  64-bit integer support
  */
 #ifdef UNIT_TEST_INT64
 
-#define ASSERT_INT64_EQ(e,a)      (assert_int64_eq     (e, a, __FILE__, __LINE__))
-#define ASSERT_INT64_NOT_EQ(e,a)  (assert_int64_not_eq (e, a, __FILE__, __LINE__))
-#define ASSERT_UINT64_EQ(e,a)     (assert_uint64_eq    (e, a, __FILE__, __LINE__))
-#define ASSERT_UINT64_NOT_EQ(e,a) (assert_uint64_not_eq(e, a, __FILE__, __LINE__))
-extern void assert_int64_eq     (int64_t,  int64_t,  char const *, int);
-extern void assert_int64_not_eq (int64_t,  int64_t,  char const *, int);
-extern void assert_uint64_eq    (uint64_t, uint64_t, char const *, int);
-extern void assert_uint64_not_eq(uint64_t, uint64_t, char const *, int);
+#define ASSERT_INT64_EQ(e,a)      (UNIT_TEST_ASSERT_FN(assert_int64_eq)     (e, a, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_INT64_NOT_EQ(e,a)  (UNIT_TEST_ASSERT_FN(assert_int64_not_eq) (e, a, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_UINT64_EQ(e,a)     (UNIT_TEST_ASSERT_FN(assert_uint64_eq)    (e, a, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_UINT64_NOT_EQ(e,a) (UNIT_TEST_ASSERT_FN(assert_uint64_not_eq)(e, a, UNIT_TEST_FILE, __LINE__))
+extern void assert_int64_eq     (int64_t,  int64_t,  unit_test_file_t, int);
+extern void assert_int64_not_eq (int64_t,  int64_t,  unit_test_file_t, int);
+extern void assert_uint64_eq    (uint64_t, uint64_t, unit_test_file_t, int);
+extern void assert_uint64_not_eq(uint64_t, uint64_t, unit_test_file_t, int);
 
 #endif
 
@@ -271,23 +1664,1025 @@ typedef double float64_t;
  */
 #define MAX_FLOAT_ABSOLUTE_ERROR ((float64_t) 1.0e-37)
 
-#define ASSERT_FLOAT32_EQ(e,a)     (assert_float32_eq     (e, a, __FILE__, __LINE__))
-#define ASSERT_FLOAT32_NOT_EQ(e,a) (assert_float32_not_eq (e, a, __FILE__, __LINE__))
-#define ASSERT_FLOAT64_EQ(e,a)     (assert_float64_eq     (e, a, __FILE__, __LINE__))
-#define ASSERT_FLOAT64_NOT_EQ(e,a) (assert_float64_not_eq (e, a, __FILE__, __LINE__))
-extern void assert_float32_eq    (float32_t, float32_t, char const *, int);
-extern void assert_float32_not_eq(float32_t, float32_t, char const *, int);
-extern void assert_float64_eq    (float64_t, float64_t, char const *, int);
-extern void assert_float64_not_eq(float64_t, float64_t, char const *, int);
+#define ASSERT_FLOAT32_EQ(e,a)     (UNIT_TEST_ASSERT_FN(assert_float32_eq)     (e, a, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_FLOAT32_NOT_EQ(e,a) (UNIT_TEST_ASSERT_FN(assert_float32_not_eq) (e, a, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_FLOAT64_EQ(e,a)     (UNIT_TEST_ASSERT_FN(assert_float64_eq)     (e, a, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_FLOAT64_NOT_EQ(e,a) (UNIT_TEST_ASSERT_FN(assert_float64_not_eq) (e, a, UNIT_TEST_FILE, __LINE__))
+extern void assert_float32_eq    (float32_t, float32_t, unit_test_file_t, int);
+extern void assert_float32_not_eq(float32_t, float32_t, unit_test_file_t, int);
+extern void assert_float64_eq    (float64_t, float64_t, unit_test_file_t, int);
+extern void assert_float64_not_eq(float64_t, float64_t, unit_test_file_t, int);
+
+/**
+ * Float array asserts, for comparing the output of filters and other DSP
+ * code. The arrays are compared in float32, 4 elements at a time with SSE or
+ * NEON, with the tolerance given to each call:
+ *
+ * - ASSERT_FLOAT32_ARRAY_NEAR fails for an element that differs from the
+ *   expected value by more than tol
+ * - ASSERT_FLOAT32_ARRAY_ULPS fails for an element that is more than ulps
+ *   representable floats away from the expected value
+ *
+ * A NaN always fails. One failure is logged with the number of elements out
+ * of tolerance, followed by the index and values of the element with the
+ * worst error and the max and mean error over the whole array:
+ *
+ *     Assert Failed in File: filter_test.c, Line 42:  3 of 65536 elements out of tolerance
+ *     Worst Error at Index 1029, Expected: 2.50000000e-01, Got: 3.00000012e-01
+ *     Max Error: 5.000000e-02, Mean Error: 2.288818e-06
+ */
+#define ASSERT_FLOAT32_ARRAY_NEAR(e,a,n,tol)  (assert_float32_array_near(e, a, n, tol,  UNIT_TEST_FILE, __LINE__))
+#define ASSERT_FLOAT32_ARRAY_ULPS(e,a,n,ulps) (assert_float32_array_ulps(e, a, n, ulps, UNIT_TEST_FILE, __LINE__))
+extern void assert_float32_array_near(float32_t const *, float32_t const *, size_t, float32_t, unit_test_file_t, int);
+extern void assert_float32_array_ulps(float32_t const *, float32_t const *, size_t, uint32_t,  unit_test_file_t, int);
+
+#endif
+
+/**
+ * Property tests (UNIT_TEST_PROPERTY). A property is a function that takes
+ * its inputs from the generators below and asserts something that must hold
+ * for any of them. unit_test_property_check runs it with new inputs the
+ * given number of times:
+ *
+ *     static void property_frame_round_trip (void)
+ *     {
+ *         uint16_t const length = (uint16_t) unit_test_gen_uint32_range(0, 64);
+ *         uint8_t  const type   = unit_test_gen_uint8();
+ *
+ *         frame_build(&frame, type, length);
+ *         ASSERT_UINT16_EQ(length, frame_length(&frame));
+ *     }
+ *
+ *     (void) unit_test_property_check(property_frame_round_trip, 100000);
+ *
+ * The runs are not logged, and their asserts do not count in the stats. The
+ * inputs come from a xorshift32 generator, so they are the same on every
+ * target for a given seed, and no heap is used.
+ *
+ * When a run fails, its input is shrunk. Each generated value is recorded,
+ * up to UNIT_TEST_PROPERTY_MAX_DRAWS per run. The recorded values are made
+ * smaller one at a time (towards 0, the low end of a range or 0.0) for as
+ * long as the property still fails, in up to
+ * UNIT_TEST_PROPERTY_MAX_SHRINKS runs. The property then runs once more
+ * with the smallest failing input, and that run is logged as usual, after
+ * a line with the seed:
+ *
+ *     Property Failed, Seed: 0x2545f491, Iteration: 917, Shrink Steps: 41
+ *     Assert Failed in File: frame_test.c, Line 12:  expected: 64, got: 0
+ *
+ * Each check uses the seed of the context and then moves it on, so a run of
+ * the same checks in the same order always generates the same inputs. To
+ * replay one failure, pass its seed to unit_test_property_seed before the
+ * check. A run is ended at its first failed assert only with
+ * UNIT_TEST_FAIL_FAST.
+ */
+#ifdef UNIT_TEST_PROPERTY
+extern bool     unit_test_property_check      (void (*)(void), uint32_t);
+extern void     unit_test_property_seed       (uint32_t);
+extern bool     unit_test_gen_bool            (void);
+extern int8_t   unit_test_gen_int8            (void);
+extern uint8_t  unit_test_gen_uint8           (void);
+extern int16_t  unit_test_gen_int16           (void);
+extern uint16_t unit_test_gen_uint16          (void);
+extern int32_t  unit_test_gen_int32           (void);
+extern uint32_t unit_test_gen_uint32          (void);
+extern int32_t  unit_test_gen_int32_range     (int32_t, int32_t);
+extern uint32_t unit_test_gen_uint32_range    (uint32_t, uint32_t);
+#ifdef UNIT_TEST_INT64
+extern int64_t  unit_test_gen_int64           (void);
+extern uint64_t unit_test_gen_uint64          (void);
+#endif
+#ifdef UNIT_TEST_FLOATING_POINT
+extern float32_t unit_test_gen_float32        (void);
+extern float64_t unit_test_gen_float64        (void);
+extern float64_t unit_test_gen_float64_range  (float64_t, float64_t);
+#endif
+#endif // UNIT_TEST_PROPERTY
+
+/**
+ * Binary log records. Every message the framework logs has an event id. In
+ * text mode the format string of the event is printed, in binary mode
+ * (UNIT_TEST_LOG_BINARY) only the event id and the raw arguments are written.
+ * These tables are shared with unit_test_decode.c so the host can expand the
+ * records back into the text format.
+ *
+ * A binary log starts with the 4 magic bytes "SCLB", a version byte and a
+ * byte that is 1 if the target is little endian. All multi-byte fields in a
+ * record are little endian, values are copied as raw target bytes.
+ *
+ * Record layout by argument kind, each record starts with the event id byte:
+ * - UNIT_TEST_ARG_NONE: nothing else
+ * - UNIT_TEST_ARG_NUM:  uint16_t number
+ * - UNIT_TEST_ARG_U32:  uint32_t number
+ * - UNIT_TEST_ARG_STR:  uint8_t length, string bytes (no terminator)
+ * - UNIT_TEST_ARG_FILE: uint16_t file id, uint8_t length, file name bytes
+ * - UNIT_TEST_ARG_HEX:  uint8_t length, raw bytes printed as hex
+ * - UNIT_TEST_ARG_FLOAT: float64_t value, raw target bytes
+ * - UNIT_TEST_ARG_FAIL: uint16_t file id (the UNIT_TEST_FILE_ID with
+ *                       UNIT_TEST_FILE_IDS), uint16_t line, uint8_t type tag,
+ *                       uint8_t length, expected value bytes and for
+ *                       UNIT_TEST_EVT_ASSERT_EQ the actual value bytes
+ *
+ * X(event id, text format, argument kind)
+ */
+#define UNIT_TEST_LOG_EVENTS(X) \
+    X(UNIT_TEST_EVT_SUITE_NUM,            "\n\nTest Suite Number: %d",                            UNIT_TEST_ARG_NUM)  \
+    X(UNIT_TEST_EVT_SUITE_NAME,           "\nTest Suite Name: %s",                                 UNIT_TEST_ARG_STR)  \
+    X(UNIT_TEST_EVT_SUITE_ACTIVE,         "\n\nERROR: A test suite is already active.",            UNIT_TEST_ARG_NONE) \
+    X(UNIT_TEST_EVT_SUITE_ONE_AT_A_TIME,  "\nOnly one test suite can be executed at a time.\n",   UNIT_TEST_ARG_NONE) \
+    X(UNIT_TEST_EVT_SUITE_COMPLETE,       "\n\nTest Suite Complete\n",                             UNIT_TEST_ARG_NONE) \
+    X(UNIT_TEST_EVT_SUITE_NOT_ACTIVE,     "\n\nERROR: A test suite is not active.",                UNIT_TEST_ARG_NONE) \
+    X(UNIT_TEST_EVT_SUITE_CALL_START,     "\nCall 'test_suite_start' first.\n",                    UNIT_TEST_ARG_NONE) \
+    X(UNIT_TEST_EVT_CANNOT_EXECUTE,       "\nCannot execute \"%s\"",                               UNIT_TEST_ARG_STR)  \
+    X(UNIT_TEST_EVT_CASE_NAME,            "\n\nTest Case: %s",                                     UNIT_TEST_ARG_STR)  \
+    X(UNIT_TEST_EVT_CASE_ACTIVE,          "\n\nERROR: A test case is already active.",             UNIT_TEST_ARG_NONE) \
+    X(UNIT_TEST_EVT_CASE_ONE_AT_A_TIME,   "\nOnly one test case can be executed at a time.\n",    UNIT_TEST_ARG_NONE) \
+    X(UNIT_TEST_EVT_CASE_PASSED,          "\nTest Case Passed",                                    UNIT_TEST_ARG_NONE) \
+    X(UNIT_TEST_EVT_CASE_FAILED,          "\nTest Case Failed",                                    UNIT_TEST_ARG_NONE) \
+    X(UNIT_TEST_EVT_CASE_NOT_ACTIVE,      "\n\nERROR: A test case is not active.",                 UNIT_TEST_ARG_NONE) \
+    X(UNIT_TEST_EVT_CASE_CALL_START,      "\nCall the 'test_case_start' function first.\n",       UNIT_TEST_ARG_NONE) \
+    X(UNIT_TEST_EVT_FILE,                 "",                                                     UNIT_TEST_ARG_FILE) \
+    X(UNIT_TEST_EVT_ASSERT_EQ,            "\n    Assert Failed in File: %s, Line %d: %s",        UNIT_TEST_ARG_FAIL) \
+    X(UNIT_TEST_EVT_ASSERT_NOT_EQ,        "\n    Assert Failed in File: %s, Line %d: %s",        UNIT_TEST_ARG_FAIL) \
+    X(UNIT_TEST_EVT_LOG_DROPPED,          "\n\nLOG: %d messages dropped\n",                         UNIT_TEST_ARG_NUM)  \
+    X(UNIT_TEST_EVT_CASE_SIGNAL,          "\n    Test Process Killed by Signal %d",                UNIT_TEST_ARG_NUM)  \
+    X(UNIT_TEST_EVT_CASE_EXIT,            "\n    Test Process Exited with Status %d",              UNIT_TEST_ARG_NUM)  \
+    X(UNIT_TEST_EVT_CASE_TICKS,           ", %lu ticks",                                           UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_SUITE_TICKS,          "\n\nTest Suite Ticks: %lu",                              UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_BENCH_ITERATIONS,     "\n    Benchmark Iterations: %lu",                       UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_BENCH_MIN,            ", Min: %lu",                                            UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_BENCH_MEDIAN,         ", Median: %lu",                                         UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_BENCH_MAX,            ", Max: %lu",                                            UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_BENCH_MEAN,           ", Mean: %lu ticks",                                     UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_BASELINE_WARNING,     "\n    Warning: Slower than Baseline of %lu ticks",      UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_BASELINE_FAILED,      "\n    Failed: Slower than Baseline of %lu ticks",       UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_CASE_STACK,           ", %lu stack bytes",                                     UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_CASE_ALLOCS,          ", %lu allocations",                                     UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_CASE_ALLOC_PEAK,      ", %lu peak heap bytes",                                 UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_ALLOC_LEAKED,         "\n    Memory Leaked: %lu bytes",                         UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_MEM_OFFSET,           "\n    Bytes from Offset %lu:",                           UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_MEM_EXPECTED,         "\n        Expected: %s",                                 UNIT_TEST_ARG_HEX)  \
+    X(UNIT_TEST_EVT_MEM_ACTUAL,           "\n        Got:      %s",                                 UNIT_TEST_ARG_HEX)  \
+    X(UNIT_TEST_EVT_FLOAT_WORST,          "\n    Worst Error at Index %lu",                         UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_FLOAT_EXPECTED,       ", Expected: %.8e",                                      UNIT_TEST_ARG_FLOAT) \
+    X(UNIT_TEST_EVT_FLOAT_ACTUAL,         ", Got: %.8e",                                           UNIT_TEST_ARG_FLOAT) \
+    X(UNIT_TEST_EVT_FLOAT_MAX_ERROR,      "\n    Max Error: %e",                                    UNIT_TEST_ARG_FLOAT) \
+    X(UNIT_TEST_EVT_FLOAT_MEAN_ERROR,     ", Mean Error: %e",                                      UNIT_TEST_ARG_FLOAT) \
+    X(UNIT_TEST_EVT_FLOAT_MAX_ULPS,       "\n    Max Error: %lu ulps",                              UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_FLOAT_MEAN_ULPS,      ", Mean Error: %e ulps",                                 UNIT_TEST_ARG_FLOAT) \
+    X(UNIT_TEST_EVT_RUN_STOPPED,          "\n\nRun Stopped after %lu Failed Test Cases",            UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_CASE_TIMEOUT,         "\n    Test Case Timed Out, Timeout: %lu",               UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_PARAM_INDEX,          "\n    Parameter Index: %lu",                            UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_PARAM_FAILS,          "\n    Parameters Failed: %lu",                          UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_PARAM_COUNT,          " of %lu",                                               UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_PARAM_FIRST,          ", First Failed Index: %lu",                             UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_PROPERTY_SEED,        "\n    Property Failed, Seed: 0x%08lx",                  UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_PROPERTY_ITERATION,   ", Iteration: %lu",                                      UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_PROPERTY_SHRINKS,     ", Shrink Steps: %lu",                                   UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_SUMMARY_SUITES,       "\n\nTest Run Summary: %lu Suites",                       UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_SUMMARY_CASES,        ", %lu Test Cases",                                      UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_SUMMARY_CASE_FAILS,   " (%lu Failed)",                                         UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_SUMMARY_ASSERTS,      ", %lu Asserts",                                         UNIT_TEST_ARG_U32)  \
+    X(UNIT_TEST_EVT_SUMMARY_ASSERT_FAILS, " (%lu Failed)\n",                                       UNIT_TEST_ARG_U32)
+
+/**
+ * Type tags of the values carried in assert failure records.
+ *
+ * X(type tag, width in bytes, kind, equal format, not equal format)
+ */
+#define UNIT_TEST_TYPES(X) \
+    X(UNIT_TEST_TYPE_BOOL,    1, UNIT_TEST_KIND_UNSIGNED, " expected: %u, got: %u",       " should not be: %u")   \
+    X(UNIT_TEST_TYPE_INT8,    1, UNIT_TEST_KIND_SIGNED,   " expected: %d, got: %d",       " should not be: %d")   \
+    X(UNIT_TEST_TYPE_UINT8,   1, UNIT_TEST_KIND_UNSIGNED, " expected: %u, got: %u",       " should not be: %u")   \
+    X(UNIT_TEST_TYPE_INT16,   2, UNIT_TEST_KIND_SIGNED,   " expected: %d, got: %d",       " should not be: %d")   \
+    X(UNIT_TEST_TYPE_UINT16,  2, UNIT_TEST_KIND_UNSIGNED, " expected: %u, got: %u",       " should not be: %u")   \
+    X(UNIT_TEST_TYPE_INT32,   4, UNIT_TEST_KIND_SIGNED,   " expected: %d, got: %d",       " should not be: %d")   \
+    X(UNIT_TEST_TYPE_UINT32,  4, UNIT_TEST_KIND_UNSIGNED, " expected: %u, got: %u",       " should not be: %u")   \
+    X(UNIT_TEST_TYPE_INT64,   8, UNIT_TEST_KIND_SIGNED,   " expected: %lld, got: %lld",   " should not be: %lld") \
+    X(UNIT_TEST_TYPE_UINT64,  8, UNIT_TEST_KIND_UNSIGNED, " expected: %llu, got: %llu",   " should not be: %llu") \
+    X(UNIT_TEST_TYPE_FLOAT64, 8, UNIT_TEST_KIND_FLOAT,    " expected: %e, got: %e",       " should not be: %e")   \
+    X(UNIT_TEST_TYPE_TICKS,   4, UNIT_TEST_KIND_UNSIGNED, " budget: %u ticks, took: %u",  " should not be: %u")   \
+    X(UNIT_TEST_TYPE_US,      4, UNIT_TEST_KIND_UNSIGNED, " budget: %u us, took: %u",     " should not be: %u")   \
+    X(UNIT_TEST_TYPE_STACK,   4, UNIT_TEST_KIND_UNSIGNED, " budget: %u bytes, used: %u",  " should not be: %u")   \
+    X(UNIT_TEST_TYPE_ALLOCS,  4, UNIT_TEST_KIND_UNSIGNED, " budget: %u allocations, made: %u", " should not be: %u") \
+    X(UNIT_TEST_TYPE_HEAP,    4, UNIT_TEST_KIND_UNSIGNED, " budget: %u bytes, allocated: %u", " should not be: %u") \
+    X(UNIT_TEST_TYPE_MEM,     4, UNIT_TEST_KIND_UNSIGNED, " first difference at index %u, differences: %u", " should not be: %u") \
+    X(UNIT_TEST_TYPE_NEAR,    4, UNIT_TEST_KIND_UNSIGNED, " %u of %u elements out of tolerance", " should not be: %u")
+
+#define UNIT_TEST_LOG_MAGIC   "SCLB"
+#define UNIT_TEST_LOG_VERSION ((uint8_t) 1)
+
+#define UNIT_TEST_ENUM_ENTRY(id, ...) id,
+
+typedef enum
+{
+    UNIT_TEST_LOG_EVENTS(UNIT_TEST_ENUM_ENTRY)
+    UNIT_TEST_EVT_COUNT
+} unit_test_event_t;
+
+typedef enum
+{
+    UNIT_TEST_TYPES(UNIT_TEST_ENUM_ENTRY)
+    UNIT_TEST_TYPE_COUNT
+} unit_test_type_t;
+
+typedef enum
+{
+    UNIT_TEST_ARG_NONE,
+    UNIT_TEST_ARG_NUM,
+    UNIT_TEST_ARG_U32,
+    UNIT_TEST_ARG_STR,
+    UNIT_TEST_ARG_FILE,
+    UNIT_TEST_ARG_FAIL,
+    UNIT_TEST_ARG_HEX,
+    UNIT_TEST_ARG_FLOAT
+} unit_test_arg_t;
+
+typedef enum
+{
+    UNIT_TEST_KIND_SIGNED,
+    UNIT_TEST_KIND_UNSIGNED,
+    UNIT_TEST_KIND_FLOAT
+} unit_test_kind_t;
+
+/**
+ * The widest integer type supported, integer values are passed to
+ * assert_value_failed as this type. Signed values are sign extended.
+ */
+#ifdef UNIT_TEST_INT64
+typedef uint64_t unit_test_uint_t;
+#else
+typedef uint32_t unit_test_uint_t;
+#endif
+
+/**
+ * Report a failed integer or bool assert, used by the inline asserts. equal is
+ * true if the values were expected to be equal.
+ */
+extern void assert_value_failed(unit_test_type_t, bool, unit_test_uint_t,
+    unit_test_uint_t, unit_test_file_t, int) UNIT_TEST_COLD;
+
+/**
+ * Inline asserts, see UNIT_TEST_INLINE_ASSERTS.
+ */
+#ifdef UNIT_TEST_INLINE_ASSERTS
+
+//! Inline asserts that passed on this thread, added to the stats of the
+//! current context when a case ends. A failed assert is counted by the
+//! assert function it calls.
+extern UNIT_TEST_THREAD_LOCAL uint32_t unit_test_inline_passed;
+
+#define UNIT_TEST_INLINE_ASSERT(name, type, tag) \
+    static inline void assert_##name##_eq_inline (type e, type a, \
+        unit_test_file_t file, int line_num) \
+    { \
+        if (UNIT_TEST_UNLIKELY(e != a)) \
+        { \
+            assert_value_failed(tag, true, (unit_test_uint_t) e, \
+                (unit_test_uint_t) a, file, line_num); \
+        } \
+        else \
+        { \
+            unit_test_inline_passed++; \
+        } \
+    } \
+    static inline void assert_##name##_not_eq_inline (type e, type a, \
+        unit_test_file_t file, int line_num) \
+    { \
+        if (UNIT_TEST_UNLIKELY(e == a)) \
+        { \
+            assert_value_failed(tag, false, (unit_test_uint_t) e, \
+                (unit_test_uint_t) a, file, line_num); \
+        } \
+        else \
+        { \
+            unit_test_inline_passed++; \
+        } \
+    }
+
+UNIT_TEST_INLINE_ASSERT(bool,   bool,     UNIT_TEST_TYPE_BOOL)
+UNIT_TEST_INLINE_ASSERT(int8,   int8_t,   UNIT_TEST_TYPE_INT8)
+UNIT_TEST_INLINE_ASSERT(uint8,  uint8_t,  UNIT_TEST_TYPE_UINT8)
+UNIT_TEST_INLINE_ASSERT(int16,  int16_t,  UNIT_TEST_TYPE_INT16)
+UNIT_TEST_INLINE_ASSERT(uint16, uint16_t, UNIT_TEST_TYPE_UINT16)
+UNIT_TEST_INLINE_ASSERT(int32,  int32_t,  UNIT_TEST_TYPE_INT32)
+UNIT_TEST_INLINE_ASSERT(uint32, uint32_t, UNIT_TEST_TYPE_UINT32)
+
+#ifdef UNIT_TEST_INT64
+UNIT_TEST_INLINE_ASSERT(int64,  int64_t,  UNIT_TEST_TYPE_INT64)
+UNIT_TEST_INLINE_ASSERT(uint64, uint64_t, UNIT_TEST_TYPE_UINT64)
+#endif
+
+#ifdef UNIT_TEST_FLOATING_POINT
+
+// floats that are exactly equal pass inline, anything else needs the full
+// comparison of the assert function
+static inline void assert_float64_eq_inline (float64_t e, float64_t a,
+    unit_test_file_t file, int line_num)
+{
+    if (UNIT_TEST_UNLIKELY(e != a))
+    {
+        assert_float64_eq(e, a, file, line_num);
+    }
+    else
+    {
+        unit_test_inline_passed++;
+    }
+}
+
+static inline void assert_float32_eq_inline (float32_t e, float32_t a,
+    unit_test_file_t file, int line_num)
+{
+    assert_float64_eq_inline((float64_t) e, (float64_t) a, file, line_num);
+}
+
+static inline void assert_float64_not_eq_inline (float64_t e, float64_t a,
+    unit_test_file_t file, int line_num)
+{
+    assert_float64_not_eq(e, a, file, line_num);
+}
+
+static inline void assert_float32_not_eq_inline (float32_t e, float32_t a,
+    unit_test_file_t file, int line_num)
+{
+    assert_float64_not_eq((float64_t) e, (float64_t) a, file, line_num);
+}
+
+#endif // UNIT_TEST_FLOATING_POINT
+
+#endif // UNIT_TEST_INLINE_ASSERTS
 
+/**
+ * Type generic asserts, for C11 and C++11 and later. ASSERT_EQ and ASSERT_NE
+ * pick the typed assert at compile time from the types of both values. They
+ * are compared in the narrowest type that holds every value of both types,
+ * so no value is truncated or changes sign on the way:
+ *
+ *     uint16_t const length = frame_length(&frame);
+ *     ASSERT_EQ(64, length);               // ASSERT_INT32_EQ(64, length)
+ *     ASSERT_EQ((uint16_t) 64, length);    // ASSERT_UINT16_EQ
+ *
+ * A signed and an unsigned type of the same width are compared in the
+ * signed type of twice the width. A pair that no type holds, such as a
+ * signed type and uint64_t, does not compile; nor does a pair that needs a
+ * 64-bit compare without UNIT_TEST_INT64. Neither does a bool, float or enum
+ * compared with a value of another kind; in C, where true and false are
+ * ints, a bool can also be compared with an integer, in a type that holds
+ * both. UINT16_C and the other constant macros give an int or wider, not the
+ * type they are named after, so cast a constant to pick a narrower assert.
+ *
+ * In C the generic asserts take bool, float, double and each standard
+ * integer type from char to unsigned long long by its width and signedness,
+ * so a fixed-width type works whichever of them it is a typedef of. In C++
+ * they take any integer type the same way, enums and enum classes compared
+ * with the same enum by their underlying type, and ASSERT_EQ takes
+ * containers of integers or enums with data() and size(), such as
+ * std::array and std::span, and built-in arrays. These are compared with
+ * ASSERT_MEM_EQ, ASSERT_UINT16_ARRAY_EQ or ASSERT_UINT32_ARRAY_EQ by the
+ * width of their elements; a difference in length fails as a compare of the
+ * lengths. UNIT_TEST_GENERIC_ASSERTS is defined when the asserts are there.
+ */
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+#define UNIT_TEST_GENERIC_ASSERTS
+
+#include <limits.h>        // to find the widths of the integer types
+
+//! Picked for two types that no type holds, calling it does not compile
+typedef struct
+{
+    int unused;
+} unit_test_generic_mismatch_t;
+
+extern unit_test_generic_mismatch_t const unit_test_generic_no_type_holds_both;
+
+/*
+ * The fixed-width types are typedefs of the standard integer types, which
+ * differ between targets, int32_t is a long with newlib. The _Generic tables
+ * list the standard types, each mapped to the class of its width and
+ * signedness. A class is a pp-number such as 32s, so no macro can replace it
+ * before it is pasted into the name of a pair of classes.
+ */
+#if CHAR_MIN < 0
+#define UNIT_TEST_CLASS_CHAR 8s
+#else
+#define UNIT_TEST_CLASS_CHAR 8u
+#endif
+
+#if INT_MAX == 32767
+#define UNIT_TEST_CLASS_INT  16s
+#define UNIT_TEST_CLASS_UINT 16u
+#else
+#define UNIT_TEST_CLASS_INT  32s
+#define UNIT_TEST_CLASS_UINT 32u
+#endif
+
+#if LONG_MAX == 2147483647L
+#define UNIT_TEST_CLASS_LONG  32s
+#define UNIT_TEST_CLASS_ULONG 32u
+#else
+#define UNIT_TEST_CLASS_LONG  64s
+#define UNIT_TEST_CLASS_ULONG 64u
+#endif
+
+#ifdef UNIT_TEST_INT64
+#define UNIT_TEST_GENERIC_64(fn) UNIT_TEST_ASSERT_FN(fn)
+#else
+#define UNIT_TEST_GENERIC_64(fn) unit_test_generic_no_type_holds_both
+#endif
+
+//! The typed assert of an actual value of class a and an expected value of
+//! class e, the assert of the narrowest type that holds both
+#define UNIT_TEST_GENERIC_PAIR(op,a,e)  UNIT_TEST_GENERIC_PAIR_(op, a, e)
+#define UNIT_TEST_GENERIC_PAIR_(op,a,e) UNIT_TEST_GENERIC_##a##_##e(op)
+
+#define UNIT_TEST_GENERIC_8s_8s(op)   UNIT_TEST_ASSERT_FN(assert_int8_##op)
+#define UNIT_TEST_GENERIC_8s_8u(op)   UNIT_TEST_ASSERT_FN(assert_int16_##op)
+#define UNIT_TEST_GENERIC_8s_16s(op)  UNIT_TEST_ASSERT_FN(assert_int16_##op)
+#define UNIT_TEST_GENERIC_8s_16u(op)  UNIT_TEST_ASSERT_FN(assert_int32_##op)
+#define UNIT_TEST_GENERIC_8s_32s(op)  UNIT_TEST_ASSERT_FN(assert_int32_##op)
+#define UNIT_TEST_GENERIC_8s_32u(op)  UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_8s_64s(op)  UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_8s_64u(op)  unit_test_generic_no_type_holds_both
+
+#define UNIT_TEST_GENERIC_8u_8s(op)   UNIT_TEST_ASSERT_FN(assert_int16_##op)
+#define UNIT_TEST_GENERIC_8u_8u(op)   UNIT_TEST_ASSERT_FN(assert_uint8_##op)
+#define UNIT_TEST_GENERIC_8u_16s(op)  UNIT_TEST_ASSERT_FN(assert_int16_##op)
+#define UNIT_TEST_GENERIC_8u_16u(op)  UNIT_TEST_ASSERT_FN(assert_uint16_##op)
+#define UNIT_TEST_GENERIC_8u_32s(op)  UNIT_TEST_ASSERT_FN(assert_int32_##op)
+#define UNIT_TEST_GENERIC_8u_32u(op)  UNIT_TEST_ASSERT_FN(assert_uint32_##op)
+#define UNIT_TEST_GENERIC_8u_64s(op)  UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_8u_64u(op)  UNIT_TEST_GENERIC_64(assert_uint64_##op)
+
+#define UNIT_TEST_GENERIC_16s_8s(op)  UNIT_TEST_ASSERT_FN(assert_int16_##op)
+#define UNIT_TEST_GENERIC_16s_8u(op)  UNIT_TEST_ASSERT_FN(assert_int16_##op)
+#define UNIT_TEST_GENERIC_16s_16s(op) UNIT_TEST_ASSERT_FN(assert_int16_##op)
+#define UNIT_TEST_GENERIC_16s_16u(op) UNIT_TEST_ASSERT_FN(assert_int32_##op)
+#define UNIT_TEST_GENERIC_16s_32s(op) UNIT_TEST_ASSERT_FN(assert_int32_##op)
+#define UNIT_TEST_GENERIC_16s_32u(op) UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_16s_64s(op) UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_16s_64u(op) unit_test_generic_no_type_holds_both
+
+#define UNIT_TEST_GENERIC_16u_8s(op)  UNIT_TEST_ASSERT_FN(assert_int32_##op)
+#define UNIT_TEST_GENERIC_16u_8u(op)  UNIT_TEST_ASSERT_FN(assert_uint16_##op)
+#define UNIT_TEST_GENERIC_16u_16s(op) UNIT_TEST_ASSERT_FN(assert_int32_##op)
+#define UNIT_TEST_GENERIC_16u_16u(op) UNIT_TEST_ASSERT_FN(assert_uint16_##op)
+#define UNIT_TEST_GENERIC_16u_32s(op) UNIT_TEST_ASSERT_FN(assert_int32_##op)
+#define UNIT_TEST_GENERIC_16u_32u(op) UNIT_TEST_ASSERT_FN(assert_uint32_##op)
+#define UNIT_TEST_GENERIC_16u_64s(op) UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_16u_64u(op) UNIT_TEST_GENERIC_64(assert_uint64_##op)
+
+#define UNIT_TEST_GENERIC_32s_8s(op)  UNIT_TEST_ASSERT_FN(assert_int32_##op)
+#define UNIT_TEST_GENERIC_32s_8u(op)  UNIT_TEST_ASSERT_FN(assert_int32_##op)
+#define UNIT_TEST_GENERIC_32s_16s(op) UNIT_TEST_ASSERT_FN(assert_int32_##op)
+#define UNIT_TEST_GENERIC_32s_16u(op) UNIT_TEST_ASSERT_FN(assert_int32_##op)
+#define UNIT_TEST_GENERIC_32s_32s(op) UNIT_TEST_ASSERT_FN(assert_int32_##op)
+#define UNIT_TEST_GENERIC_32s_32u(op) UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_32s_64s(op) UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_32s_64u(op) unit_test_generic_no_type_holds_both
+
+#define UNIT_TEST_GENERIC_32u_8s(op)  UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_32u_8u(op)  UNIT_TEST_ASSERT_FN(assert_uint32_##op)
+#define UNIT_TEST_GENERIC_32u_16s(op) UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_32u_16u(op) UNIT_TEST_ASSERT_FN(assert_uint32_##op)
+#define UNIT_TEST_GENERIC_32u_32s(op) UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_32u_32u(op) UNIT_TEST_ASSERT_FN(assert_uint32_##op)
+#define UNIT_TEST_GENERIC_32u_64s(op) UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_32u_64u(op) UNIT_TEST_GENERIC_64(assert_uint64_##op)
+
+#define UNIT_TEST_GENERIC_64s_8s(op)  UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_64s_8u(op)  UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_64s_16s(op) UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_64s_16u(op) UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_64s_32s(op) UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_64s_32u(op) UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_64s_64s(op) UNIT_TEST_GENERIC_64(assert_int64_##op)
+#define UNIT_TEST_GENERIC_64s_64u(op) unit_test_generic_no_type_holds_both
+
+#define UNIT_TEST_GENERIC_64u_8s(op)  unit_test_generic_no_type_holds_both
+#define UNIT_TEST_GENERIC_64u_8u(op)  UNIT_TEST_GENERIC_64(assert_uint64_##op)
+#define UNIT_TEST_GENERIC_64u_16s(op) unit_test_generic_no_type_holds_both
+#define UNIT_TEST_GENERIC_64u_16u(op) UNIT_TEST_GENERIC_64(assert_uint64_##op)
+#define UNIT_TEST_GENERIC_64u_32s(op) unit_test_generic_no_type_holds_both
+#define UNIT_TEST_GENERIC_64u_32u(op) UNIT_TEST_GENERIC_64(assert_uint64_##op)
+#define UNIT_TEST_GENERIC_64u_64s(op) unit_test_generic_no_type_holds_both
+#define UNIT_TEST_GENERIC_64u_64u(op) UNIT_TEST_GENERIC_64(assert_uint64_##op)
+
+
+//! The typed assert of an actual integer of class a, picked by the type of
+//! the expected value
+#define UNIT_TEST_GENERIC_INTS(op,a,e) _Generic((e),                          \
+    char:               UNIT_TEST_GENERIC_PAIR(op, a, UNIT_TEST_CLASS_CHAR),  \
+    signed char:        UNIT_TEST_GENERIC_PAIR(op, a, 8s),                    \
+    unsigned char:      UNIT_TEST_GENERIC_PAIR(op, a, 8u),                    \
+    short:              UNIT_TEST_GENERIC_PAIR(op, a, 16s),                   \
+    unsigned short:     UNIT_TEST_GENERIC_PAIR(op, a, 16u),                   \
+    int:                UNIT_TEST_GENERIC_PAIR(op, a, UNIT_TEST_CLASS_INT),   \
+    unsigned:           UNIT_TEST_GENERIC_PAIR(op, a, UNIT_TEST_CLASS_UINT),  \
+    long:               UNIT_TEST_GENERIC_PAIR(op, a, UNIT_TEST_CLASS_LONG),  \
+    unsigned long:      UNIT_TEST_GENERIC_PAIR(op, a, UNIT_TEST_CLASS_ULONG), \
+    long long:          UNIT_TEST_GENERIC_PAIR(op, a, 64s),                   \
+    unsigned long long: UNIT_TEST_GENERIC_PAIR(op, a, 64u),                   \
+    default:            unit_test_generic_no_type_holds_both)
+
+//! A bool is compared with a bool, or with an integer such as true and
+//! false, which are ints in C
+#define UNIT_TEST_GENERIC_BOOL(op,e) _Generic((e),    \
+    bool:    UNIT_TEST_ASSERT_FN(assert_bool_##op),   \
+    default: UNIT_TEST_GENERIC_INTS(op, 8u, e))
+
+#ifdef UNIT_TEST_FLOATING_POINT
+#define UNIT_TEST_GENERIC_FLOAT(op,e) _Generic((e),      \
+    float:     UNIT_TEST_ASSERT_FN(assert_float32_##op), \
+    double:    UNIT_TEST_ASSERT_FN(assert_float64_##op), \
+    default:   unit_test_generic_no_type_holds_both)
+
+#define UNIT_TEST_GENERIC_DOUBLE(op,e) _Generic((e),     \
+    float:     UNIT_TEST_ASSERT_FN(assert_float64_##op), \
+    double:    UNIT_TEST_ASSERT_FN(assert_float64_##op), \
+    default:   unit_test_generic_no_type_holds_both)
+
+#define UNIT_TEST_GENERIC_FLOATS(op,e) , float: UNIT_TEST_GENERIC_FLOAT(op, e), double: UNIT_TEST_GENERIC_DOUBLE(op, e)
+#else
+#define UNIT_TEST_GENERIC_FLOATS(op,e)
 #endif
 
+#define UNIT_TEST_GENERIC(op,e,a) _Generic((a),                               \
+    bool:               UNIT_TEST_GENERIC_BOOL(op, e),                        \
+    char:               UNIT_TEST_GENERIC_INTS(op, UNIT_TEST_CLASS_CHAR, e),  \
+    signed char:        UNIT_TEST_GENERIC_INTS(op, 8s, e),                    \
+    unsigned char:      UNIT_TEST_GENERIC_INTS(op, 8u, e),                    \
+    short:              UNIT_TEST_GENERIC_INTS(op, 16s, e),                   \
+    unsigned short:     UNIT_TEST_GENERIC_INTS(op, 16u, e),                   \
+    int:                UNIT_TEST_GENERIC_INTS(op, UNIT_TEST_CLASS_INT, e),   \
+    unsigned:           UNIT_TEST_GENERIC_INTS(op, UNIT_TEST_CLASS_UINT, e),  \
+    long:               UNIT_TEST_GENERIC_INTS(op, UNIT_TEST_CLASS_LONG, e),  \
+    unsigned long:      UNIT_TEST_GENERIC_INTS(op, UNIT_TEST_CLASS_ULONG, e), \
+    long long:          UNIT_TEST_GENERIC_INTS(op, 64s, e),                   \
+    unsigned long long: UNIT_TEST_GENERIC_INTS(op, 64u, e)                    \
+    UNIT_TEST_GENERIC_FLOATS(op, e))
+
+#define ASSERT_EQ(e,a) (UNIT_TEST_GENERIC(eq,     e, a)(e, a, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_NE(e,a) (UNIT_TEST_GENERIC(not_eq, e, a)(e, a, UNIT_TEST_FILE, __LINE__))
+#endif // C11
+
 //RSM_IGNORE_END
 
 #ifdef __cplusplus
 }
 #endif
 
+#if defined(__cplusplus) && (__cplusplus >= 201103L)
+#define UNIT_TEST_GENERIC_ASSERTS
+
+#include <type_traits>     // to pick the typed asserts
+#include <utility>         // to provide std::declval
+
+namespace unit_test
+{
+
+/**
+ * The typed asserts of an integer of the given width and signedness.
+ */
+template <std::size_t width, bool is_signed>
+struct int_asserts
+{
+    static_assert(width == 0,
+        "ASSERT_EQ/ASSERT_NE: no typed assert of this width, 64-bit "
+        "compares, such as of a signed value and a uint32_t, need "
+        "UNIT_TEST_INT64");
+};
+
+template <>
+struct int_asserts<1, true>
+{
+    static void eq (int8_t e, int8_t a, unit_test_file_t file, int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_int8_eq)(e, a, file, line_num);
+    }
+
+    static void ne (int8_t e, int8_t a, unit_test_file_t file, int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_int8_not_eq)(e, a, file, line_num);
+    }
+};
+
+template <>
+struct int_asserts<1, false>
+{
+    static void eq (uint8_t e, uint8_t a, unit_test_file_t file, int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_uint8_eq)(e, a, file, line_num);
+    }
+
+    static void ne (uint8_t e, uint8_t a, unit_test_file_t file, int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_uint8_not_eq)(e, a, file, line_num);
+    }
+};
+
+template <>
+struct int_asserts<2, true>
+{
+    static void eq (int16_t e, int16_t a, unit_test_file_t file, int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_int16_eq)(e, a, file, line_num);
+    }
+
+    static void ne (int16_t e, int16_t a, unit_test_file_t file, int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_int16_not_eq)(e, a, file, line_num);
+    }
+};
+
+template <>
+struct int_asserts<2, false>
+{
+    static void eq (uint16_t e, uint16_t a, unit_test_file_t file,
+        int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_uint16_eq)(e, a, file, line_num);
+    }
+
+    static void ne (uint16_t e, uint16_t a, unit_test_file_t file,
+        int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_uint16_not_eq)(e, a, file, line_num);
+    }
+};
+
+template <>
+struct int_asserts<4, true>
+{
+    static void eq (int32_t e, int32_t a, unit_test_file_t file, int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_int32_eq)(e, a, file, line_num);
+    }
+
+    static void ne (int32_t e, int32_t a, unit_test_file_t file, int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_int32_not_eq)(e, a, file, line_num);
+    }
+};
+
+template <>
+struct int_asserts<4, false>
+{
+    static void eq (uint32_t e, uint32_t a, unit_test_file_t file,
+        int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_uint32_eq)(e, a, file, line_num);
+    }
+
+    static void ne (uint32_t e, uint32_t a, unit_test_file_t file,
+        int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_uint32_not_eq)(e, a, file, line_num);
+    }
+};
+
+#ifdef UNIT_TEST_INT64
+template <>
+struct int_asserts<8, true>
+{
+    static void eq (int64_t e, int64_t a, unit_test_file_t file, int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_int64_eq)(e, a, file, line_num);
+    }
+
+    static void ne (int64_t e, int64_t a, unit_test_file_t file, int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_int64_not_eq)(e, a, file, line_num);
+    }
+};
+
+template <>
+struct int_asserts<8, false>
+{
+    static void eq (uint64_t e, uint64_t a, unit_test_file_t file,
+        int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_uint64_eq)(e, a, file, line_num);
+    }
+
+    static void ne (uint64_t e, uint64_t a, unit_test_file_t file,
+        int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_uint64_not_eq)(e, a, file, line_num);
+    }
+};
+#endif
+
+#ifdef UNIT_TEST_FLOATING_POINT
+/**
+ * The typed asserts of a float of the given width.
+ */
+template <std::size_t width>
+struct float_asserts
+{
+    static_assert(width == 0,
+        "ASSERT_EQ/ASSERT_NE: no typed assert of this float width");
+};
+
+template <>
+struct float_asserts<sizeof(float32_t)>
+{
+    static void eq (float32_t e, float32_t a, unit_test_file_t file,
+        int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_float32_eq)(e, a, file, line_num);
+    }
+
+    static void ne (float32_t e, float32_t a, unit_test_file_t file,
+        int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_float32_not_eq)(e, a, file, line_num);
+    }
+};
+
+template <>
+struct float_asserts<sizeof(float64_t)>
+{
+    static void eq (float64_t e, float64_t a, unit_test_file_t file,
+        int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_float64_eq)(e, a, file, line_num);
+    }
+
+    static void ne (float64_t e, float64_t a, unit_test_file_t file,
+        int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_float64_not_eq)(e, a, file, line_num);
+    }
+};
+#endif
+
+/**
+ * The array assert of elements of the given width, the bytes are compared
+ * when there is no array assert of that width.
+ */
+template <std::size_t width>
+struct array_asserts
+{
+    static void eq (void const *e, void const *a, size_t count,
+        unit_test_file_t file, int line_num)
+    {
+        assert_mem_eq(e, a, count * width, file, line_num);
+    }
+};
+
+template <>
+struct array_asserts<2>
+{
+    static void eq (void const *e, void const *a, size_t count,
+        unit_test_file_t file, int line_num)
+    {
+        assert_uint16_array_eq(static_cast<uint16_t const *>(e),
+            static_cast<uint16_t const *>(a), count, file, line_num);
+    }
+};
+
+template <>
+struct array_asserts<4>
+{
+    static void eq (void const *e, void const *a, size_t count,
+        unit_test_file_t file, int line_num)
+    {
+        assert_uint32_array_eq(static_cast<uint32_t const *>(e),
+            static_cast<uint32_t const *>(a), count, file, line_num);
+    }
+};
+
+/**
+ * The elements of a container with data() and size(), or of a built-in
+ * array.
+ */
+template <typename T>
+auto range_data (T const &range) -> decltype(range.data())
+{
+    return range.data();
+}
+
+template <typename T>
+auto range_size (T const &range) -> decltype(range.size())
+{
+    return range.size();
+}
+
+template <typename T, std::size_t count>
+T const *range_data (T const (&range)[count])
+{
+    return range;
+}
+
+template <typename T, std::size_t count>
+std::size_t range_size (T const (&)[count])
+{
+    return count;
+}
+
+template <typename T>
+using range_element = typename std::remove_cv<typename std::remove_pointer<
+    decltype(range_data(std::declval<T const &>()))>::type>::type;
+
+template <typename T, typename = void>
+struct is_range : std::false_type
+{
+};
+
+template <typename T>
+struct is_range<T, decltype((void) range_data(std::declval<T const &>()),
+    (void) range_size(std::declval<T const &>()))> : std::true_type
+{
+};
+
+//! Kinds of values with generic asserts
+enum class kind
+{
+    boolean,
+    integer,
+    enumeration,
+    floating,
+    range,
+    none
+};
+
+template <typename T>
+using kind_of = std::integral_constant<kind,
+    std::is_same<T, bool>::value     ? kind::boolean     :
+    std::is_integral<T>::value       ? kind::integer     :
+    std::is_enum<T>::value           ? kind::enumeration :
+    std::is_floating_point<T>::value ? kind::floating    :
+    is_range<T>::value               ? kind::range       : kind::none>;
+
+/**
+ * The typed asserts of the narrowest integer type that holds every value of
+ * both E and A. A signed and an unsigned type are compared in the signed
+ * type, when it is wider, or else in the signed type of twice the width of
+ * the unsigned one.
+ */
+template <typename E, typename A>
+struct int_compare
+{
+    static bool const e_signed = std::is_signed<E>::value;
+    static bool const a_signed = std::is_signed<A>::value;
+    static std::size_t const signed_width   = e_signed ? sizeof(E) : sizeof(A);
+    static std::size_t const unsigned_width = e_signed ? sizeof(A) : sizeof(E);
+    static std::size_t const width =
+        (e_signed == a_signed)
+            ? ((sizeof(E) > sizeof(A)) ? sizeof(E) : sizeof(A))
+            : ((signed_width > unsigned_width)
+                ? signed_width : (2 * unsigned_width));
+
+    static_assert(width <= 8,
+        "ASSERT_EQ/ASSERT_NE: no integer type holds every value of both "
+        "types, compare a 64-bit unsigned value with an unsigned value");
+
+    typedef int_asserts<(width <= 8) ? width : 8, e_signed || a_signed> type;
+};
+
+template <typename T>
+using plain = typename std::remove_cv<T>::type;
+
+/**
+ * The generic asserts of an expected value of type E and an actual value of
+ * type A, picked by the kind of A. E must be of the same kind.
+ */
+template <typename E, typename A, kind = kind_of<A>::value>
+struct asserts
+{
+    static_assert(sizeof(A) == 0,
+        "ASSERT_EQ/ASSERT_NE: no typed assert for this type");
+};
+
+template <typename E, typename A>
+struct asserts<E, A, kind::boolean>
+{
+    static_assert(kind_of<E>::value == kind::boolean,
+        "ASSERT_EQ/ASSERT_NE: compare a bool with a bool");
+
+    static void eq (bool e, bool a, unit_test_file_t file, int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_bool_eq)(e, a, file, line_num);
+    }
+
+    static void ne (bool e, bool a, unit_test_file_t file, int line_num)
+    {
+        UNIT_TEST_ASSERT_FN(assert_bool_not_eq)(e, a, file, line_num);
+    }
+};
+
+template <typename E, typename A>
+struct asserts<E, A, kind::integer>
+    : int_compare<typename std::conditional<
+        kind_of<E>::value == kind::integer, E, A>::type, A>::type
+{
+    static_assert(kind_of<E>::value == kind::integer,
+        "ASSERT_EQ/ASSERT_NE: compare an integer with an integer");
+};
+
+template <typename E, typename A>
+struct asserts<E, A, kind::enumeration>
+{
+    static_assert(std::is_same<E, A>::value,
+        "ASSERT_EQ/ASSERT_NE: compare an enum with the same enum");
+
+    typedef typename std::underlying_type<A>::type underlying_t;
+
+    static void eq (A e, A a, unit_test_file_t file, int line_num)
+    {
+        asserts<underlying_t, underlying_t>::eq(static_cast<underlying_t>(e),
+            static_cast<underlying_t>(a), file, line_num);
+    }
+
+    static void ne (A e, A a, unit_test_file_t file, int line_num)
+    {
+        asserts<underlying_t, underlying_t>::ne(static_cast<underlying_t>(e),
+            static_cast<underlying_t>(a), file, line_num);
+    }
+};
+
+#ifdef UNIT_TEST_FLOATING_POINT
+template <typename E, typename A>
+struct asserts<E, A, kind::floating>
+    : float_asserts<(sizeof(E) > sizeof(A)) ? sizeof(E) : sizeof(A)>
+{
+    static_assert(kind_of<E>::value == kind::floating,
+        "ASSERT_EQ/ASSERT_NE: compare a float with a float");
+};
+#endif
+
+template <typename E, typename A>
+struct asserts<E, A, kind::range>
+{
+    typedef range_element<A> element_t;
+
+    static_assert(std::is_integral<element_t>::value
+        || std::is_enum<element_t>::value,
+        "ASSERT_EQ: containers of integers or enums only, "
+        "compare floats with ASSERT_FLOAT32_ARRAY_NEAR");
+
+    static_assert(is_range<E>::value,
+        "ASSERT_EQ: compare a container with a container");
+
+    static void eq (E const &e, A const &a, unit_test_file_t file,
+        int line_num)
+    {
+        static_assert(std::is_same<range_element<E>, element_t>::value,
+            "ASSERT_EQ: the containers must have the same element type");
+
+        std::size_t const expected = static_cast<std::size_t>(range_size(e));
+        std::size_t const count    = static_cast<std::size_t>(range_size(a));
+
+        if (expected != count)
+        {
+            assert_uint32_eq(static_cast<uint32_t>(expected),
+                static_cast<uint32_t>(count), file, line_num);
+        }
+        else
+        {
+            array_asserts<sizeof(element_t)>::eq(range_data(e),
+                range_data(a), count, file, line_num);
+        }
+    }
+
+    static void ne (E const &, A const &, unit_test_file_t, int)
+    {
+        static_assert(sizeof(E) == 0,
+            "ASSERT_NE: containers cannot be compared for a difference");
+    }
+};
+
+/**
+ * Assert that two values are equal, with the typed assert picked from the
+ * types of both values.
+ */
+template <typename E, typename A>
+inline void assert_eq (E const &expected, A const &actual,
+    unit_test_file_t file, int line_num)
+{
+    asserts<plain<E>, plain<A>>::eq(expected, actual, file, line_num);
+}
+
+/**
+ * Assert that two values are not equal, with the typed assert picked from
+ * the types of both values.
+ */
+template <typename E, typename A>
+inline void assert_not_eq (E const &expected, A const &actual,
+    unit_test_file_t file, int line_num)
+{
+    asserts<plain<E>, plain<A>>::ne(expected, actual, file, line_num);
+}
+
+} // namespace unit_test
+
+//RSM_IGNORE_BEGIN
+#define ASSERT_EQ(e,a) (unit_test::assert_eq    (e, a, UNIT_TEST_FILE, __LINE__))
+#define ASSERT_NE(e,a) (unit_test::assert_not_eq(e, a, UNIT_TEST_FILE, __LINE__))
+//RSM_IGNORE_END
+
+#endif // __cplusplus
+
 #endif
 
 
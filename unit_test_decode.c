@@ -0,0 +1,650 @@
+/**
+ * @file unit_test_decode.c
+ *
+ * @brief Host program that turns a binary unit test log, written by a target
+ * built with UNIT_TEST_LOG_BINARY, back into the text format of the log.
+ *
+ * Usage: unit_test_decode [-m <map file>] <binary log file>
+ *        unit_test_decode -r [-m <map file>] <report dump file>
+ *        unit_test_decode -h <source path>...
+ *
+ * The text is written to standard out. This program is built for the host,
+ * not for the target.
+ *
+ * When the target is built with UNIT_TEST_FILE_IDS, a map file expands the
+ * file ids back into names. Each line of the map file holds an id and a name:
+ *
+ *     3 src/packet_builder.c
+ *
+ * -r prints the report block of a target built with UNIT_TEST_REPORT from a
+ * raw memory dump of unit_test_report, see "Report block" in unit_test.h.
+ * The failures kept in the block are printed like the log prints them,
+ * oldest first, followed by the summary of the run.
+ *
+ * -h prints a map line for each path, using the same hash that is used for a
+ * file that does not define UNIT_TEST_FILE_ID. Give the path exactly as the
+ * compiler sees it (the __FILE__ of the file).
+ *
+ * @copyright This program is free software. You can redistribute it and/or
+ * modify it under the terms of the GNU General Public License, version 3
+ * (GPLv3).
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unit_test.h"
+
+//! Number of file ids, the ids are 16-bit
+#define MAX_FILES ((uint32_t) 0x10000)
+
+//! Maximum length of a line in the map file
+#define MAX_LINE_LEN ((int) 1024)
+
+//! Maximum length of a decoded failure message
+#define MAX_MSG_LEN ((int) 100)
+
+//! Sizes of the parts of a report block, see "Report block" in unit_test.h
+#define REPORT_HEADER_LEN  ((size_t) 8)
+#define REPORT_COUNTS_LEN  ((size_t) 24)
+#define REPORT_FAILURE_LEN ((size_t) 24)
+
+//! Description of each type tag, indexed by unit_test_type_t
+typedef struct
+{
+    uint8_t          width;
+    unit_test_kind_t kind;
+    char const      *eq_format;
+    char const      *not_eq_format;
+} type_desc_t;
+
+#define TYPE_DESC_ENTRY(tag, width, kind, eq, not_eq) { width, kind, eq, not_eq },
+static type_desc_t const type_descs[] =
+{
+    UNIT_TEST_TYPES(TYPE_DESC_ENTRY)
+};
+
+//! Text format and argument kind of each event, indexed by unit_test_event_t
+#define EVENT_FORMAT_ENTRY(id, fmt, arg) fmt,
+static char const * const event_formats[] =
+{
+    UNIT_TEST_LOG_EVENTS(EVENT_FORMAT_ENTRY)
+};
+
+#define EVENT_ARG_ENTRY(id, fmt, arg) arg,
+static unit_test_arg_t const event_args[] =
+{
+    UNIT_TEST_LOG_EVENTS(EVENT_ARG_ENTRY)
+};
+
+//! File names from the map file or received in UNIT_TEST_EVT_FILE records,
+//! indexed by file id
+static char *file_names[MAX_FILES];
+
+//! true if the log was written by a little endian target
+static bool target_little_endian = true;
+
+// static function declarations
+static bool read_bytes(FILE *, uint8_t *, size_t);
+static bool read_u16(FILE *, uint16_t *);
+static bool read_u32(FILE *, uint32_t *);
+static bool decode_record(FILE *, uint8_t);
+static int report_decode(FILE *, char const *);
+static bool map_load(char const *);
+static void file_name_set(uint16_t, char const *, size_t);
+static uint16_t file_hash(char const *);
+static void value_format(char *, size_t, unit_test_type_t,
+    uint8_t const *, uint8_t const *);
+static uint64_t value_bits(uint8_t const *, uint8_t);
+static void hex_format(char *, uint8_t const *, uint8_t);
+
+/**
+ * Entry point of the decoder.
+ */
+int main (int argc, char *argv[])
+{
+    uint8_t     header[sizeof(UNIT_TEST_LOG_MAGIC) + 1];
+    uint8_t     event;
+    FILE       *log;
+    char const *log_name;
+    char const *program = argv[0];
+    bool        report  = false;
+    int         status  = 0;
+
+    if ((argc >= 3) && (0 == strcmp(argv[1], "-h")))
+    {
+        for (int index = 2; index < argc; index++)
+        {
+            (void) printf("%u %s\n", file_hash(argv[index]), argv[index]);
+        }
+        return 0;
+    }
+
+    if ((argc >= 2) && (0 == strcmp(argv[1], "-r")))
+    {
+        // the rest of the arguments are the same as for a log
+        report = true;
+        argv++;
+        argc--;
+    }
+
+    if ((argc == 4) && (0 == strcmp(argv[1], "-m")))
+    {
+        if (!map_load(argv[2]))
+        {
+            return 2;
+        }
+        log_name = argv[3];
+    }
+    else if (argc == 2)
+    {
+        log_name = argv[1];
+    }
+    else
+    {
+        (void) fprintf(stderr, "usage: %s [-m <map file>] <binary log file>\n"
+            "       %s -r [-m <map file>] <report dump file>\n"
+            "       %s -h <source path>...\n", program, program, program);
+        return 2;
+    }
+
+    log = fopen(log_name, "rb");
+    if (!log)
+    {
+        (void) fprintf(stderr, "cannot open %s\n", log_name);
+        return 2;
+    }
+
+    if (report)
+    {
+        status = report_decode(log, log_name);
+        (void) fclose(log);
+        return status;
+    }
+
+    if (!read_bytes(log, header, sizeof(header))
+        || (0 != memcmp(header, UNIT_TEST_LOG_MAGIC,
+                sizeof(UNIT_TEST_LOG_MAGIC) - 1))
+        || (header[sizeof(UNIT_TEST_LOG_MAGIC) - 1] != UNIT_TEST_LOG_VERSION))
+    {
+        (void) fprintf(stderr, "%s is not a binary unit test log\n", log_name);
+        (void) fclose(log);
+        return 1;
+    }
+
+    target_little_endian = (header[sizeof(UNIT_TEST_LOG_MAGIC)] != 0);
+
+    while (read_bytes(log, &event, 1))
+    {
+        if (!decode_record(log, event))
+        {
+            (void) fprintf(stderr, "\ncorrupt record, event id %u\n", event);
+            status = 1;
+            break;
+        }
+    }
+
+    (void) fclose(log);
+    return status;
+}
+
+/**
+ * Read bytes from the log.
+ *
+ * @return true if all bytes were read
+ */
+static bool read_bytes (FILE *log, uint8_t *data, size_t len)
+{
+    return fread(data, 1, len, log) == len;
+}
+
+/**
+ * Read a little endian uint16_t from the log.
+ *
+ * @return true if the value was read
+ */
+static bool read_u16 (FILE *log, uint16_t *value)
+{
+    uint8_t bytes[2];
+    bool    ok = read_bytes(log, bytes, sizeof(bytes));
+
+    *value = (uint16_t) (bytes[0] | (bytes[1] << 8));
+    return ok;
+}
+
+/**
+ * Read a little endian uint32_t from the log.
+ *
+ * @return true if the value was read
+ */
+static bool read_u32 (FILE *log, uint32_t *value)
+{
+    uint8_t bytes[4];
+    bool    ok = read_bytes(log, bytes, sizeof(bytes));
+
+    *value = (uint32_t) bytes[0] | ((uint32_t) bytes[1] << 8)
+        | ((uint32_t) bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+    return ok;
+}
+
+/**
+ * Decode the remainder of a record and print it in the text format.
+ *
+ *  @param log    the binary log
+ *  @param event  event id already read from the log
+ *
+ *  @return false if the record cannot be decoded
+ */
+//lint -e{592} non-literal format specifier
+static bool decode_record (FILE *log, uint8_t event)
+{
+    uint8_t  data[UINT8_MAX + 1];
+    char     msg[MAX_MSG_LEN + 1];
+    char     hex[3 * UINT8_MAX + 1];
+    uint64_t bits;
+    double   value;
+    char     id_str[sizeof("#65535")];
+    uint16_t num;
+    uint32_t num32;
+    uint16_t line_num;
+    uint8_t  len;
+    uint8_t  type;
+
+    if (event >= UNIT_TEST_EVT_COUNT)
+    {
+        return false;
+    }
+
+    switch (event_args[event])
+    {
+        case UNIT_TEST_ARG_NONE:
+            (void) printf(event_formats[event]);
+            return true;
+
+        case UNIT_TEST_ARG_NUM:
+            if (!read_u16(log, &num))
+            {
+                return false;
+            }
+            (void) printf(event_formats[event], num);
+            return true;
+
+        case UNIT_TEST_ARG_U32:
+            if (!read_u32(log, &num32))
+            {
+                return false;
+            }
+            (void) printf(event_formats[event], (unsigned long) num32);
+            return true;
+
+        case UNIT_TEST_ARG_STR:
+            if (!read_bytes(log, &len, 1) || !read_bytes(log, data, len))
+            {
+                return false;
+            }
+            data[len] = 0;
+            (void) printf(event_formats[event], (char const *) data);
+            return true;
+
+        case UNIT_TEST_ARG_HEX:
+            if (!read_bytes(log, &len, 1) || !read_bytes(log, data, len))
+            {
+                return false;
+            }
+            hex_format(hex, data, len);
+            (void) printf(event_formats[event], hex);
+            return true;
+
+        case UNIT_TEST_ARG_FLOAT:
+            if (!read_bytes(log, data, sizeof(value)))
+            {
+                return false;
+            }
+            bits = value_bits(data, sizeof(value));
+            (void) memcpy(&value, &bits, sizeof(value));
+            (void) printf(event_formats[event], value);
+            return true;
+
+        case UNIT_TEST_ARG_FILE:
+            if (!read_u16(log, &num)
+                || !read_bytes(log, &len, 1) || !read_bytes(log, data, len))
+            {
+                return false;
+            }
+            file_name_set(num, (char const *) data, len);
+            return true;
+
+        case UNIT_TEST_ARG_FAIL:
+            if (!read_u16(log, &num)
+                || !read_u16(log, &line_num)
+                || !read_bytes(log, &type, 1) || (type >= UNIT_TEST_TYPE_COUNT)
+                || !read_bytes(log, &len, 1) || !read_bytes(log, data, len))
+            {
+                return false;
+            }
+
+            if (event == UNIT_TEST_EVT_ASSERT_EQ)
+            {
+                if (len != 2 * type_descs[type].width)
+                {
+                    return false;
+                }
+                value_format(msg, sizeof(msg), (unit_test_type_t) type,
+                    data, &data[type_descs[type].width]);
+            }
+            else
+            {
+                if (len != type_descs[type].width)
+                {
+                    return false;
+                }
+                value_format(msg, sizeof(msg), (unit_test_type_t) type,
+                    data, 0);
+            }
+
+            // without a name, from the map or a file record that may have
+            // been dropped from a full ring, show the id like the target does
+            (void) snprintf(id_str, sizeof(id_str), "#%u", num);
+            (void) printf(event_formats[event],
+                file_names[num] ? file_names[num] : id_str,
+                (int) line_num, msg);
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * Print the report block of a target from a raw memory dump.
+ *
+ *  @param dump       the memory dump
+ *  @param dump_name  name of the dump file
+ *
+ *  @return exit status, 0 if the report block was printed
+ */
+//lint -e{592} non-literal format specifier
+static int report_decode (FILE *dump, char const *dump_name)
+{
+    uint8_t  header[REPORT_HEADER_LEN];
+    uint8_t  data[REPORT_COUNTS_LEN + (UINT8_MAX * REPORT_FAILURE_LEN)];
+    uint32_t counts[REPORT_COUNTS_LEN / 4];
+    char     msg[MAX_MSG_LEN + 1];
+    char     id_str[sizeof("#65535")];
+    uint32_t kept;
+    uint32_t suite = UINT32_MAX;
+    uint8_t  max;
+
+    if (!read_bytes(dump, header, sizeof(header))
+        || (0 != memcmp(header, UNIT_TEST_REPORT_MAGIC,
+                sizeof(UNIT_TEST_REPORT_MAGIC) - 1))
+        || (header[4] != UNIT_TEST_REPORT_VERSION) || (0 == header[6]))
+    {
+        (void) fprintf(stderr, "%s is not a unit test report block\n",
+            dump_name);
+        return 1;
+    }
+
+    target_little_endian = (header[5] != 0);
+    max                  = header[6];
+
+    if (!read_bytes(dump, data, REPORT_COUNTS_LEN
+        + (max * REPORT_FAILURE_LEN)))
+    {
+        (void) fprintf(stderr, "%s is shorter than its report block\n",
+            dump_name);
+        return 1;
+    }
+
+    for (size_t index = 0; index < (REPORT_COUNTS_LEN / 4); index++)
+    {
+        counts[index] = (uint32_t) value_bits(&data[4 * index], 4);
+    }
+
+    // the ring holds the last failures, counts[5] is the number of failures
+    kept = (counts[5] < max) ? counts[5] : max;
+    if (counts[5] > kept)
+    {
+        (void) printf("%lu earlier failed asserts were not kept\n",
+            (unsigned long) (counts[5] - kept));
+    }
+
+    for (uint32_t number = counts[5] - kept; number < counts[5]; number++)
+    {
+        uint8_t const *const failure = &data[REPORT_COUNTS_LEN
+            + ((number % max) * REPORT_FAILURE_LEN)];
+        uint16_t const file_id   = (uint16_t) value_bits(&failure[0], 2);
+        uint16_t const line_num  = (uint16_t) value_bits(&failure[2], 2);
+        uint16_t const suite_num = (uint16_t) value_bits(&failure[4], 2);
+        uint8_t const  type      = failure[6];
+        uint8_t const  len       = failure[7];
+
+        msg[0] = 0;
+        if ((type < UNIT_TEST_TYPE_COUNT)
+            && (len == 2 * type_descs[type].width))
+        {
+            value_format(msg, sizeof(msg), (unit_test_type_t) type,
+                &failure[8], &failure[8 + type_descs[type].width]);
+        }
+        else if ((type < UNIT_TEST_TYPE_COUNT)
+            && (len == type_descs[type].width))
+        {
+            value_format(msg, sizeof(msg), (unit_test_type_t) type,
+                &failure[8], 0);
+        }
+
+        if (suite_num != suite)
+        {
+            suite = suite_num;
+            (void) printf(event_formats[UNIT_TEST_EVT_SUITE_NUM], suite_num);
+        }
+
+        (void) snprintf(id_str, sizeof(id_str), "#%u", file_id);
+        (void) printf(event_formats[UNIT_TEST_EVT_ASSERT_EQ],
+            file_names[file_id] ? file_names[file_id] : id_str,
+            (int) line_num, msg);
+    }
+
+    (void) printf(event_formats[UNIT_TEST_EVT_SUMMARY_SUITES],
+        (unsigned long) counts[0]);
+    (void) printf(event_formats[UNIT_TEST_EVT_SUMMARY_CASES],
+        (unsigned long) counts[1]);
+    (void) printf(event_formats[UNIT_TEST_EVT_SUMMARY_CASE_FAILS],
+        (unsigned long) counts[2]);
+    (void) printf(event_formats[UNIT_TEST_EVT_SUMMARY_ASSERTS],
+        (unsigned long) counts[3]);
+    (void) printf(event_formats[UNIT_TEST_EVT_SUMMARY_ASSERT_FAILS],
+        (unsigned long) counts[4]);
+    (void) printf(header[7] ? "Run complete\n" : "Run not complete\n");
+
+    return 0;
+}
+
+/**
+ * Load a map file of file ids and names.
+ *
+ *  @param map_name  name of the map file
+ *
+ *  @return false if the map file cannot be read
+ */
+static bool map_load (char const *map_name)
+{
+    char     line[MAX_LINE_LEN];
+    FILE    *map = fopen(map_name, "r");
+
+    if (!map)
+    {
+        (void) fprintf(stderr, "cannot open %s\n", map_name);
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), map))
+    {
+        char         *name;
+        unsigned long file_id = strtoul(line, &name, 10);
+        size_t        len;
+
+        while ((*name == ' ') || (*name == '\t'))
+        {
+            name++;
+        }
+
+        len = strcspn(name, "\r\n");
+        if ((name != line) && (len > 0) && (file_id < MAX_FILES))
+        {
+            file_name_set((uint16_t) file_id, name, len);
+        }
+    }
+
+    (void) fclose(map);
+    return true;
+}
+
+/**
+ * Remember the name of a file id.
+ *
+ *  @param file_id  the file id
+ *  @param name     the file name, not terminated
+ *  @param len      length of the name
+ */
+static void file_name_set (uint16_t file_id, char const *name, size_t len)
+{
+    char *copy = malloc(len + 1);
+
+    if (copy)
+    {
+        (void) memcpy(copy, name, len);
+        copy[len] = 0;
+        free(file_names[file_id]);
+        file_names[file_id] = copy;
+    }
+}
+
+/**
+ * Hash a source path the way UNIT_TEST_FILE_HASH in unit_test.h does, FNV-1a
+ * of the last 32 characters taken from the end, folded to 16 bits.
+ *
+ *  @param path  the source path
+ *
+ *  @return the file id of the path
+ */
+static uint16_t file_hash (char const *path)
+{
+    size_t const len  = strlen(path);
+    uint32_t     hash = 2166136261u;
+
+    for (size_t index = 0; index < 32; index++)
+    {
+        uint8_t const c = (index < len) ? (uint8_t) path[len - 1 - index] : 0;
+
+        hash = (hash ^ c) * 16777619u;
+    }
+
+    return (uint16_t) (hash ^ (hash >> 16));
+}
+
+/**
+ * Format the message of an assert failure the same way the target does in
+ * text mode.
+ *
+ *  @param msg       buffer for the message
+ *  @param size      size of the buffer
+ *  @param type      type tag of the values
+ *  @param expected  raw bytes of the expected value
+ *  @param actual    raw bytes of the actual value, null for "not equal"
+ */
+//lint -e{592} non-literal format specifier
+static void value_format (char *msg, size_t size, unit_test_type_t type,
+    uint8_t const *expected, uint8_t const *actual)
+{
+    type_desc_t const *desc = &type_descs[type];
+    uint64_t const e_bits = value_bits(expected, desc->width);
+    uint64_t const a_bits = actual ? value_bits(actual, desc->width) : 0;
+    uint8_t  const shift  = (uint8_t) (64 - 8 * desc->width);
+
+    // the expected and actual values are passed as the widest type of their
+    // kind, format strings for the narrow types are given int/unsigned
+    if (UNIT_TEST_KIND_FLOAT == desc->kind)
+    {
+        double e_val;
+        double a_val;
+
+        (void) memcpy(&e_val, &e_bits, sizeof(e_val));
+        (void) memcpy(&a_val, &a_bits, sizeof(a_val));
+        (void) snprintf(msg, size, actual ? desc->eq_format
+            : desc->not_eq_format, e_val, a_val);
+    }
+    else if ((UNIT_TEST_KIND_SIGNED == desc->kind) && (8 == desc->width))
+    {
+        (void) snprintf(msg, size, actual ? desc->eq_format
+            : desc->not_eq_format, (long long) e_bits, (long long) a_bits);
+    }
+    else if (UNIT_TEST_KIND_SIGNED == desc->kind)
+    {
+        // sign extend from the width of the type
+        int const e_val = (int) ((int64_t) (e_bits << shift) >> shift);
+        int const a_val = (int) ((int64_t) (a_bits << shift) >> shift);
+
+        (void) snprintf(msg, size, actual ? desc->eq_format
+            : desc->not_eq_format, e_val, a_val);
+    }
+    else if (8 == desc->width)
+    {
+        (void) snprintf(msg, size, actual ? desc->eq_format
+            : desc->not_eq_format, (unsigned long long) e_bits,
+            (unsigned long long) a_bits);
+    }
+    else
+    {
+        (void) snprintf(msg, size, actual ? desc->eq_format
+            : desc->not_eq_format, (unsigned) e_bits, (unsigned) a_bits);
+    }
+}
+
+/**
+ * Assemble the raw target bytes of a value into an integer.
+ *
+ *  @param bytes  raw bytes of the value in target byte order
+ *  @param width  number of bytes
+ *
+ *  @return the bits of the value
+ */
+static uint64_t value_bits (uint8_t const *bytes, uint8_t width)
+{
+    uint64_t bits = 0;
+
+    for (uint8_t index = 0; index < width; index++)
+    {
+        uint8_t const byte = target_little_endian
+            ? bytes[width - 1 - index] : bytes[index];
+
+        bits = (bits << 8) | byte;
+    }
+
+    return bits;
+}
+
+/**
+ * Format bytes as hex the same way the target does in text mode.
+ *
+ *  @param hex    buffer for the text, at least 3 * len + 1 chars
+ *  @param bytes  the bytes
+ *  @param len    number of bytes
+ */
+static void hex_format (char *hex, uint8_t const *bytes, uint8_t len)
+{
+    static char const digits[] = "0123456789abcdef";
+    size_t            pos      = 0;
+
+    for (uint8_t index = 0; index < len; index++)
+    {
+        if (index)
+        {
+            hex[pos++] = ' ';
+        }
+        hex[pos++] = digits[bytes[index] >> 4];
+        hex[pos++] = digits[bytes[index] & 0x0F];
+    }
+    hex[pos] = 0;
+}